@@ -0,0 +1,304 @@
+#include "alarm_scheduler.h"
+#include <stdlib.h>
+
+#define SECONDS_PER_DAY 86400
+#define NOT_SCHEDULED SIZE_MAX
+
+/**
+ * @brief Internal per-alarm state.
+ */
+typedef struct {
+    alarm_def_t def;
+    int64_t next_fire;
+    size_t heap_index;              // NOT_SCHEDULED when not in the heap
+    uint8_t snooze_count;
+    bool snoozed;                   // the pending fire is a snooze, not a regular occurrence
+    bool in_use;
+    int next_free;                  // free list link while !in_use
+} alarm_entry_t;
+
+/**
+ * @brief Internal structure for a scheduler instance.
+ */
+struct alarm_scheduler_t {
+    size_t capacity;
+    size_t heap_size;
+    int free_head;
+    alarm_entry_t* entries;         // indexed by alarm id
+    int* heap;                      // alarm ids ordered as a min-heap on next_fire
+};
+
+// --- Private Functions ---
+
+static int64_t floor_div(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+// 1970-01-01 was a Thursday; 0 = Sunday
+static int weekday_of_day(int64_t day) {
+    int64_t wd = (day + 4) % 7;
+    return (int)(wd < 0 ? wd + 7 : wd);
+}
+
+/**
+ * @brief First occurrence of the alarm strictly after 'after'. Constant time: at most 8 candidate days.
+ */
+static int64_t next_occurrence(const alarm_def_t* def, int64_t after) {
+    int64_t day = floor_div(after, SECONDS_PER_DAY);
+    int64_t time_of_day = def->hour * 3600 + def->minute * 60;
+
+    for (int k = 0; k <= 7; k++) {
+        int64_t candidate = (day + k) * SECONDS_PER_DAY + time_of_day;
+        if (candidate <= after) {
+            continue;
+        }
+        if (def->weekdays == 0 || (def->weekdays & (1 << weekday_of_day(day + k)))) {
+            return candidate;
+        }
+    }
+    return INT64_MAX; // unreachable for a non-zero mask
+}
+
+static bool def_valid(const alarm_def_t* def) {
+    return def != NULL && def->hour < 24 && def->minute < 60 && def->weekdays <= ALARM_SCHEDULER_DAILY;
+}
+
+static bool id_valid(alarm_scheduler_handle_t s, int id) {
+    return s != NULL && id >= 0 && (size_t)id < s->capacity && s->entries[id].in_use;
+}
+
+static bool heap_less(alarm_scheduler_handle_t s, size_t a, size_t b) {
+    return s->entries[s->heap[a]].next_fire < s->entries[s->heap[b]].next_fire;
+}
+
+static void heap_swap(alarm_scheduler_handle_t s, size_t a, size_t b) {
+    int tmp = s->heap[a];
+    s->heap[a] = s->heap[b];
+    s->heap[b] = tmp;
+    s->entries[s->heap[a]].heap_index = a;
+    s->entries[s->heap[b]].heap_index = b;
+}
+
+static void sift_up(alarm_scheduler_handle_t s, size_t i) {
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!heap_less(s, i, parent)) {
+            break;
+        }
+        heap_swap(s, i, parent);
+        i = parent;
+    }
+}
+
+static void sift_down(alarm_scheduler_handle_t s, size_t i) {
+    while (1) {
+        size_t smallest = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        if (left < s->heap_size && heap_less(s, left, smallest)) {
+            smallest = left;
+        }
+        if (right < s->heap_size && heap_less(s, right, smallest)) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            break;
+        }
+        heap_swap(s, i, smallest);
+        i = smallest;
+    }
+}
+
+static void heap_remove(alarm_scheduler_handle_t s, int id) {
+    size_t i = s->entries[id].heap_index;
+    if (i == NOT_SCHEDULED) {
+        return;
+    }
+    s->heap_size--;
+    if (i != s->heap_size) {
+        // Move the last element into the hole and restore heap order from there
+        heap_swap(s, i, s->heap_size);
+        sift_up(s, i);
+        sift_down(s, i);
+    }
+    s->entries[id].heap_index = NOT_SCHEDULED;
+}
+
+/**
+ * @brief Moves an alarm to a new fire time, inserting or removing it from the heap as needed.
+ */
+static void schedule_at(alarm_scheduler_handle_t s, int id, int64_t when) {
+    alarm_entry_t* e = &s->entries[id];
+    if (!e->def.enabled || when == INT64_MAX) {
+        heap_remove(s, id);
+        return;
+    }
+
+    int64_t old = e->next_fire;
+    e->next_fire = when;
+    if (e->heap_index == NOT_SCHEDULED) {
+        e->heap_index = s->heap_size;
+        s->heap[s->heap_size++] = id;
+        sift_up(s, e->heap_index);
+    } else if (when < old) {
+        sift_up(s, e->heap_index);
+    } else {
+        sift_down(s, e->heap_index);
+    }
+}
+
+// --- Public API Implementation ---
+
+alarm_scheduler_handle_t alarm_scheduler_create(size_t capacity) {
+    if (capacity == 0 || capacity > INT32_MAX) {
+        return NULL;
+    }
+    alarm_scheduler_handle_t s = calloc(1, sizeof(struct alarm_scheduler_t));
+    if (s == NULL) {
+        return NULL;
+    }
+    s->entries = calloc(capacity, sizeof(alarm_entry_t));
+    s->heap = calloc(capacity, sizeof(int));
+    if (s->entries == NULL || s->heap == NULL) {
+        alarm_scheduler_destroy(s);
+        return NULL;
+    }
+    s->capacity = capacity;
+    for (size_t i = 0; i < capacity; i++) {
+        s->entries[i].heap_index = NOT_SCHEDULED;
+        s->entries[i].next_free = (i + 1 < capacity) ? (int)(i + 1) : -1;
+    }
+    s->free_head = 0;
+    return s;
+}
+
+void alarm_scheduler_destroy(alarm_scheduler_handle_t s) {
+    if (s == NULL) {
+        return;
+    }
+    free(s->entries);
+    free(s->heap);
+    free(s);
+}
+
+int alarm_scheduler_add(alarm_scheduler_handle_t s, const alarm_def_t* def, int64_t now) {
+    if (s == NULL || !def_valid(def) || s->free_head < 0) {
+        return -1;
+    }
+    int id = s->free_head;
+    alarm_entry_t* e = &s->entries[id];
+    s->free_head = e->next_free;
+
+    e->in_use = true;
+    e->def = *def;
+    e->snooze_count = 0;
+    e->snoozed = false;
+    e->heap_index = NOT_SCHEDULED;
+    schedule_at(s, id, next_occurrence(def, now));
+    return id;
+}
+
+bool alarm_scheduler_update(alarm_scheduler_handle_t s, int id, const alarm_def_t* def, int64_t now) {
+    if (!id_valid(s, id) || !def_valid(def)) {
+        return false;
+    }
+    alarm_entry_t* e = &s->entries[id];
+    e->def = *def;
+    e->snooze_count = 0;
+    e->snoozed = false;
+    schedule_at(s, id, next_occurrence(def, now));
+    return true;
+}
+
+bool alarm_scheduler_remove(alarm_scheduler_handle_t s, int id) {
+    if (!id_valid(s, id)) {
+        return false;
+    }
+    heap_remove(s, id);
+    alarm_entry_t* e = &s->entries[id];
+    e->in_use = false;
+    e->next_free = s->free_head;
+    s->free_head = id;
+    return true;
+}
+
+bool alarm_scheduler_get(alarm_scheduler_handle_t s, int id, alarm_def_t* def) {
+    if (!id_valid(s, id) || def == NULL) {
+        return false;
+    }
+    *def = s->entries[id].def;
+    return true;
+}
+
+bool alarm_scheduler_peek(alarm_scheduler_handle_t s, int64_t* when, int* id) {
+    if (s == NULL || s->heap_size == 0) {
+        return false;
+    }
+    if (when) {
+        *when = s->entries[s->heap[0]].next_fire;
+    }
+    if (id) {
+        *id = s->heap[0];
+    }
+    return true;
+}
+
+size_t alarm_scheduler_poll(alarm_scheduler_handle_t s, int64_t now, alarm_fire_cb_t cb, void* user_data) {
+    size_t fired = 0;
+    while (s != NULL && s->heap_size > 0) {
+        int id = s->heap[0];
+        alarm_entry_t* e = &s->entries[id];
+        int64_t when = e->next_fire;
+        if (when > now) {
+            break;
+        }
+
+        // A regular occurrence starts a new round of snoozes; a snooze firing does not
+        if (!e->snoozed) {
+            e->snooze_count = 0;
+        }
+        e->snoozed = false;
+        if (e->def.weekdays == 0) {
+            e->def.enabled = false; // one-shot
+        }
+        schedule_at(s, id, next_occurrence(&e->def, now));
+        fired++;
+        if (cb) {
+            cb(id, when, user_data);
+        }
+    }
+    return fired;
+}
+
+bool alarm_scheduler_snooze(alarm_scheduler_handle_t s, int id, int64_t now) {
+    if (!id_valid(s, id)) {
+        return false;
+    }
+    alarm_entry_t* e = &s->entries[id];
+    if (e->def.snooze_minutes == 0 || e->snooze_count >= e->def.snooze_limit) {
+        alarm_scheduler_dismiss(s, id, now);
+        return false;
+    }
+
+    e->snooze_count++;
+    e->snoozed = true;
+    // A one-shot alarm was disabled when it fired; keep it alive for the snooze
+    e->def.enabled = true;
+    schedule_at(s, id, now + (int64_t)e->def.snooze_minutes * 60);
+    return true;
+}
+
+bool alarm_scheduler_dismiss(alarm_scheduler_handle_t s, int id, int64_t now) {
+    if (!id_valid(s, id)) {
+        return false;
+    }
+    alarm_entry_t* e = &s->entries[id];
+    e->snooze_count = 0;
+    e->snoozed = false;
+    if (e->def.weekdays == 0) {
+        e->def.enabled = false;
+    }
+    schedule_at(s, id, next_occurrence(&e->def, now));
+    return true;
+}
@@ -0,0 +1,116 @@
+#ifndef ALARM_SCHEDULER_H
+#define ALARM_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Alarm scheduling engine. Pure C with no hardware or RTOS dependency.
+ *
+ * Times are seconds since 1970-01-01 00:00 in local time. Active alarms sit
+ * in a binary min-heap keyed by their next fire time, so checking for due
+ * alarms is a comparison against the head and every add, edit, fire or
+ * snooze costs O(log n). The scheduler is not thread-safe.
+ */
+
+/**
+ * @brief Weekday mask value for an alarm that fires every day.
+ */
+#define ALARM_SCHEDULER_DAILY 0x7F
+
+/**
+ * @brief Opaque handle for a scheduler instance.
+ */
+typedef struct alarm_scheduler_t* alarm_scheduler_handle_t;
+
+/**
+ * @brief Alarm definition.
+ */
+typedef struct {
+    uint8_t hour;                   /*!< 0-23 */
+    uint8_t minute;                 /*!< 0-59 */
+    uint8_t weekdays;               /*!< bit 0 = Sunday ... bit 6 = Saturday; 0 for a one-shot alarm. */
+    bool enabled;
+    uint8_t snooze_minutes;         /*!< 0 disables snooze. */
+    uint8_t snooze_limit;           /*!< Snoozes allowed before a snooze acts as dismiss. */
+} alarm_def_t;
+
+/**
+ * @brief Callback invoked for every alarm that fires during alarm_scheduler_poll().
+ *
+ * @param id The alarm that fired.
+ * @param when The time it was scheduled for.
+ * @param user_data User data passed to alarm_scheduler_poll().
+ */
+typedef void (*alarm_fire_cb_t)(int id, int64_t when, void* user_data);
+
+/**
+ * @brief Creates a scheduler that can hold up to capacity alarms.
+ *
+ * @return A handle, or NULL if memory could not be allocated.
+ */
+alarm_scheduler_handle_t alarm_scheduler_create(size_t capacity);
+
+/**
+ * @brief Frees a scheduler and all its alarms.
+ */
+void alarm_scheduler_destroy(alarm_scheduler_handle_t s);
+
+/**
+ * @brief Adds an alarm and schedules its first occurrence after now.
+ *
+ * @return The alarm id, or -1 if the scheduler is full or def is invalid.
+ */
+int alarm_scheduler_add(alarm_scheduler_handle_t s, const alarm_def_t* def, int64_t now);
+
+/**
+ * @brief Replaces an alarm's definition and reschedules it relative to now.
+ */
+bool alarm_scheduler_update(alarm_scheduler_handle_t s, int id, const alarm_def_t* def, int64_t now);
+
+/**
+ * @brief Removes an alarm; its id may be reused by a later add.
+ */
+bool alarm_scheduler_remove(alarm_scheduler_handle_t s, int id);
+
+/**
+ * @brief Copies an alarm's current definition. One-shot alarms read back as disabled after firing.
+ */
+bool alarm_scheduler_get(alarm_scheduler_handle_t s, int id, alarm_def_t* def);
+
+/**
+ * @brief Returns the earliest pending fire time without modifying anything.
+ *
+ * @return false if no alarm is pending.
+ */
+bool alarm_scheduler_peek(alarm_scheduler_handle_t s, int64_t* when, int* id);
+
+/**
+ * @brief Fires every alarm due at or before now and schedules its next occurrence.
+ *
+ * Repeating alarms are rescheduled after now, so an alarm missed while the
+ * device was off fires once rather than once per missed day. One-shot alarms
+ * are disabled after firing. A regular occurrence, unlike a snooze firing,
+ * resets the alarm's snooze count.
+ *
+ * @return Number of alarms fired.
+ */
+size_t alarm_scheduler_poll(alarm_scheduler_handle_t s, int64_t now, alarm_fire_cb_t cb, void* user_data);
+
+/**
+ * @brief Re-fires an alarm snooze_minutes after now.
+ *
+ * When snoozing is disabled or the snooze limit is reached this behaves like
+ * alarm_scheduler_dismiss().
+ *
+ * @return true if the alarm was snoozed, false if it was dismissed instead or id is invalid.
+ */
+bool alarm_scheduler_snooze(alarm_scheduler_handle_t s, int id, int64_t now);
+
+/**
+ * @brief Cancels a pending snooze and resets the snooze count.
+ */
+bool alarm_scheduler_dismiss(alarm_scheduler_handle_t s, int id, int64_t now);
+
+#endif // ALARM_SCHEDULER_H
@@ -0,0 +1,239 @@
+#include "alarm_store.h"
+#include "ds1307.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "ALARM_STORE";
+
+/*
+ * NVRAM layout (all 56 bytes):
+ *
+ *   0  magic
+ *   1  format version
+ *   2  alarm count
+ *   3  CRC-8 of bytes 0-2
+ *   4  alarm 0 copy A, alarm 0 copy B, alarm 1 copy A, ...
+ *  54  header check: a second magic
+ *  55  CRC-8 of the second magic, the format version and the alarm count
+ *
+ * Either the header or the header check is enough to trust the records; the
+ * damaged one is rewritten on load, and only when both are bad is the region
+ * formatted.
+ *
+ * Each copy is a 32-bit little-endian record followed by a CRC-8 over the
+ * alarm index and the record. Record bits:
+ *
+ *   0-4 hour, 5-10 minute, 11-17 weekdays, 18 enabled,
+ *   19-23 snooze minutes, 24-26 snooze limit, 27-28 sequence
+ *
+ * A save writes the copy that is not current with the next sequence number,
+ * so the current copy survives if the write is torn.
+ */
+#define STORE_MAGIC 0xA5
+#define STORE_VERSION 1
+#define HEADER_SIZE 4
+#define SLOT_SIZE 5
+#define SLOTS_PER_ALARM 2
+#define CHECK_OFFSET (HEADER_SIZE + ALARM_STORE_MAX_ALARMS * SLOTS_PER_ALARM * SLOT_SIZE)
+#define CHECK_MAGIC 0x5A
+#define CHECK_SIZE 2
+#define STORE_SIZE (CHECK_OFFSET + CHECK_SIZE)
+
+_Static_assert(STORE_SIZE <= DS1307_NVRAM_SIZE, "alarm store does not fit in DS1307 NVRAM");
+
+#define SEQ_MASK 0x03
+
+// --- Private Module State ---
+static bool loaded = false;
+static uint8_t current_slot[ALARM_STORE_MAX_ALARMS];
+static uint8_t current_seq[ALARM_STORE_MAX_ALARMS];
+
+// --- Private Functions ---
+
+// CRC-8/MAXIM-style polynomial 0x31, initial value 0xFF
+static uint8_t crc8(uint8_t crc, const uint8_t* data, size_t len) {
+    while (len--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint8_t slot_crc(uint8_t index, const uint8_t* payload) {
+    return crc8(crc8(0xFF, &index, 1), payload, 4);
+}
+
+static uint8_t slot_offset(uint8_t index, uint8_t slot) {
+    return HEADER_SIZE + (index * SLOTS_PER_ALARM + slot) * SLOT_SIZE;
+}
+
+static void encode_slot(uint8_t index, const alarm_record_t* record, uint8_t seq, uint8_t* out) {
+    uint32_t bits = (uint32_t)(record->hour & 0x1F)
+                  | (uint32_t)(record->minute & 0x3F) << 5
+                  | (uint32_t)(record->weekdays & 0x7F) << 11
+                  | (uint32_t)(record->enabled ? 1 : 0) << 18
+                  | (uint32_t)(record->snooze_minutes & 0x1F) << 19
+                  | (uint32_t)(record->snooze_limit & 0x07) << 24
+                  | (uint32_t)(seq & SEQ_MASK) << 27;
+    out[0] = bits & 0xFF;
+    out[1] = (bits >> 8) & 0xFF;
+    out[2] = (bits >> 16) & 0xFF;
+    out[3] = (bits >> 24) & 0xFF;
+    out[4] = slot_crc(index, out);
+}
+
+static bool decode_slot(uint8_t index, const uint8_t* in, alarm_record_t* record, uint8_t* seq) {
+    if (slot_crc(index, in) != in[4]) {
+        return false;
+    }
+    uint32_t bits = in[0] | (uint32_t)in[1] << 8 | (uint32_t)in[2] << 16 | (uint32_t)in[3] << 24;
+    record->hour = bits & 0x1F;
+    record->minute = (bits >> 5) & 0x3F;
+    record->weekdays = (bits >> 11) & 0x7F;
+    record->enabled = (bits >> 18) & 0x01;
+    record->snooze_minutes = (bits >> 19) & 0x1F;
+    record->snooze_limit = (bits >> 24) & 0x07;
+    *seq = (bits >> 27) & SEQ_MASK;
+    return record->hour < 24 && record->minute < 60;
+}
+
+static void encode_header(uint8_t* header) {
+    header[0] = STORE_MAGIC;
+    header[1] = STORE_VERSION;
+    header[2] = ALARM_STORE_MAX_ALARMS;
+    header[3] = crc8(0xFF, header, 3);
+}
+
+static void encode_check(uint8_t* check) {
+    const uint8_t fields[3] = { CHECK_MAGIC, STORE_VERSION, ALARM_STORE_MAX_ALARMS };
+    check[0] = CHECK_MAGIC;
+    check[1] = crc8(0xFF, fields, sizeof(fields));
+}
+
+static bool header_valid(const uint8_t* header) {
+    uint8_t expected[HEADER_SIZE];
+    encode_header(expected);
+    return memcmp(header, expected, HEADER_SIZE) == 0;
+}
+
+static bool check_valid(const uint8_t* check) {
+    uint8_t expected[CHECK_SIZE];
+    encode_check(expected);
+    return memcmp(check, expected, CHECK_SIZE) == 0;
+}
+
+static bool record_valid(const alarm_record_t* record) {
+    return record->hour < 24 && record->minute < 60 && record->weekdays <= ALARM_DAY_ALL &&
+           record->snooze_minutes <= 31 && record->snooze_limit <= 7;
+}
+
+// --- Public API Implementation ---
+
+esp_err_t alarm_store_format(void) {
+    uint8_t image[STORE_SIZE];
+    const alarm_record_t disabled = {0};
+
+    encode_header(image);
+    encode_check(&image[CHECK_OFFSET]);
+
+    for (uint8_t i = 0; i < ALARM_STORE_MAX_ALARMS; i++) {
+        // Copy A is current; copy B is one sequence number older
+        encode_slot(i, &disabled, 0, &image[slot_offset(i, 0)]);
+        encode_slot(i, &disabled, SEQ_MASK, &image[slot_offset(i, 1)]);
+        current_slot[i] = 0;
+        current_seq[i] = 0;
+    }
+
+    esp_err_t err = ds1307_nvram_write(0, image, sizeof(image));
+    loaded = (err == ESP_OK);
+    return err;
+}
+
+esp_err_t alarm_store_load(alarm_record_t records[ALARM_STORE_MAX_ALARMS]) {
+    if (records == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t image[STORE_SIZE];
+    esp_err_t err = ds1307_nvram_read(0, image, sizeof(image));
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    memset(records, 0, sizeof(alarm_record_t) * ALARM_STORE_MAX_ALARMS);
+
+    bool header_ok = header_valid(image);
+    bool check_ok = check_valid(&image[CHECK_OFFSET]);
+    if (!header_ok && !check_ok) {
+        ESP_LOGW(TAG, "No valid alarm store found, formatting");
+        return alarm_store_format();
+    }
+    if (!header_ok || !check_ok) {
+        // One flipped bit must not cost every alarm: the intact half vouches
+        // for the records. A failed repair is retried on the next load.
+        ESP_LOGW(TAG, "Alarm store %s damaged, rewriting it", header_ok ? "header check" : "header");
+        if (header_ok) {
+            encode_check(&image[CHECK_OFFSET]);
+            err = ds1307_nvram_write(CHECK_OFFSET, &image[CHECK_OFFSET], CHECK_SIZE);
+        } else {
+            encode_header(image);
+            err = ds1307_nvram_write(0, image, HEADER_SIZE);
+        }
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to repair alarm store: %s", esp_err_to_name(err));
+        }
+    }
+
+    for (uint8_t i = 0; i < ALARM_STORE_MAX_ALARMS; i++) {
+        alarm_record_t copy[SLOTS_PER_ALARM];
+        uint8_t seq[SLOTS_PER_ALARM];
+        bool valid[SLOTS_PER_ALARM];
+        for (uint8_t s = 0; s < SLOTS_PER_ALARM; s++) {
+            valid[s] = decode_slot(i, &image[slot_offset(i, s)], &copy[s], &seq[s]);
+        }
+
+        uint8_t pick;
+        if (valid[0] && valid[1]) {
+            // The copy written last carries the other's sequence number + 1
+            pick = (((seq[1] - seq[0]) & SEQ_MASK) == 1) ? 1 : 0;
+        } else if (valid[0] || valid[1]) {
+            pick = valid[0] ? 0 : 1;
+            ESP_LOGW(TAG, "Alarm %d: one copy corrupted, using the other", i);
+        } else {
+            ESP_LOGW(TAG, "Alarm %d: both copies corrupted, disabling", i);
+            current_slot[i] = 1; // next save goes to slot 0 with seq 0
+            current_seq[i] = SEQ_MASK;
+            continue;
+        }
+
+        records[i] = copy[pick];
+        current_slot[i] = pick;
+        current_seq[i] = seq[pick];
+    }
+
+    loaded = true;
+    return ESP_OK;
+}
+
+esp_err_t alarm_store_save(uint8_t index, const alarm_record_t* record) {
+    if (index >= ALARM_STORE_MAX_ALARMS || record == NULL || !record_valid(record)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!loaded) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint8_t slot = current_slot[index] ^ 1;
+    uint8_t seq = (current_seq[index] + 1) & SEQ_MASK;
+    uint8_t buf[SLOT_SIZE];
+    encode_slot(index, record, seq, buf);
+
+    esp_err_t err = ds1307_nvram_write(slot_offset(index, slot), buf, sizeof(buf));
+    if (err == ESP_OK) {
+        current_slot[index] = slot;
+        current_seq[index] = seq;
+    }
+    return err;
+}
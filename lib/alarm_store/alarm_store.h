@@ -0,0 +1,67 @@
+#ifndef ALARM_STORE_H
+#define ALARM_STORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/**
+ * @brief Number of alarms kept in the DS1307 NVRAM.
+ */
+#define ALARM_STORE_MAX_ALARMS 5
+
+/**
+ * @brief Weekday mask bits; a mask of 0 means a one-shot alarm.
+ */
+#define ALARM_DAY_SUNDAY    (1 << 0)
+#define ALARM_DAY_MONDAY    (1 << 1)
+#define ALARM_DAY_TUESDAY   (1 << 2)
+#define ALARM_DAY_WEDNESDAY (1 << 3)
+#define ALARM_DAY_THURSDAY  (1 << 4)
+#define ALARM_DAY_FRIDAY    (1 << 5)
+#define ALARM_DAY_SATURDAY  (1 << 6)
+#define ALARM_DAY_ALL       0x7F
+
+/**
+ * @brief One persisted alarm definition.
+ */
+typedef struct {
+    uint8_t hour;                   /*!< 0-23 */
+    uint8_t minute;                 /*!< 0-59 */
+    uint8_t weekdays;               /*!< ALARM_DAY_* mask, 0 for one-shot. */
+    bool enabled;
+    uint8_t snooze_minutes;         /*!< 0-31, 0 disables snooze. */
+    uint8_t snooze_limit;           /*!< 0-7 snoozes before the alarm is dismissed. */
+} alarm_record_t;
+
+/**
+ * @brief Loads all alarms with a single NVRAM burst read.
+ *
+ * Each alarm is stored twice with a sequence number and a CRC; the newest
+ * copy with a valid CRC wins, so a torn write falls back to the previous
+ * value. The region header has a short second copy at the end of the region;
+ * if one of the two is damaged it is rewritten and the alarms load as usual. If both are missing or from another format
+ * version the region is formatted and all alarms are returned disabled.
+ *
+ * @param records Array that receives ALARM_STORE_MAX_ALARMS records.
+ * @return ESP_OK on success, or an error code if the NVRAM could not be accessed.
+ */
+esp_err_t alarm_store_load(alarm_record_t records[ALARM_STORE_MAX_ALARMS]);
+
+/**
+ * @brief Persists one alarm, writing only that alarm's older copy (5 bytes).
+ *
+ * alarm_store_load() must have been called first.
+ *
+ * @param index Alarm index, 0 to ALARM_STORE_MAX_ALARMS - 1.
+ * @param record The alarm to store.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for out-of-range fields, or an error code.
+ */
+esp_err_t alarm_store_save(uint8_t index, const alarm_record_t* record);
+
+/**
+ * @brief Rewrites the whole region with a fresh header and all alarms disabled.
+ */
+esp_err_t alarm_store_format(void);
+
+#endif // ALARM_STORE_H
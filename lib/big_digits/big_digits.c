@@ -0,0 +1,148 @@
+#include "big_digits.h"
+#include "glyph_cache.h"
+#include "display_server.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+static const char *TAG = "BIG_DIGITS";
+
+#define DIGIT_COLS 3
+#define CELLS_PER_DIGIT (DIGIT_COLS * BIG_DIGITS_ROWS)
+#define TIME_DIGITS 4
+#define TIME_CELLS (TIME_DIGITS * CELLS_PER_DIGIT)
+#define ROW_CELLS (TIME_CELLS / BIG_DIGITS_ROWS)
+
+// Middle dot in the A00 character ROM, used for both halves of the colon
+#define COLON_CODE ((char)0xA5)
+#define FALLBACK_CODE '#'
+
+/**
+ * @brief The pieces digits are made of.
+ */
+typedef enum {
+    SEG_BLANK,
+    SEG_FULL,
+    SEG_TOP_LEFT,       // rounded corners
+    SEG_TOP_RIGHT,
+    SEG_BOTTOM_LEFT,
+    SEG_BOTTOM_RIGHT,
+    SEG_UPPER_BAR,
+    SEG_LOWER_BAR,
+    SEG_UPPER_MIDDLE,   // top bar plus the upper half of the middle bar
+    SEG_LOWER_MIDDLE,   // lower half of the middle bar plus the bottom bar
+    SEG_COUNT,
+} segment_t;
+
+static const uint8_t segment_bitmaps[SEG_COUNT][8] = {
+    [SEG_BLANK]        = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    [SEG_FULL]         = {0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F},
+    [SEG_TOP_LEFT]     = {0x07, 0x0F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F},
+    [SEG_TOP_RIGHT]    = {0x1C, 0x1E, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F},
+    [SEG_BOTTOM_LEFT]  = {0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x0F, 0x07},
+    [SEG_BOTTOM_RIGHT] = {0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1E, 0x1C},
+    [SEG_UPPER_BAR]    = {0x1F, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00},
+    [SEG_LOWER_BAR]    = {0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F},
+    [SEG_UPPER_MIDDLE] = {0x1F, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x1F, 0x1F},
+    [SEG_LOWER_MIDDLE] = {0x1F, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F},
+};
+
+// Top row left to right, then the bottom row
+static const uint8_t digit_segments[10][CELLS_PER_DIGIT] = {
+    {SEG_TOP_LEFT, SEG_UPPER_BAR, SEG_TOP_RIGHT, SEG_BOTTOM_LEFT, SEG_LOWER_BAR, SEG_BOTTOM_RIGHT},
+    {SEG_UPPER_BAR, SEG_TOP_RIGHT, SEG_BLANK, SEG_LOWER_BAR, SEG_FULL, SEG_LOWER_BAR},
+    {SEG_UPPER_MIDDLE, SEG_UPPER_MIDDLE, SEG_TOP_RIGHT, SEG_BOTTOM_LEFT, SEG_LOWER_MIDDLE, SEG_LOWER_MIDDLE},
+    {SEG_UPPER_MIDDLE, SEG_UPPER_MIDDLE, SEG_TOP_RIGHT, SEG_LOWER_MIDDLE, SEG_LOWER_MIDDLE, SEG_BOTTOM_RIGHT},
+    {SEG_BOTTOM_LEFT, SEG_LOWER_BAR, SEG_FULL, SEG_BLANK, SEG_BLANK, SEG_FULL},
+    {SEG_FULL, SEG_UPPER_MIDDLE, SEG_UPPER_MIDDLE, SEG_LOWER_MIDDLE, SEG_LOWER_MIDDLE, SEG_BOTTOM_RIGHT},
+    {SEG_TOP_LEFT, SEG_UPPER_MIDDLE, SEG_UPPER_MIDDLE, SEG_BOTTOM_LEFT, SEG_LOWER_MIDDLE, SEG_BOTTOM_RIGHT},
+    {SEG_UPPER_BAR, SEG_UPPER_BAR, SEG_TOP_RIGHT, SEG_BLANK, SEG_BLANK, SEG_FULL},
+    {SEG_TOP_LEFT, SEG_UPPER_MIDDLE, SEG_TOP_RIGHT, SEG_BOTTOM_LEFT, SEG_LOWER_MIDDLE, SEG_BOTTOM_RIGHT},
+    {SEG_TOP_LEFT, SEG_UPPER_MIDDLE, SEG_TOP_RIGHT, SEG_BLANK, SEG_BLANK, SEG_FULL},
+};
+
+// --- Private Module State ---
+static glyph_id_t segment_glyphs[SEG_COUNT];
+static SemaphoreHandle_t draw_mutex = NULL;
+
+// Glyph references held for the time currently queued, per row, since a
+// full queue can stop a draw between rows
+static glyph_id_t held[BIG_DIGITS_ROWS][ROW_CELLS];
+static uint8_t num_held[BIG_DIGITS_ROWS];
+
+// --- Public API Implementation ---
+
+esp_err_t big_digits_init(void) {
+    if (draw_mutex != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (int i = 0; i < SEG_COUNT; i++) {
+        esp_err_t err = glyph_cache_register(segment_bitmaps[i], &segment_glyphs[i]);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to register glyph %d: %s", i, esp_err_to_name(err));
+            return err;
+        }
+    }
+    draw_mutex = xSemaphoreCreateMutex();
+    if (draw_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t big_digits_draw_time(uint8_t row, uint8_t col, uint8_t hours, uint8_t minutes) {
+    if (draw_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    const uint8_t digits[TIME_DIGITS] = { hours / 10 % 10, hours % 10, minutes / 10 % 10, minutes % 10 };
+    char lines[BIG_DIGITS_ROWS][BIG_DIGITS_TIME_COLS + 1];
+    glyph_id_t acquired[BIG_DIGITS_ROWS][ROW_CELLS];
+    uint8_t num_acquired[BIG_DIGITS_ROWS] = {0};
+
+    xSemaphoreTake(draw_mutex, portMAX_DELAY);
+    for (int d = 0; d < TIME_DIGITS; d++) {
+        // The colon sits between the hours and the minutes
+        int x = d * DIGIT_COLS + (d >= 2 ? 1 : 0);
+        for (int cell = 0; cell < CELLS_PER_DIGIT; cell++) {
+            glyph_id_t glyph = segment_glyphs[digit_segments[digits[d]][cell]];
+            int r = cell / DIGIT_COLS;
+            char code;
+            if (glyph_cache_acquire(glyph, &code) == ESP_OK) {
+                acquired[r][num_acquired[r]++] = glyph;
+            } else {
+                code = FALLBACK_CODE;
+            }
+            lines[r][x + cell % DIGIT_COLS] = code;
+        }
+    }
+    for (int r = 0; r < BIG_DIGITS_ROWS; r++) {
+        lines[r][2 * DIGIT_COLS] = COLON_CODE;
+        lines[r][BIG_DIGITS_TIME_COLS] = '\0';
+    }
+
+    esp_err_t err = ESP_OK;
+    int queued = 0;
+    for (; queued < BIG_DIGITS_ROWS; queued++) {
+        err = display_server_put_text(row + queued, col, lines[queued]);
+        if (err != ESP_OK) {
+            break;
+        }
+    }
+
+    // Only now can glyphs that left the screen become eviction candidates.
+    // Rows that were not queued keep showing, and holding, the old glyphs.
+    for (int r = 0; r < BIG_DIGITS_ROWS; r++) {
+        glyph_id_t* released = r < queued ? held[r] : acquired[r];
+        uint8_t num_released = r < queued ? num_held[r] : num_acquired[r];
+        for (uint8_t i = 0; i < num_released; i++) {
+            glyph_cache_release(released[i]);
+        }
+        if (r < queued) {
+            memcpy(held[r], acquired[r], num_acquired[r] * sizeof(glyph_id_t));
+            num_held[r] = num_acquired[r];
+        }
+    }
+    xSemaphoreGive(draw_mutex);
+    return err;
+}
@@ -0,0 +1,33 @@
+#ifndef BIG_DIGITS_H
+#define BIG_DIGITS_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#define BIG_DIGITS_ROWS 2
+#define BIG_DIGITS_TIME_COLS 13     /*!< Width of "HH:MM": four 3-cell digits and the colon. */
+
+/**
+ * @brief Registers the big-digit font with the glyph cache.
+ *
+ * The font is built from 8 custom glyphs plus the ROM blank and full block,
+ * so any time fits in CGRAM. Call once, after display_server_start().
+ *
+ * @return ESP_OK on success, or an error code on failure.
+ */
+esp_err_t big_digits_init(void);
+
+/**
+ * @brief Queues "HH:MM" in 3x2 digits with its top-left cell at row/col. Never blocks on the LCD.
+ *
+ * Glyphs for the new time are acquired before those of the previous one are
+ * released, so digits that stay on screen keep their CGRAM slot and a redraw
+ * of the same time reprograms nothing. A digit cell whose glyph finds no slot
+ * is drawn as '#'. If the display server queue fills up part way, the rows
+ * that were not queued keep the previous time's glyphs.
+ *
+ * @return ESP_OK on success, or the display server's error if a draw could not be queued.
+ */
+esp_err_t big_digits_draw_time(uint8_t row, uint8_t col, uint8_t hours, uint8_t minutes);
+
+#endif // BIG_DIGITS_H
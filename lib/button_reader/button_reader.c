@@ -1,19 +1,39 @@
 #include "button_reader.h"
+#include "input_dispatcher.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "freertos/timers.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "soc/soc.h"
+#include "soc/soc_caps.h"
+#include "soc/gpio_reg.h"
 #include <string.h>
 
 static const char *TAG = "BUTTON_READER";
 
 // Debounce configuration
-#define DEBOUNCE_TICKS pdMS_TO_TICKS(50)
+#define DEBOUNCE_MS 50
 
-// Main polling task configuration
-#define POLLING_TASK_STACK_SIZE 2048
-#define POLLING_TASK_PRIORITY 5
-#define POLLING_INTERVAL_MS 20
+// Interrupt mode: the pin is read this long after the first edge, and the
+// change is only reported if it still reads changed. Rejects single spikes.
+#define CONFIRM_MS 3
+
+// Polling configuration (POLL and SCAN modes)
+#define POLLING_INTERVAL_MS 10
+#define POLL_DEBOUNCE_SAMPLES (DEBOUNCE_MS / POLLING_INTERVAL_MS)
+
+// Scan mode: a change is accepted after this many consecutive agreeing samples.
+// Fixed by the 2-bit vertical counter; 4 x 10 ms matches DEBOUNCE_MS closely.
+#define SCAN_STABLE_SAMPLES 4
+
+// Gesture configuration
+#define DEFAULT_CLICK_GAP_MS 250
+#define NO_DEADLINE INT64_MAX
+
+// Internal event types posted to the input dispatcher, after the public button_event_t values
+#define BUTTON_INTERNAL_CHORD 0x100
+#define BUTTON_INTERNAL_FREE_BUTTON 0x101
+#define BUTTON_INTERNAL_FREE_CHORD 0x102
 
 /**
  * @brief Internal structure for a button instance.
@@ -23,17 +43,74 @@ struct button_t {
     button_event_cb_t callback;
     bool current_state;
     bool last_state;
-    TimerHandle_t long_press_timer;
+    uint8_t debounce_count;             // poll mode: consecutive samples that disagree with current_state
+    esp_timer_handle_t debounce_timer;  // interrupt mode only
+    volatile bool debouncing;           // set by the ISR, cleared when the debounce window ends
+    bool deleted;                       // interrupt mode: unlinked; the debounce timer hands it to the dispatcher
+
+    // Gesture state, guarded by button_mutex. Deadlines are esp_timer times in us.
+    bool held;
+    bool gesture_fired;                 // this hold raised LONG_PRESS or REPEAT, so its release is not a click
+    bool suppressed;                    // claimed by a chord until released
+    uint8_t click_count;
+    uint32_t repeat_count;
+    uint32_t repeat_interval_ms;
+    int64_t long_press_at;
+    int64_t repeat_at;
+    int64_t click_end_at;
+
+    // Owned by the dispatcher task: counts for the event being delivered, read back by the getters
+    uint8_t event_clicks;
+    uint32_t event_repeats;
     struct button_t* next;
 };
 
+/**
+ * @brief Internal structure for a chord instance.
+ */
+struct button_chord_t {
+    button_chord_config_t config;
+    bool fired;                         // fired during the current hold
+    int64_t fire_at;
+    struct button_chord_t* next;
+};
+
 // --- Private Module State ---
 static button_handle_t button_list_head = NULL;
-static TaskHandle_t polling_task_handle = NULL;
+static button_chord_handle_t chord_list_head = NULL;
+static size_t polled_button_count = 0;  // POLL and SCAN buttons, which both need the poll timer
+
+// All sampling and gesture work runs on the esp_timer task under this mutex.
+// One periodic timer samples polled buttons; one one-shot timer serves every
+// gesture deadline.
+static SemaphoreHandle_t button_mutex = NULL;
+static esp_timer_handle_t poll_timer = NULL;
+static esp_timer_handle_t gesture_timer = NULL;
+
+// Orders the ISR's edge against the end of a debounce window, so that no
+// edge falls between the final sample and the window closing
+static portMUX_TYPE debounce_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Scan mode state, one bit per GPIO number. Bits read 1 for "pressed".
+static uint64_t scan_mask = 0;          // pins in scan mode
+static uint64_t scan_invert = 0;        // active-low pins
+static uint64_t scan_stable = 0;        // debounced state
+static uint64_t scan_ct0 = ~0ULL;       // vertical counter, low bit
+static uint64_t scan_ct1 = ~0ULL;       // vertical counter, high bit
+static button_handle_t scan_buttons[GPIO_NUM_MAX];
 
 // --- Forward Declarations ---
-static void polling_task(void* arg);
-static void long_press_timer_callback(TimerHandle_t xTimer);
+static esp_err_t module_init(void);
+static void poll_timer_callback(void* arg);
+static void debounce_timer_callback(void* arg);
+static void gesture_timer_callback(void* arg);
+static void handle_debounced_change(button_handle_t b, bool pressed, int64_t now);
+static void rearm_gesture_timer(int64_t now);
+static void deliver_event(const input_event_t* event);
+static esp_err_t setup_interrupt_mode(button_handle_t b);
+static void scan_add(button_handle_t b);
+static void scan_remove(button_handle_t b);
+static void scan_tick(int64_t now);
 
 // --- Public API Implementation ---
 
@@ -41,6 +118,14 @@ button_handle_t button_create(const button_config_t* config) {
     if (config == NULL) {
         return NULL;
     }
+    if (!input_dispatcher_running()) {
+        ESP_LOGE(TAG, "Input dispatcher is not running");
+        return NULL;
+    }
+    if (module_init() != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set up button timers");
+        return NULL;
+    }
 
     // 1. Allocate memory for the new button
     button_handle_t new_button = (button_handle_t)malloc(sizeof(struct button_t));
@@ -57,7 +142,7 @@ button_handle_t button_create(const button_config_t* config) {
         .mode = GPIO_MODE_INPUT,
         .pull_up_en = config->active_level == 0 ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE,
         .pull_down_en = config->active_level == 0 ? GPIO_PULLDOWN_DISABLE : GPIO_PULLDOWN_ENABLE,
-        .intr_type = GPIO_INTR_DISABLE,
+        .intr_type = config->mode == BUTTON_MODE_INTERRUPT ? GPIO_INTR_ANYEDGE : GPIO_INTR_DISABLE,
     };
     ESP_ERROR_CHECK(gpio_config(&io_conf));
 
@@ -65,63 +150,101 @@ button_handle_t button_create(const button_config_t* config) {
     new_button->last_state = gpio_get_level(config->gpio_num) == config->active_level;
     new_button->current_state = new_button->last_state;
 
-    // 4. Create long-press timer if needed
-    if (config->long_press_ms > 0) {
-        new_button->long_press_timer = xTimerCreate(
-            "long_press_tmr",
-            pdMS_TO_TICKS(config->long_press_ms),
-            pdFALSE, // One-shot timer
-            (void*)new_button,
-            long_press_timer_callback
-        );
-        if (new_button->long_press_timer == NULL) {
-            ESP_LOGE(TAG, "Failed to create long press timer for GPIO %d", config->gpio_num);
-            free(new_button);
-            return NULL;
-        }
+    // 4. Initialize gesture state. A button held at boot is not treated as a press.
+    new_button->held = new_button->current_state;
+    new_button->suppressed = new_button->current_state;
+    new_button->long_press_at = NO_DEADLINE;
+    new_button->repeat_at = NO_DEADLINE;
+    new_button->click_end_at = NO_DEADLINE;
+    if (new_button->config.click_gap_ms == 0) {
+        new_button->config.click_gap_ms = DEFAULT_CLICK_GAP_MS;
     }
 
-    // 5. Add to the linked list
+    // 5. Set up edge interrupt and debounce timer for interrupt mode
+    if (config->mode == BUTTON_MODE_INTERRUPT && setup_interrupt_mode(new_button) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set up interrupt mode for GPIO %d", config->gpio_num);
+        free(new_button);
+        return NULL;
+    }
+
+    // 6. Add to the linked list
+    xSemaphoreTake(button_mutex, portMAX_DELAY);
     new_button->next = button_list_head;
     button_list_head = new_button;
+    if (config->mode == BUTTON_MODE_SCAN) {
+        scan_add(new_button);
+    }
 
-    // 6. Start the polling task if it's not already running
-    if (polling_task_handle == NULL) {
-        xTaskCreate(polling_task, "button_poll_task", POLLING_TASK_STACK_SIZE, NULL, POLLING_TASK_PRIORITY, &polling_task_handle);
+    // 7. Start the poll timer if it's not already running
+    if (config->mode == BUTTON_MODE_POLL || config->mode == BUTTON_MODE_SCAN) {
+        if (polled_button_count++ == 0) {
+            esp_timer_start_periodic(poll_timer, POLLING_INTERVAL_MS * 1000);
+        }
     }
+    xSemaphoreGive(button_mutex);
 
     ESP_LOGI(TAG, "Button created for GPIO %d", config->gpio_num);
     return new_button;
 }
 
 esp_err_t button_delete(button_handle_t handle) {
-    if (handle == NULL) {
+    if (handle == NULL || button_mutex == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
 
     // Find and remove the button from the list
+    xSemaphoreTake(button_mutex, portMAX_DELAY);
     button_handle_t* current = &button_list_head;
     while (*current != NULL && *current != handle) {
         current = &(*current)->next;
     }
-
-    if (*current == handle) {
+    bool found = (*current == handle);
+    if (found) {
         *current = handle->next; // Unlink
-        if (handle->long_press_timer) {
-            xTimerDelete(handle->long_press_timer, portMAX_DELAY);
+        if (handle->config.mode == BUTTON_MODE_INTERRUPT) {
+            gpio_isr_handler_remove(handle->config.gpio_num);
+            gpio_intr_disable(handle->config.gpio_num);
+            // A debounce callback may already be waiting for the mutex. Queue
+            // one more run behind it; that run posts the free.
+            handle->deleted = true;
+            esp_timer_stop(handle->debounce_timer);
+            esp_timer_start_once(handle->debounce_timer, 0);
+        } else {
+            if (handle->config.mode == BUTTON_MODE_SCAN) {
+                scan_remove(handle);
+            }
+            // If no polled buttons remain, stop the poll timer
+            if (--polled_button_count == 0) {
+                esp_timer_stop(poll_timer);
+            }
         }
-        free(handle);
-        ESP_LOGI(TAG, "Button deleted.");
+        handle->callback = NULL;
+        rearm_gesture_timer(esp_timer_get_time());
+    }
+    xSemaphoreGive(button_mutex);
 
-        // If the list is now empty, stop the polling task
-        if (button_list_head == NULL && polling_task_handle != NULL) {
-            vTaskDelete(polling_task_handle);
-            polling_task_handle = NULL;
-        }
+    if (!found) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (handle->config.mode == BUTTON_MODE_INTERRUPT) {
+        ESP_LOGI(TAG, "Button deleted.");
         return ESP_OK;
     }
 
-    return ESP_ERR_NOT_FOUND;
+    // Events already queued still point at the button, so free it behind them
+    input_event_t event = {
+        .timestamp_us = esp_timer_get_time(),
+        .deliver = deliver_event,
+        .source = handle,
+        .type = BUTTON_INTERNAL_FREE_BUTTON,
+    };
+    esp_err_t err = input_dispatcher_post(&event, portMAX_DELAY);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Could not queue button release, leaking handle");
+        return err;
+    }
+    ESP_LOGI(TAG, "Button deleted.");
+    return ESP_OK;
 }
 
 esp_err_t button_register_callback(button_handle_t handle, button_event_cb_t cb) {
@@ -132,54 +255,491 @@ esp_err_t button_register_callback(button_handle_t handle, button_event_cb_t cb)
     return ESP_OK;
 }
 
+uint8_t button_get_click_count(button_handle_t handle) {
+    return handle ? handle->event_clicks : 0;
+}
+
+uint32_t button_get_repeat_count(button_handle_t handle) {
+    return handle ? handle->event_repeats : 0;
+}
+
+button_chord_handle_t button_chord_create(const button_chord_config_t* config) {
+    if (config == NULL || config->num_buttons < 2 || config->num_buttons > BUTTON_CHORD_MAX_BUTTONS ||
+        config->callback == NULL || button_mutex == NULL) {
+        return NULL;
+    }
+    for (uint8_t i = 0; i < config->num_buttons; i++) {
+        if (config->buttons[i] == NULL) {
+            return NULL;
+        }
+    }
+
+    button_chord_handle_t chord = calloc(1, sizeof(struct button_chord_t));
+    if (chord == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate memory for chord");
+        return NULL;
+    }
+    chord->config = *config;
+    chord->fire_at = NO_DEADLINE;
+
+    xSemaphoreTake(button_mutex, portMAX_DELAY);
+    chord->next = chord_list_head;
+    chord_list_head = chord;
+    xSemaphoreGive(button_mutex);
+    return chord;
+}
+
+esp_err_t button_chord_delete(button_chord_handle_t chord) {
+    if (chord == NULL || button_mutex == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(button_mutex, portMAX_DELAY);
+    button_chord_handle_t* current = &chord_list_head;
+    while (*current != NULL && *current != chord) {
+        current = &(*current)->next;
+    }
+    bool found = (*current == chord);
+    if (found) {
+        *current = chord->next;
+        chord->config.callback = NULL;
+        rearm_gesture_timer(esp_timer_get_time());
+    }
+    xSemaphoreGive(button_mutex);
+
+    if (!found) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    input_event_t event = {
+        .timestamp_us = esp_timer_get_time(),
+        .deliver = deliver_event,
+        .source = chord,
+        .type = BUTTON_INTERNAL_FREE_CHORD,
+    };
+    return input_dispatcher_post(&event, portMAX_DELAY);
+}
+
 // --- Private Functions ---
 
-static void long_press_timer_callback(TimerHandle_t xTimer) {
-    button_handle_t button = (button_handle_t)pvTimerGetTimerID(xTimer);
-    if (button && button->callback && button->current_state) {
-        button->callback(button, BUTTON_EVENT_LONG_PRESS, button->config.user_data);
+static esp_err_t module_init(void) {
+    if (button_mutex != NULL) {
+        return ESP_OK;
     }
+    button_mutex = xSemaphoreCreateMutex();
+    if (button_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    const esp_timer_create_args_t poll_args = {
+        .callback = poll_timer_callback,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "btn_poll",
+    };
+    const esp_timer_create_args_t gesture_args = {
+        .callback = gesture_timer_callback,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "btn_gesture",
+    };
+    esp_err_t err = esp_timer_create(&poll_args, &poll_timer);
+    if (err == ESP_OK) {
+        err = esp_timer_create(&gesture_args, &gesture_timer);
+        if (err != ESP_OK) {
+            esp_timer_delete(poll_timer);
+        }
+    }
+    if (err != ESP_OK) {
+        vSemaphoreDelete(button_mutex);
+        button_mutex = NULL;
+    }
+    return err;
+}
+
+static void IRAM_ATTR button_isr_handler(void* arg) {
+    button_handle_t b = (button_handle_t)arg;
+
+    // The first edge schedules the confirming read; bounces after it are
+    // ignored until the debounce window closes
+    taskENTER_CRITICAL_ISR(&debounce_lock);
+    bool first = !b->debouncing;
+    b->debouncing = true;
+    taskEXIT_CRITICAL_ISR(&debounce_lock);
+    if (first) {
+        esp_timer_start_once(b->debounce_timer, CONFIRM_MS * 1000);
+    }
+}
+
+static esp_err_t setup_interrupt_mode(button_handle_t b) {
+    const esp_timer_create_args_t timer_args = {
+        .callback = debounce_timer_callback,
+        .arg = b,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "btn_debounce",
+    };
+    esp_err_t err = esp_timer_create(&timer_args, &b->debounce_timer);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // Install ISR service if not already installed
+    gpio_install_isr_service(0);
+    err = gpio_isr_handler_add(b->config.gpio_num, button_isr_handler, b);
+    if (err != ESP_OK) {
+        esp_timer_delete(b->debounce_timer);
+    }
+    return err;
 }
 
-static void polling_task(void* arg) {
-    TickType_t last_poll_time = xTaskGetTickCount();
+/**
+ * @brief Hands a deleted interrupt-mode button to the dispatcher, which deletes
+ * its timer and frees it. Runs on the debounce timer, after every callback
+ * that was already waiting; retries while the dispatcher queue is full.
+ */
+static void release_deleted_button(button_handle_t b) {
+    input_event_t event = {
+        .timestamp_us = esp_timer_get_time(),
+        .deliver = deliver_event,
+        .source = b,
+        .type = BUTTON_INTERNAL_FREE_BUTTON,
+    };
+    if (input_dispatcher_post(&event, 0) != ESP_OK) {
+        esp_timer_start_once(b->debounce_timer, POLLING_INTERVAL_MS * 1000);
+    }
+}
 
-    while (1) {
-        for (button_handle_t b = button_list_head; b != NULL; b = b->next) {
+// Runs in the esp_timer task CONFIRM_MS after the edge that opened a debounce
+// window, and again when the window ends
+static void debounce_timer_callback(void* arg) {
+    button_handle_t b = (button_handle_t)arg;
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(button_mutex, portMAX_DELAY);
+    if (b->deleted) {
+        bool last_run = !esp_timer_is_active(b->debounce_timer);
+        xSemaphoreGive(button_mutex);
+        if (last_run) {
+            release_deleted_button(b);
+        }
+        return;
+    }
+
+    // Only a level that still differs from the reported state is a change: a
+    // spike has gone by the confirming read, and bounce has settled by the
+    // end of the window. Otherwise close the window; the next edge opens a
+    // new one.
+    taskENTER_CRITICAL(&debounce_lock);
+    bool pressed = gpio_get_level(b->config.gpio_num) == b->config.active_level;
+    if (pressed == b->current_state) {
+        b->debouncing = false;
+    }
+    taskEXIT_CRITICAL(&debounce_lock);
+
+    if (pressed != b->current_state) {
+        // Ride out the bounce of this change before looking at the pin again
+        esp_timer_start_once(b->debounce_timer, DEBOUNCE_MS * 1000);
+        b->last_state = b->current_state;
+        b->current_state = pressed;
+        handle_debounced_change(b, pressed, now);
+    }
+    xSemaphoreGive(button_mutex);
+}
+
+// --- Event Delivery ---
+
+/**
+ * @brief Queues a button or chord event for the dispatcher task. Called with the mutex held.
+ */
+static void post_event(void* source, uint16_t type, int32_t value, int64_t when) {
+    input_event_t event = {
+        .timestamp_us = when,
+        .deliver = deliver_event,
+        .source = source,
+        .value = value,
+        .type = type,
+    };
+    // Never block the esp_timer task; a full queue is counted by the dispatcher
+    input_dispatcher_post(&event, 0);
+}
+
+// Runs on the input dispatcher task
+static void deliver_event(const input_event_t* event) {
+    switch (event->type) {
+    case BUTTON_INTERNAL_FREE_BUTTON: {
+        // Queued behind every event that referenced the button. In interrupt
+        // mode the debounce timer queued it and never runs again.
+        button_handle_t b = (button_handle_t)event->source;
+        if (b->config.mode == BUTTON_MODE_INTERRUPT) {
+            esp_timer_delete(b->debounce_timer);
+        }
+        free(b);
+        return;
+    }
+    case BUTTON_INTERNAL_FREE_CHORD:
+        // Queued by button_chord_delete() behind every event that referenced the chord
+        free(event->source);
+        return;
+    case BUTTON_INTERNAL_CHORD: {
+        button_chord_handle_t chord = (button_chord_handle_t)event->source;
+        button_chord_cb_t callback = chord->config.callback;
+        if (callback) {
+            callback(chord, chord->config.user_data);
+        }
+        return;
+    }
+    default:
+        break;
+    }
+
+    button_handle_t b = (button_handle_t)event->source;
+    if (event->type == BUTTON_EVENT_CLICK) {
+        b->event_clicks = (uint8_t)event->value;
+    } else if (event->type == BUTTON_EVENT_REPEAT) {
+        b->event_repeats = (uint32_t)event->value;
+    }
+    button_event_cb_t callback = b->callback;
+    if (callback) {
+        callback(b, (button_event_t)event->type, b->config.user_data);
+    }
+}
+
+// --- Gesture Engine ---
+
+static void on_press(button_handle_t b, int64_t now) {
+    b->held = true;
+    b->gesture_fired = false;
+    post_event(b, BUTTON_EVENT_PRESS, 0, now);
+
+    if (b->config.long_press_ms > 0) {
+        b->long_press_at = now + (int64_t)b->config.long_press_ms * 1000;
+    }
+    if (b->config.repeat_delay_ms > 0) {
+        b->repeat_count = 0;
+        b->repeat_interval_ms = b->config.repeat_interval_ms;
+        b->repeat_at = now + (int64_t)b->config.repeat_delay_ms * 1000;
+    }
+    // A press inside the gap continues the click sequence
+    b->click_end_at = NO_DEADLINE;
+}
+
+static void on_release(button_handle_t b, int64_t now) {
+    b->held = false;
+    b->long_press_at = NO_DEADLINE;
+    b->repeat_at = NO_DEADLINE;
+    post_event(b, BUTTON_EVENT_RELEASE, 0, now);
+
+    if (b->suppressed || b->gesture_fired || b->config.max_clicks == 0) {
+        b->suppressed = false;
+        b->click_count = 0;
+        return;
+    }
+    if (++b->click_count >= b->config.max_clicks) {
+        // Nothing longer to wait for
+        post_event(b, BUTTON_EVENT_CLICK, b->click_count, now);
+        b->click_count = 0;
+    } else {
+        b->click_end_at = now + (int64_t)b->config.click_gap_ms * 1000;
+    }
+}
+
+static bool chord_all_held(button_chord_handle_t chord) {
+    for (uint8_t i = 0; i < chord->config.num_buttons; i++) {
+        if (!chord->config.buttons[i]->held) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void update_chords(int64_t now) {
+    for (button_chord_handle_t c = chord_list_head; c != NULL; c = c->next) {
+        if (!chord_all_held(c)) {
+            c->fired = false;
+            c->fire_at = NO_DEADLINE;
+        } else if (!c->fired && c->fire_at == NO_DEADLINE) {
+            c->fire_at = now + (int64_t)c->config.hold_ms * 1000;
+        }
+    }
+}
+
+/**
+ * @brief Raises every gesture whose deadline has passed.
+ */
+static void run_deadlines(int64_t now) {
+    for (button_chord_handle_t c = chord_list_head; c != NULL; c = c->next) {
+        if (c->fire_at > now) {
+            continue;
+        }
+        post_event(c, BUTTON_INTERNAL_CHORD, 0, c->fire_at);
+        c->fire_at = NO_DEADLINE;
+        c->fired = true;
+        // The chord owns its members until they are released
+        for (uint8_t i = 0; i < c->config.num_buttons; i++) {
+            button_handle_t m = c->config.buttons[i];
+            m->suppressed = true;
+            m->long_press_at = NO_DEADLINE;
+            m->repeat_at = NO_DEADLINE;
+            m->click_end_at = NO_DEADLINE;
+            m->click_count = 0;
+        }
+    }
+
+    for (button_handle_t b = button_list_head; b != NULL; b = b->next) {
+        if (b->long_press_at <= now) {
+            post_event(b, BUTTON_EVENT_LONG_PRESS, 0, b->long_press_at);
+            b->long_press_at = NO_DEADLINE;
+            b->gesture_fired = true;
+        }
+        if (b->repeat_at <= now) {
+            post_event(b, BUTTON_EVENT_REPEAT, ++b->repeat_count, b->repeat_at);
+            b->gesture_fired = true;
+            b->repeat_at = now + (int64_t)b->repeat_interval_ms * 1000;
+            uint32_t next = b->repeat_interval_ms - b->repeat_interval_ms * b->config.repeat_accel_pct / 100;
+            b->repeat_interval_ms = next > b->config.repeat_min_interval_ms ? next : b->config.repeat_min_interval_ms;
+        }
+        if (b->click_end_at <= now) {
+            post_event(b, BUTTON_EVENT_CLICK, b->click_count, b->click_end_at);
+            b->click_end_at = NO_DEADLINE;
+            b->click_count = 0;
+        }
+    }
+}
+
+/**
+ * @brief Points the shared timer at the earliest pending deadline. Called with the mutex held.
+ */
+static void rearm_gesture_timer(int64_t now) {
+    int64_t next = NO_DEADLINE;
+    for (button_handle_t b = button_list_head; b != NULL; b = b->next) {
+        int64_t t = b->long_press_at < b->repeat_at ? b->long_press_at : b->repeat_at;
+        t = t < b->click_end_at ? t : b->click_end_at;
+        next = t < next ? t : next;
+    }
+    for (button_chord_handle_t c = chord_list_head; c != NULL; c = c->next) {
+        next = c->fire_at < next ? c->fire_at : next;
+    }
+
+    esp_timer_stop(gesture_timer);
+    if (next != NO_DEADLINE) {
+        esp_timer_start_once(gesture_timer, next > now ? (uint64_t)(next - now) : 1);
+    }
+}
+
+// Feeds one debounced edge into the gesture engine. Called with the mutex held.
+static void handle_debounced_change(button_handle_t b, bool pressed, int64_t now) {
+    if (pressed == b->held) {
+        return;
+    }
+    if (pressed) {
+        on_press(b, now);
+    } else {
+        on_release(b, now);
+    }
+    update_chords(now);
+    run_deadlines(now); // zero-length chord holds fire right away
+    rearm_gesture_timer(now);
+}
+
+// Runs in the esp_timer task whenever the earliest gesture deadline is reached
+static void gesture_timer_callback(void* arg) {
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(button_mutex, portMAX_DELAY);
+    run_deadlines(now);
+    rearm_gesture_timer(now);
+    xSemaphoreGive(button_mutex);
+}
+
+// --- Polling ---
+
+/**
+ * @brief Reads every GPIO input level at once, one bit per GPIO number.
+ */
+static inline uint64_t read_all_inputs(void) {
+    uint64_t levels = REG_READ(GPIO_IN_REG);
+#if SOC_GPIO_PIN_COUNT > 32
+    levels |= (uint64_t)(REG_READ(GPIO_IN1_REG) & GPIO_IN1_DATA) << 32;
+#endif
+    return levels;
+}
+
+// Called with the mutex held
+static void scan_add(button_handle_t b) {
+    uint64_t bit = 1ULL << b->config.gpio_num;
+    scan_buttons[b->config.gpio_num] = b;
+    // Start out settled on the current level so creation does not emit an event
+    scan_stable = b->current_state ? (scan_stable | bit) : (scan_stable & ~bit);
+    scan_ct0 |= bit;
+    scan_ct1 |= bit;
+    scan_invert = b->config.active_level ? (scan_invert & ~bit) : (scan_invert | bit);
+    scan_mask |= bit;
+}
+
+// Called with the mutex held
+static void scan_remove(button_handle_t b) {
+    scan_mask &= ~(1ULL << b->config.gpio_num);
+    scan_buttons[b->config.gpio_num] = NULL;
+}
+
+/**
+ * @brief Samples and debounces all scan-mode buttons in parallel.
+ *
+ * Each bit position carries its own 2-bit counter split across scan_ct1:scan_ct0.
+ * A counter is held at its reset value while the sample matches the stable
+ * state and counts down while it differs; when it wraps after
+ * SCAN_STABLE_SAMPLES differing samples the stable bit flips. A single bounce
+ * resets the count. The work is a handful of 64-bit operations per tick, plus
+ * one gesture update per pin that actually changed.
+ */
+static void scan_tick(int64_t now) {
+    uint64_t sample = read_all_inputs();
+
+    uint64_t differs = ((sample ^ scan_invert) ^ scan_stable) & scan_mask;
+    scan_ct0 = ~(scan_ct0 & differs);
+    scan_ct1 = scan_ct0 ^ (scan_ct1 & differs);
+    uint64_t toggled = differs & scan_ct0 & scan_ct1;
+    scan_stable ^= toggled;
+
+    while (toggled) {
+        int pin = __builtin_ctzll(toggled);
+        toggled &= toggled - 1;
+        button_handle_t b = scan_buttons[pin];
+        if (b != NULL) {
             b->last_state = b->current_state;
-            b->current_state = gpio_get_level(b->config.gpio_num) == b->config.active_level;
-
-            // --- State Change Detection ---
-            if (b->current_state != b->last_state) {
-                // State has changed, wait for debounce period
-                vTaskDelay(DEBOUNCE_TICKS);
-                // Read again after debounce
-                b->current_state = gpio_get_level(b->config.gpio_num) == b->config.active_level;
-
-                if (b->current_state != b->last_state) { // Debounced change
-                    if (b->current_state) {
-                        // --- Press Event ---
-                        if (b->callback) {
-                            b->callback(b, BUTTON_EVENT_PRESS, b->config.user_data);
-                        }
-                        // Start long press timer if applicable
-                        if (b->long_press_timer) {
-                            xTimerStart(b->long_press_timer, 0);
-                        }
-                    } else {
-                        // --- Release Event ---
-                        if (b->callback) {
-                            b->callback(b, BUTTON_EVENT_RELEASE, b->config.user_data);
-                        }
-                        // Stop long press timer if it's running
-                        if (b->long_press_timer) {
-                            xTimerStop(b->long_press_timer, 0);
-                        }
-                    }
-                }
-            }
+            b->current_state = (scan_stable >> pin) & 1;
+            handle_debounced_change(b, b->current_state, now);
         }
+    }
+}
 
-        vTaskDelayUntil(&last_poll_time, pdMS_TO_TICKS(POLLING_INTERVAL_MS));
+// Runs in the esp_timer task every POLLING_INTERVAL_MS while polled buttons exist
+static void poll_timer_callback(void* arg) {
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(button_mutex, portMAX_DELAY);
+    if (scan_mask) {
+        scan_tick(now);
     }
-}
\ No newline at end of file
+
+    // Only walk the list when it holds POLL buttons, so a tick with scan
+    // buttons alone costs the same for any number of them
+    size_t poll_buttons = polled_button_count - (size_t)__builtin_popcountll(scan_mask);
+    for (button_handle_t b = button_list_head; b != NULL && poll_buttons > 0; b = b->next) {
+        if (b->config.mode != BUTTON_MODE_POLL) {
+            continue;
+        }
+        bool sample = gpio_get_level(b->config.gpio_num) == b->config.active_level;
+
+        // --- State Change Detection ---
+        // A change must hold for DEBOUNCE_MS of consecutive samples; a sample
+        // that agrees with the current state restarts the count.
+        if (sample == b->current_state) {
+            b->debounce_count = 0;
+        } else if (++b->debounce_count >= POLL_DEBOUNCE_SAMPLES) {
+            b->debounce_count = 0;
+            b->last_state = b->current_state;
+            b->current_state = sample;
+            handle_debounced_change(b, sample, now);
+        }
+    }
+    xSemaphoreGive(button_mutex);
+}
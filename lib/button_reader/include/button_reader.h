@@ -11,6 +11,11 @@
  */
 typedef struct button_t* button_handle_t;
 
+/**
+ * @brief Opaque handle for a multi-button chord.
+ */
+typedef struct button_chord_t* button_chord_handle_t;
+
 /**
  * @brief Button event types.
  */
@@ -18,8 +23,22 @@ typedef enum {
     BUTTON_EVENT_PRESS,
     BUTTON_EVENT_RELEASE,
     BUTTON_EVENT_LONG_PRESS,
+    BUTTON_EVENT_CLICK,             /*!< A click sequence ended; see button_get_click_count(). Needs max_clicks > 0. */
+    BUTTON_EVENT_REPEAT,            /*!< Auto-repeat while held; see button_get_repeat_count(). Needs repeat_delay_ms > 0. */
 } button_event_t;
 
+/**
+ * @brief How a button's GPIO is sampled and debounced.
+ */
+typedef enum {
+    BUTTON_MODE_POLL,               /*!< Sampled every 10 ms by the shared poll timer. */
+    BUTTON_MODE_INTERRUPT,          /*!< Edge interrupt plus a per-button one-shot debounce timer; no CPU wakeups while idle.
+                                         A change is reported once the pin still reads changed a few ms after the first edge,
+                                         so single spikes are dropped; the debounce window then rejects bounce. */
+    BUTTON_MODE_SCAN,               /*!< Read with all other scan buttons in one GPIO input register access per tick and
+                                         debounced together by a vertical counter. Tick cost does not grow with the button count. */
+} button_mode_t;
+
 /**
  * @brief Callback function type for button events.
  *
@@ -37,11 +56,42 @@ typedef struct {
     bool active_level;              /*!< Logic level when the button is pressed (0 for active-low, 1 for active-high). */
     uint32_t long_press_ms;         /*!< Time in milliseconds to trigger a long-press event. Set to 0 to disable. */
     void* user_data;                /*!< User data to be passed to the callback function. */
+    button_mode_t mode;             /*!< Sampling mode. Defaults to BUTTON_MODE_POLL. */
+    uint8_t max_clicks;             /*!< Longest click sequence to recognize (2 = double, 3 = triple). 0 disables CLICK events. */
+    uint32_t click_gap_ms;          /*!< Max release-to-press gap inside a click sequence. 0 uses the default of 250 ms. */
+    uint32_t repeat_delay_ms;       /*!< Hold time before the first REPEAT event. 0 disables auto-repeat. */
+    uint32_t repeat_interval_ms;    /*!< Interval between the first repeats. */
+    uint32_t repeat_min_interval_ms;/*!< Floor the interval accelerates down to. */
+    uint8_t repeat_accel_pct;       /*!< Percentage the interval shrinks by after each repeat. 0 keeps it constant. */
 } button_config_t;
 
+/**
+ * @brief Callback function type for chord events.
+ *
+ * @param chord The chord that was recognized.
+ * @param user_data User data provided in the chord configuration.
+ */
+typedef void (*button_chord_cb_t)(button_chord_handle_t chord, void* user_data);
+
+#define BUTTON_CHORD_MAX_BUTTONS 4
+
+/**
+ * @brief Configuration for a chord: several buttons held down together.
+ */
+typedef struct {
+    button_handle_t buttons[BUTTON_CHORD_MAX_BUTTONS]; /*!< Member buttons. */
+    uint8_t num_buttons;            /*!< Number of entries used in buttons (2 or more). */
+    uint32_t hold_ms;               /*!< How long all members must be held before the chord fires. */
+    button_chord_cb_t callback;     /*!< Called once per hold. */
+    void* user_data;                /*!< User data to be passed to the callback function. */
+} button_chord_config_t;
+
 /**
  * @brief Creates a new button instance.
  *
+ * Callbacks run on the input dispatcher task, which must already be running
+ * (see input_dispatcher_start()).
+ *
  * @param config Pointer to the button configuration.
  * @return A handle to the new button instance, or NULL on failure.
  */
@@ -64,4 +114,33 @@ esp_err_t button_delete(button_handle_t handle);
  */
 esp_err_t button_register_callback(button_handle_t handle, button_event_cb_t cb);
 
+/**
+ * @brief Number of clicks in the sequence that raised the current BUTTON_EVENT_CLICK.
+ *
+ * Only meaningful inside the callback for that event.
+ */
+uint8_t button_get_click_count(button_handle_t handle);
+
+/**
+ * @brief Number of BUTTON_EVENT_REPEAT events raised during the current hold, including this one.
+ */
+uint32_t button_get_repeat_count(button_handle_t handle);
+
+/**
+ * @brief Creates a chord over existing buttons.
+ *
+ * Once the chord fires, the members' LONG_PRESS, REPEAT and CLICK gestures
+ * are suppressed until each member is released. PRESS and RELEASE are still
+ * delivered.
+ *
+ * @param config Pointer to the chord configuration.
+ * @return A handle to the new chord, or NULL on failure.
+ */
+button_chord_handle_t button_chord_create(const button_chord_config_t* config);
+
+/**
+ * @brief Deletes a chord. Delete chords before deleting their member buttons.
+ */
+esp_err_t button_chord_delete(button_chord_handle_t chord);
+
 #endif // BUTTON_READER_H
\ No newline at end of file
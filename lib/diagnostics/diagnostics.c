@@ -0,0 +1,210 @@
+#include "diagnostics.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "DIAGNOSTICS";
+
+// Heap and sampling-cost lines come before the task lines
+#define HEADER_LINES 3
+
+typedef struct {
+    TaskHandle_t handle;
+    uint32_t run_time;
+} task_counter_t;
+
+// --- Private Module State ---
+// Only touched by the sampling task; static so a sample never allocates
+static TaskStatus_t task_status[DIAGNOSTICS_MAX_TASKS];
+static task_counter_t prev_counters[DIAGNOSTICS_MAX_TASKS];
+static size_t num_prev_counters;
+static uint32_t prev_total_run_time;
+static int64_t prev_sample_us = -1;
+
+// --- Forward Declarations ---
+static uint32_t previous_run_time(TaskHandle_t handle);
+static void sort_by_cpu(diagnostics_snapshot_t* snapshot);
+
+// --- Public API Implementation ---
+
+esp_err_t diagnostics_sample(i2c_port_t i2c_port, diagnostics_snapshot_t* snapshot) {
+    if (snapshot == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int64_t start = esp_timer_get_time();
+
+    // Run-time counters are esp_timer microseconds; unsigned deltas survive the 32-bit wrap
+    uint32_t total_run_time = 0;
+    UBaseType_t count = uxTaskGetSystemState(task_status, DIAGNOSTICS_MAX_TASKS, &total_run_time);
+    if (count == 0) {
+        ESP_LOGW(TAG, "More than %d tasks, task figures skipped", DIAGNOSTICS_MAX_TASKS);
+    }
+    // The 32-bit counters cannot tell a gap longer than their wrap (about 71
+    // minutes) from a short one, so such a sample only becomes the baseline
+    uint32_t interval = total_run_time - prev_total_run_time;
+    if (prev_sample_us < 0 || start - prev_sample_us > UINT32_MAX) {
+        interval = 0;
+    }
+    prev_sample_us = start;
+    uint64_t capacity = (uint64_t)interval * portNUM_PROCESSORS;
+
+    snapshot->num_tasks = 0;
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t* status = &task_status[i];
+        diagnostics_task_t* task = &snapshot->tasks[snapshot->num_tasks++];
+        strncpy(task->name, status->pcTaskName, sizeof(task->name) - 1);
+        task->name[sizeof(task->name) - 1] = '\0';
+        task->priority = status->uxCurrentPriority;
+        task->stack_free = status->usStackHighWaterMark; // bytes on ESP-IDF
+        uint32_t used = status->ulRunTimeCounter - previous_run_time(status->xHandle);
+        task->cpu_permille = capacity ? (uint16_t)((uint64_t)used * 1000 / capacity) : 0;
+    }
+    sort_by_cpu(snapshot);
+
+    // Remember this sample's counters for the next delta
+    for (UBaseType_t i = 0; i < count; i++) {
+        prev_counters[i].handle = task_status[i].xHandle;
+        prev_counters[i].run_time = task_status[i].ulRunTimeCounter;
+    }
+    num_prev_counters = count;
+    prev_total_run_time = total_run_time;
+
+    snapshot->free_heap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    snapshot->min_free_heap = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    snapshot->largest_free_block = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+
+    i2c_bus_device_handle_t devices[DIAGNOSTICS_MAX_I2C_DEVICES];
+    size_t num_devices = i2c_bus_get_devices(i2c_port, devices, DIAGNOSTICS_MAX_I2C_DEVICES);
+    if (num_devices > DIAGNOSTICS_MAX_I2C_DEVICES) {
+        num_devices = DIAGNOSTICS_MAX_I2C_DEVICES;
+    }
+    snapshot->num_i2c = 0;
+    for (size_t i = 0; i < num_devices; i++) {
+        diagnostics_i2c_t* dev = &snapshot->i2c[snapshot->num_i2c];
+        if (i2c_bus_get_stats(devices[i], &dev->stats) != ESP_OK) {
+            continue;
+        }
+        strncpy(dev->name, i2c_bus_device_name(devices[i]), sizeof(dev->name) - 1);
+        dev->name[sizeof(dev->name) - 1] = '\0';
+        snapshot->num_i2c++;
+    }
+
+    int64_t end = esp_timer_get_time();
+    snapshot->timestamp_us = end;
+    snapshot->interval_us = interval;
+    snapshot->sample_cost_us = (uint32_t)(end - start);
+    return ESP_OK;
+}
+
+size_t diagnostics_line_count(const diagnostics_snapshot_t* snapshot) {
+    return HEADER_LINES + snapshot->num_tasks + 2 * snapshot->num_i2c;
+}
+
+bool diagnostics_format_line(const diagnostics_snapshot_t* snapshot, size_t index, char* buf, size_t size) {
+    if (snapshot == NULL || buf == NULL || size == 0 || index >= diagnostics_line_count(snapshot)) {
+        return false;
+    }
+
+    // Header: heap now / lowest ever, largest block, own cost
+    if (index == 0) {
+        snprintf(buf, size, "Heap %3luk/%3luk", (unsigned long)(snapshot->free_heap / 1024),
+                 (unsigned long)(snapshot->min_free_heap / 1024));
+        return true;
+    }
+    if (index == 1) {
+        snprintf(buf, size, "Max blk %5luk", (unsigned long)(snapshot->largest_free_block / 1024));
+        return true;
+    }
+    if (index == 2 && snapshot->interval_us == 0) {
+        snprintf(buf, size, "Diag cost    --");
+        return true;
+    }
+    if (index == 2) {
+        uint32_t cost = snapshot->interval_us ?
+            (uint32_t)((uint64_t)snapshot->sample_cost_us * 10000 / snapshot->interval_us) : 0;
+        snprintf(buf, size, "Diag cost %lu.%02lu%%", (unsigned long)(cost / 100), (unsigned long)(cost % 100));
+        return true;
+    }
+    index -= HEADER_LINES;
+
+    // Tasks: name, CPU %, free stack bytes
+    if (index < snapshot->num_tasks) {
+        const diagnostics_task_t* task = &snapshot->tasks[index];
+        uint32_t stack_free = task->stack_free > 9999 ? 9999 : task->stack_free;
+        if (snapshot->interval_us == 0) {
+            snprintf(buf, size, "%-7.7s  -- %4lu", task->name, (unsigned long)stack_free);
+        } else {
+            snprintf(buf, size, "%-7.7s%3u%% %4lu", task->name, task->cpu_permille / 10, (unsigned long)stack_free);
+        }
+        return true;
+    }
+    index -= snapshot->num_tasks;
+
+    // I2C devices: transaction count, then average/worst transfer time
+    const diagnostics_i2c_t* dev = &snapshot->i2c[index / 2];
+    if (index % 2 == 0) {
+        snprintf(buf, size, "%-4.4s%7lu tx", dev->name, (unsigned long)dev->stats.transactions);
+    } else {
+        uint32_t avg = dev->stats.transactions ?
+            (uint32_t)(dev->stats.transfer_time_us / dev->stats.transactions) : 0;
+        snprintf(buf, size, "%-4.4s%4lu/%4luus", dev->name, (unsigned long)avg,
+                 (unsigned long)dev->stats.max_transfer_us);
+    }
+    return true;
+}
+
+void diagnostics_log_report(const diagnostics_snapshot_t* snapshot) {
+    if (snapshot == NULL) {
+        return;
+    }
+    ESP_LOGI(TAG, "Heap: %lu free, %lu min ever, %lu largest block",
+             (unsigned long)snapshot->free_heap, (unsigned long)snapshot->min_free_heap,
+             (unsigned long)snapshot->largest_free_block);
+    ESP_LOGI(TAG, "Sample took %lu us over a %lu us interval",
+             (unsigned long)snapshot->sample_cost_us, (unsigned long)snapshot->interval_us);
+
+    ESP_LOGI(TAG, "%-16s %4s %6s %10s", "Task", "Prio", "CPU %", "Stack free");
+    for (uint8_t i = 0; i < snapshot->num_tasks; i++) {
+        const diagnostics_task_t* task = &snapshot->tasks[i];
+        ESP_LOGI(TAG, "%-16s %4u %4u.%u %10lu", task->name, task->priority, task->cpu_permille / 10,
+                 task->cpu_permille % 10, (unsigned long)task->stack_free);
+    }
+
+    ESP_LOGI(TAG, "%-8s %8s %8s %5s %5s %9s %9s %9s", "I2C dev", "Tx", "Bytes", "NACK", "T/O",
+             "Avg xfer", "Max xfer", "Max wait");
+    for (uint8_t i = 0; i < snapshot->num_i2c; i++) {
+        const i2c_bus_stats_t* s = &snapshot->i2c[i].stats;
+        uint32_t avg = s->transactions ? (uint32_t)(s->transfer_time_us / s->transactions) : 0;
+        ESP_LOGI(TAG, "%-8s %8lu %8lu %5lu %5lu %7luus %7luus %7luus", snapshot->i2c[i].name,
+                 (unsigned long)s->transactions, (unsigned long)s->bytes, (unsigned long)s->nacks,
+                 (unsigned long)s->timeouts, (unsigned long)avg, (unsigned long)s->max_transfer_us,
+                 (unsigned long)s->max_wait_us);
+    }
+}
+
+// --- Private Functions ---
+
+// Counter from the previous sample; 0 for tasks created since, whose whole count is new
+static uint32_t previous_run_time(TaskHandle_t handle) {
+    for (size_t i = 0; i < num_prev_counters; i++) {
+        if (prev_counters[i].handle == handle) {
+            return prev_counters[i].run_time;
+        }
+    }
+    return 0;
+}
+
+static void sort_by_cpu(diagnostics_snapshot_t* snapshot) {
+    for (uint8_t i = 1; i < snapshot->num_tasks; i++) {
+        diagnostics_task_t task = snapshot->tasks[i];
+        uint8_t j = i;
+        while (j > 0 && snapshot->tasks[j - 1].cpu_permille < task.cpu_permille) {
+            snapshot->tasks[j] = snapshot->tasks[j - 1];
+            j--;
+        }
+        snapshot->tasks[j] = task;
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "i2c_bus.h"
+
+#define DIAGNOSTICS_MAX_TASKS 24
+#define DIAGNOSTICS_MAX_I2C_DEVICES 4
+
+/**
+ * @brief Run-time figures for one task.
+ */
+typedef struct {
+    char name[configMAX_TASK_NAME_LEN];
+    UBaseType_t priority;           /*!< Current priority. */
+    uint16_t cpu_permille;          /*!< Share of total CPU time (all cores) since the previous sample, in 0.1 %. */
+    uint32_t stack_free;            /*!< Stack bytes never used since the task started. */
+} diagnostics_task_t;
+
+/**
+ * @brief Counters for one device on the shared I2C bus.
+ */
+typedef struct {
+    char name[12];
+    i2c_bus_stats_t stats;
+} diagnostics_i2c_t;
+
+/**
+ * @brief One sample of the system state.
+ */
+typedef struct {
+    int64_t timestamp_us;           /*!< When the sample was taken. */
+    uint32_t interval_us;           /*!< Time covered by the CPU figures. 0 if there are none: the first sample, or one taken too long after the previous. */
+    uint32_t sample_cost_us;        /*!< Time spent taking this sample. */
+    uint32_t free_heap;             /*!< Free internal heap, in bytes. */
+    uint32_t min_free_heap;         /*!< Lowest free internal heap since boot, in bytes. */
+    uint32_t largest_free_block;    /*!< Largest block that can currently be allocated, in bytes. */
+    uint8_t num_tasks;              /*!< Entries used in tasks, busiest first. */
+    uint8_t num_i2c;                /*!< Entries used in i2c. */
+    diagnostics_task_t tasks[DIAGNOSTICS_MAX_TASKS];
+    diagnostics_i2c_t i2c[DIAGNOSTICS_MAX_I2C_DEVICES];
+} diagnostics_snapshot_t;
+
+/**
+ * @brief Samples task run-time counters, stack high-water marks, the heap and
+ *        the I2C device counters.
+ *
+ * CPU shares are computed against the previous call, so call it from one task
+ * only and at a steady rate (about once a second). A call more than about 71
+ * minutes after the previous one, when the 32-bit run-time counters may have
+ * wrapped, only takes a new baseline and reports no CPU shares. It allocates nothing; a
+ * sample with a dozen tasks costs well under a millisecond. Needs
+ * CONFIG_FREERTOS_USE_TRACE_FACILITY and CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS.
+ *
+ * @param i2c_port Port whose devices are reported.
+ * @param snapshot Filled with the sample.
+ * @return ESP_OK on success, or ESP_ERR_INVALID_ARG.
+ */
+esp_err_t diagnostics_sample(i2c_port_t i2c_port, diagnostics_snapshot_t* snapshot);
+
+/**
+ * @brief Number of lines diagnostics_format_line() produces for a snapshot.
+ */
+size_t diagnostics_line_count(const diagnostics_snapshot_t* snapshot);
+
+/**
+ * @brief Formats one line of the snapshot for a narrow display (16 columns).
+ *
+ * Lines are the heap figures and the sampling cost, then one per task, then
+ * two per I2C device.
+ *
+ * @return false if index is past the last line.
+ */
+bool diagnostics_format_line(const diagnostics_snapshot_t* snapshot, size_t index, char* buf, size_t size);
+
+/**
+ * @brief Logs the full snapshot as a table (ESP_LOGI).
+ */
+void diagnostics_log_report(const diagnostics_snapshot_t* snapshot);
+
+#endif // DIAGNOSTICS_H
@@ -0,0 +1,466 @@
+#include "display_server.h"
+#include "lcd_i2c.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include <string.h>
+
+static const char *TAG = "DISPLAY_SERVER";
+
+#define DISPLAY_TASK_STACK_SIZE 3072
+#define DISPLAY_GLYPH_SLOTS 8
+#define DEFAULT_MARQUEE_STEP_MS 300
+#define MARQUEE_GAP 4 // blank cells between the end of a marquee and its next start
+
+typedef enum {
+    DISPLAY_CMD_TEXT,
+    DISPLAY_CMD_LINE,
+    DISPLAY_CMD_CLEAR_REGION,
+    DISPLAY_CMD_SET_GLYPH,
+    DISPLAY_CMD_MARQUEE_START,
+    DISPLAY_CMD_MARQUEE_STOP,
+} display_cmd_type_t;
+
+/**
+ * @brief A queued draw command. Text is copied in so producers never share buffers with the server.
+ */
+typedef struct {
+    uint8_t type;
+    uint8_t row;
+    uint8_t col;
+    uint8_t len;
+    union {
+        char text[DISPLAY_SERVER_MAX_TEXT];
+        uint8_t glyph[8];
+    };
+} display_cmd_t;
+
+/**
+ * @brief A row scrolling through a text, owned by the server task.
+ */
+typedef struct {
+    char text[DISPLAY_SERVER_MAX_MARQUEE_TEXT];
+    uint8_t len;
+    uint8_t pos;                    // text cell shown in column 0
+    bool active;
+    bool scrolls;                   // false if the text fits the row
+} marquee_t;
+
+// --- Private Module State ---
+static QueueHandle_t cmd_queue = NULL;
+static TaskHandle_t server_task_handle = NULL;
+static display_server_config_t server_config;
+static volatile bool redraw_requested = false;
+
+// Frame pacing and latency accounting; stats_lock guards both
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t pending_input_us = 0;
+static display_server_stats_t stats;
+
+// CGRAM contents: what producers asked for and what the panel currently holds
+static uint8_t glyph_pending[DISPLAY_GLYPH_SLOTS][8];
+static uint8_t glyph_loaded[DISPLAY_GLYPH_SLOTS][8];
+static uint8_t glyph_dirty_mask = 0;
+
+// Marquee text does not fit in a command: producers leave it here under the
+// lock and the start command picks it up, in order with the other draws.
+static portMUX_TYPE marquee_lock = portMUX_INITIALIZER_UNLOCKED;
+static char marquee_pending[DISPLAY_SERVER_MAX_ROWS][DISPLAY_SERVER_MAX_MARQUEE_TEXT];
+static uint8_t marquee_pending_len[DISPLAY_SERVER_MAX_ROWS];
+static marquee_t marquees[DISPLAY_SERVER_MAX_ROWS];
+static uint8_t num_scrolling = 0;
+static int64_t next_step_us = 0;
+
+// --- Forward Declarations ---
+static void server_task(void* arg);
+static esp_err_t submit(const display_cmd_t* cmd);
+static void apply_command(const display_cmd_t* cmd);
+static void upload_glyphs(void);
+static void wait_for_frame_slot(int64_t last_flush_us);
+static void record_frame(int64_t input_us, int64_t flushed_us);
+static void start_marquee(uint8_t row);
+static void stop_marquee(uint8_t row);
+static void update_marquees(void);
+static TickType_t marquee_wait(void);
+static TickType_t us_to_ticks(int64_t us);
+
+// --- Public API Implementation ---
+
+esp_err_t display_server_start(const display_server_config_t* config) {
+    if (config == NULL || config->queue_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (server_task_handle != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    server_config = *config;
+    if (server_config.marquee_step_ms == 0) {
+        server_config.marquee_step_ms = DEFAULT_MARQUEE_STEP_MS;
+    }
+    cmd_queue = xQueueCreate(config->queue_size, sizeof(display_cmd_t));
+    if (cmd_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create command queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(server_task, "display_server", DISPLAY_TASK_STACK_SIZE, NULL,
+                    config->task_priority, &server_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create display server task");
+        vQueueDelete(cmd_queue);
+        cmd_queue = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Display server started (queue size %lu)", (unsigned long)config->queue_size);
+    return ESP_OK;
+}
+
+esp_err_t display_server_put_text(uint8_t row, uint8_t col, const char* text) {
+    if (text == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    display_cmd_t cmd = {
+        .type = DISPLAY_CMD_TEXT,
+        .row = row,
+        .col = col,
+    };
+    size_t len = strnlen(text, DISPLAY_SERVER_MAX_TEXT);
+    memcpy(cmd.text, text, len);
+    cmd.len = (uint8_t)len;
+    return submit(&cmd);
+}
+
+esp_err_t display_server_put_line(uint8_t row, const char* text) {
+    if (text == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    display_cmd_t cmd = {
+        .type = DISPLAY_CMD_LINE,
+        .row = row,
+    };
+    size_t len = strnlen(text, DISPLAY_SERVER_MAX_TEXT);
+    memcpy(cmd.text, text, len);
+    cmd.len = (uint8_t)len;
+    return submit(&cmd);
+}
+
+esp_err_t display_server_clear_region(uint8_t row, uint8_t col, uint8_t len) {
+    display_cmd_t cmd = {
+        .type = DISPLAY_CMD_CLEAR_REGION,
+        .row = row,
+        .col = col,
+        .len = len,
+    };
+    return submit(&cmd);
+}
+
+esp_err_t display_server_set_glyph(uint8_t slot, const uint8_t bitmap[8]) {
+    if (slot >= DISPLAY_GLYPH_SLOTS || bitmap == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    display_cmd_t cmd = {
+        .type = DISPLAY_CMD_SET_GLYPH,
+        .row = slot,
+    };
+    memcpy(cmd.glyph, bitmap, sizeof(cmd.glyph));
+    return submit(&cmd);
+}
+
+esp_err_t display_server_set_marquee(uint8_t row, const char* text) {
+    if (text == NULL || row >= DISPLAY_SERVER_MAX_ROWS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t len = strnlen(text, DISPLAY_SERVER_MAX_MARQUEE_TEXT);
+    taskENTER_CRITICAL(&marquee_lock);
+    memcpy(marquee_pending[row], text, len);
+    marquee_pending_len[row] = (uint8_t)len;
+    taskEXIT_CRITICAL(&marquee_lock);
+
+    display_cmd_t cmd = {
+        .type = DISPLAY_CMD_MARQUEE_START,
+        .row = row,
+    };
+    return submit(&cmd);
+}
+
+esp_err_t display_server_clear_marquee(uint8_t row) {
+    if (row >= DISPLAY_SERVER_MAX_ROWS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    display_cmd_t cmd = {
+        .type = DISPLAY_CMD_MARQUEE_STOP,
+        .row = row,
+    };
+    return submit(&cmd);
+}
+
+void display_server_request_redraw(void) {
+    redraw_requested = true;
+    if (server_task_handle != NULL) {
+        xTaskNotifyGive(server_task_handle);
+    }
+}
+
+void IRAM_ATTR display_server_request_redraw_from_isr(void) {
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    redraw_requested = true;
+    if (server_task_handle != NULL) {
+        vTaskNotifyGiveFromISR(server_task_handle, &higher_priority_task_woken);
+    }
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+void display_server_note_input(int64_t input_us) {
+    if (input_us <= 0) {
+        return;
+    }
+    taskENTER_CRITICAL(&stats_lock);
+    if (pending_input_us == 0 || input_us < pending_input_us) {
+        pending_input_us = input_us;
+    }
+    taskEXIT_CRITICAL(&stats_lock);
+}
+
+esp_err_t display_server_get_stats(display_server_stats_t* out) {
+    if (out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    taskENTER_CRITICAL(&stats_lock);
+    *out = stats;
+    taskEXIT_CRITICAL(&stats_lock);
+    return ESP_OK;
+}
+
+void display_server_reset_stats(void) {
+    taskENTER_CRITICAL(&stats_lock);
+    memset(&stats, 0, sizeof(stats));
+    taskEXIT_CRITICAL(&stats_lock);
+}
+
+// --- Private Functions ---
+
+static esp_err_t submit(const display_cmd_t* cmd) {
+    if (cmd_queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t err = ESP_OK;
+    if (xQueueSend(cmd_queue, cmd, 0) != pdTRUE) {
+        // Never wait for the panel: fall back to rebuilding the screen from the model
+        redraw_requested = true;
+        err = ESP_ERR_TIMEOUT;
+    }
+    xTaskNotifyGive(server_task_handle);
+    return err;
+}
+
+static void apply_command(const display_cmd_t* cmd) {
+    switch (cmd->type) {
+    case DISPLAY_CMD_TEXT:
+        for (uint8_t i = 0; i < cmd->len; i++) {
+            lcd_i2c_fb_put_char(cmd->row, cmd->col + i, cmd->text[i]);
+        }
+        break;
+    case DISPLAY_CMD_LINE: {
+        char line[DISPLAY_SERVER_MAX_TEXT + 1];
+        memcpy(line, cmd->text, cmd->len);
+        line[cmd->len] = '\0';
+        lcd_i2c_fb_write_line(cmd->row, line);
+        break;
+    }
+    case DISPLAY_CMD_CLEAR_REGION:
+        for (uint8_t i = 0; i < cmd->len; i++) {
+            lcd_i2c_fb_put_char(cmd->row, cmd->col + i, ' ');
+        }
+        break;
+    case DISPLAY_CMD_SET_GLYPH:
+        for (int i = 0; i < 8; i++) {
+            glyph_pending[cmd->row][i] = cmd->glyph[i] & 0x1F;
+        }
+        glyph_dirty_mask |= 1 << cmd->row;
+        break;
+    case DISPLAY_CMD_MARQUEE_START:
+        start_marquee(cmd->row);
+        break;
+    case DISPLAY_CMD_MARQUEE_STOP:
+        stop_marquee(cmd->row);
+        break;
+    default:
+        break;
+    }
+}
+
+static void upload_glyphs(void) {
+    for (uint8_t slot = 0; glyph_dirty_mask != 0; slot++) {
+        if (!(glyph_dirty_mask & (1 << slot))) {
+            continue;
+        }
+        glyph_dirty_mask &= ~(1 << slot);
+        if (memcmp(glyph_loaded[slot], glyph_pending[slot], 8) != 0) {
+            lcd_i2c_create_char(slot, glyph_pending[slot]);
+            memcpy(glyph_loaded[slot], glyph_pending[slot], 8);
+        }
+    }
+}
+
+// Holds the frame back until frame_budget_ms after the previous flush, so a
+// burst of changes is drawn once. An isolated change is not delayed.
+static void wait_for_frame_slot(int64_t last_flush_us) {
+    if (server_config.frame_budget_ms == 0) {
+        return;
+    }
+    int64_t wait_us = last_flush_us + (int64_t)server_config.frame_budget_ms * 1000 - esp_timer_get_time();
+    if (wait_us > 0) {
+        vTaskDelay(us_to_ticks(wait_us));
+        // Notifications given while waiting are served by this frame
+        ulTaskNotifyTake(pdTRUE, 0);
+    }
+}
+
+static TickType_t us_to_ticks(int64_t us) {
+    return (TickType_t)((us + portTICK_PERIOD_MS * 1000 - 1) / (portTICK_PERIOD_MS * 1000));
+}
+
+static void start_marquee(uint8_t row) {
+    marquee_t* marquee = &marquees[row];
+    taskENTER_CRITICAL(&marquee_lock);
+    marquee->len = marquee_pending_len[row];
+    memcpy(marquee->text, marquee_pending[row], marquee->len);
+    taskEXIT_CRITICAL(&marquee_lock);
+
+    if (marquee->scrolls) {
+        num_scrolling--;
+    }
+    marquee->active = true;
+    marquee->pos = 0;
+    marquee->scrolls = marquee->len > lcd_i2c_get_cols();
+    if (marquee->scrolls && num_scrolling++ == 0) {
+        next_step_us = esp_timer_get_time() + (int64_t)server_config.marquee_step_ms * 1000;
+    }
+}
+
+static void stop_marquee(uint8_t row) {
+    marquee_t* marquee = &marquees[row];
+    if (marquee->scrolls) {
+        num_scrolling--;
+    }
+    marquee->active = false;
+    marquee->scrolls = false;
+    lcd_i2c_fb_write_line(row, "");
+}
+
+// Advances every scrolling marquee when a step is due, all by the same cell,
+// and draws each marquee's window into the framebuffer
+static void update_marquees(void) {
+    int64_t now = esp_timer_get_time();
+    bool step = num_scrolling > 0 && now >= next_step_us;
+    if (step) {
+        int64_t step_us = (int64_t)server_config.marquee_step_ms * 1000;
+        next_step_us += step_us;
+        if (next_step_us <= now) {
+            next_step_us = now + step_us; // fell behind; do not catch up in a burst
+        }
+    }
+
+    uint8_t cols = lcd_i2c_get_cols();
+    for (uint8_t row = 0; row < DISPLAY_SERVER_MAX_ROWS; row++) {
+        marquee_t* marquee = &marquees[row];
+        if (!marquee->active) {
+            continue;
+        }
+        uint8_t period = marquee->len + MARQUEE_GAP;
+        if (step && marquee->scrolls) {
+            marquee->pos = (marquee->pos + 1) % period;
+        }
+        for (uint8_t col = 0; col < cols; col++) {
+            uint8_t index = marquee->scrolls ? (marquee->pos + col) % period : col;
+            lcd_i2c_fb_put_char(row, col, index < marquee->len ? marquee->text[index] : ' ');
+        }
+    }
+}
+
+// Ticks until the next marquee step, or forever when nothing scrolls
+static TickType_t marquee_wait(void) {
+    if (num_scrolling == 0) {
+        return portMAX_DELAY;
+    }
+    int64_t wait_us = next_step_us - esp_timer_get_time();
+    return wait_us > 0 ? us_to_ticks(wait_us) : 0;
+}
+
+static void record_frame(int64_t input_us, int64_t flushed_us) {
+    taskENTER_CRITICAL(&stats_lock);
+    stats.frames++;
+    if (input_us > 0) {
+        uint32_t latency_us = (uint32_t)(flushed_us - input_us);
+        uint32_t ms = latency_us / 1000;
+        uint8_t bucket = 0;
+        while (ms > 0 && bucket < DISPLAY_SERVER_LATENCY_BUCKETS - 1) {
+            ms >>= 1;
+            bucket++;
+        }
+        stats.latency_buckets[bucket]++;
+        stats.input_frames++;
+        stats.total_latency_us += latency_us;
+        if (latency_us > stats.max_latency_us) {
+            stats.max_latency_us = latency_us;
+        }
+    }
+    taskEXIT_CRITICAL(&stats_lock);
+}
+
+static void server_task(void* arg) {
+    display_cmd_t cmd;
+    int64_t last_flush_us = 0;
+
+    // CGRAM content is undefined at power-on; 0xFF never matches a 5-bit row,
+    // so the first request for every slot is uploaded
+    memset(glyph_loaded, 0xFF, sizeof(glyph_loaded));
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, marquee_wait());
+        wait_for_frame_slot(last_flush_us);
+
+        // Inputs noted from here on may miss this frame and count towards the next
+        taskENTER_CRITICAL(&stats_lock);
+        int64_t input_us = pending_input_us;
+        pending_input_us = 0;
+        taskEXIT_CRITICAL(&stats_lock);
+
+        // Apply everything that is pending to the framebuffer first. Commands
+        // that overwrite the same cells collapse there, so only the final
+        // content of each cell reaches the bus.
+        while (xQueueReceive(cmd_queue, &cmd, 0) == pdTRUE) {
+            apply_command(&cmd);
+        }
+
+        if (redraw_requested) {
+            redraw_requested = false;
+            if (server_config.render_cb) {
+                server_config.render_cb(server_config.user_data);
+            }
+        }
+
+        // Marquee rows are drawn last; they own their rows
+        update_marquees();
+
+        upload_glyphs();
+
+        size_t bytes_sent;
+        esp_err_t err = lcd_i2c_fb_flush(&bytes_sent);
+        last_flush_us = esp_timer_get_time();
+        record_frame(input_us, last_flush_us);
+        if (err == ESP_ERR_INVALID_RESPONSE) {
+            // The panel was set up again and may have lost its glyphs
+            ESP_LOGW(TAG, "LCD re-initialized, reloading glyphs");
+            memset(glyph_loaded, 0xFF, sizeof(glyph_loaded));
+            glyph_dirty_mask = (1 << DISPLAY_GLYPH_SLOTS) - 1;
+            upload_glyphs();
+        } else if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Flush failed: %s", esp_err_to_name(err));
+        } else {
+            ESP_LOGD(TAG, "Flush sent %u bytes", (unsigned)bytes_sent);
+        }
+    }
+}
@@ -0,0 +1,145 @@
+#ifndef DISPLAY_SERVER_H
+#define DISPLAY_SERVER_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+/**
+ * @brief Longest text a single draw command can carry.
+ */
+#define DISPLAY_SERVER_MAX_TEXT 20
+
+/**
+ * @brief Longest text a marquee can scroll, and the number of rows that can have one.
+ */
+#define DISPLAY_SERVER_MAX_MARQUEE_TEXT 64
+#define DISPLAY_SERVER_MAX_ROWS 4
+
+/**
+ * @brief Callback used to rebuild screen content from the application model.
+ *
+ * Runs on the display server task, which is the only owner of the LCD, so it
+ * may draw directly with the lcd_i2c_fb_* functions. It is called after a
+ * redraw request and whenever the command queue overflowed. An overflow drops
+ * the draw that did not fit, so the callback must redraw whatever content the
+ * application would not otherwise queue again; content that its owner
+ * re-queues periodically may be left to the next update.
+ *
+ * @param user_data User data provided in the configuration.
+ */
+typedef void (*display_render_cb_t)(void* user_data);
+
+/**
+ * @brief Configuration for the display server.
+ */
+typedef struct {
+    uint32_t queue_size;            /*!< Number of draw commands that can be pending. */
+    UBaseType_t task_priority;      /*!< Priority of the display server task. */
+    display_render_cb_t render_cb;  /*!< Optional full-redraw callback. */
+    void* user_data;                /*!< User data passed to render_cb. */
+    uint32_t frame_budget_ms;       /*!< Minimum time between flushes; changes in between share one flush. 0 flushes every change at once. */
+    uint32_t marquee_step_ms;       /*!< Time between marquee steps, shared by all rows. 0 selects 300 ms. */
+} display_server_config_t;
+
+#define DISPLAY_SERVER_LATENCY_BUCKETS 10
+
+/**
+ * @brief Frame counters and the input-to-pixel latency histogram.
+ *
+ * Bucket 0 counts latencies under 1 ms, bucket i (1-8) those from 2^(i-1) to
+ * 2^i ms, and the last bucket everything from 256 ms up.
+ */
+typedef struct {
+    uint32_t frames;                /*!< Flushes, including those that sent nothing. */
+    uint32_t input_frames;          /*!< Flushes that showed the result of an input; the histogram total. */
+    uint32_t latency_buckets[DISPLAY_SERVER_LATENCY_BUCKETS];
+    uint32_t max_latency_us;        /*!< Worst input-to-pixel latency. */
+    uint64_t total_latency_us;      /*!< Sum of all input-to-pixel latencies. */
+} display_server_stats_t;
+
+/**
+ * @brief Starts the display server task. The LCD must already be initialized.
+ *
+ * @param config Pointer to the display server configuration.
+ * @return ESP_OK on success, or an error code on failure.
+ */
+esp_err_t display_server_start(const display_server_config_t* config);
+
+/**
+ * @brief Queues text to be drawn at row/col. Never blocks.
+ *
+ * @return ESP_OK if queued, ESP_ERR_TIMEOUT if the queue was full (the text
+ *         is dropped and the render callback is scheduled instead), or
+ *         ESP_ERR_INVALID_STATE if the server is not running.
+ */
+esp_err_t display_server_put_text(uint8_t row, uint8_t col, const char* text);
+
+/**
+ * @brief Queues text for a whole row, padding the rest of the row with spaces. Never blocks.
+ */
+esp_err_t display_server_put_line(uint8_t row, const char* text);
+
+/**
+ * @brief Queues blanking of len cells starting at row/col. Never blocks.
+ */
+esp_err_t display_server_clear_region(uint8_t row, uint8_t col, uint8_t len);
+
+/**
+ * @brief Queues programming of a custom glyph into CGRAM slot 0-7. Never blocks.
+ */
+esp_err_t display_server_set_glyph(uint8_t slot, const uint8_t bitmap[8]);
+
+/**
+ * @brief Queues text that scrolls through a row, one cell per marquee step. Never blocks.
+ *
+ * Text that fits the row is drawn as is. Longer text moves left continuously,
+ * with a gap before it comes round again. The row belongs to the marquee until
+ * display_server_clear_marquee(): other draws to it are overwritten. All
+ * marquees step together, so when the other rows are blank the LCD driver can
+ * scroll with the display-shift instruction instead of rewriting the row.
+ *
+ * @param text Up to DISPLAY_SERVER_MAX_MARQUEE_TEXT characters; longer text is cut.
+ * @return ESP_OK if queued, or an error as for display_server_put_text().
+ */
+esp_err_t display_server_set_marquee(uint8_t row, const char* text);
+
+/**
+ * @brief Queues the end of a row's marquee and blanks the row. Never blocks.
+ */
+esp_err_t display_server_clear_marquee(uint8_t row);
+
+/**
+ * @brief Asks the server to call the render callback and flush. Never blocks.
+ *
+ * Requests made before the server gets to run are merged into one redraw.
+ */
+void display_server_request_redraw(void);
+
+/**
+ * @brief ISR-safe variant of display_server_request_redraw().
+ */
+void display_server_request_redraw_from_isr(void);
+
+/**
+ * @brief Tells the server that the next changes show the result of an input.
+ *
+ * The time from input_us to the end of the flush that follows is added to
+ * the latency histogram. When several inputs share a frame, the earliest
+ * one counts.
+ *
+ * @param input_us esp_timer time at which the input was detected; 0 is ignored.
+ */
+void display_server_note_input(int64_t input_us);
+
+/**
+ * @brief Copies the frame counters and latency histogram.
+ */
+esp_err_t display_server_get_stats(display_server_stats_t* stats);
+
+/**
+ * @brief Clears the frame counters and latency histogram.
+ */
+void display_server_reset_stats(void);
+
+#endif // DISPLAY_SERVER_H
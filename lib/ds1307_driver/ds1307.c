@@ -1,133 +1,114 @@
 #include "ds1307.h"
 #include <stdbool.h>
 
-static i2c_port_t i2c_port;
+#define DS1307_REG_SECONDS 0x00
+#define DS1307_REG_CONTROL 0x07
+#define DS1307_REG_NVRAM 0x08
+#define DS1307_CONTROL_SQWE (1 << 4)
 
-static uint8_t bcd_to_dec(uint8_t val) {
-    return (val >> 4) * 10 + (val & 0x0F);
-}
+static i2c_bus_device_handle_t dev;
 
-static uint8_t dec_to_bcd(uint8_t val) {
-    return ((val / 10) << 4) | (val % 10);
-}
+static esp_err_t ds1307_read_regs(uint8_t reg, uint8_t *data, size_t len);
+static esp_err_t ds1307_write_regs(uint8_t reg, const uint8_t *data, size_t len);
+static esp_err_t ds1307_set_tick(rtc_tick_t tick);
+
+const rtc_device_t ds1307_rtc_device = {
+    .name = "ds1307",
+    .get_time = ds1307_get_time,
+    .set_time = ds1307_set_time,
+    .set_tick = ds1307_set_tick,
+};
 
 esp_err_t ds1307_init(const ds1307_config_t *config) {
-    i2c_port = config->i2c_port;
-    i2c_config_t conf = {
-        .mode = I2C_MODE_MASTER,
-        .sda_io_num = config->sda_pin,
-        .scl_io_num = config->scl_pin,
-        .sda_pullup_en = GPIO_PULLUP_ENABLE,
-        .scl_pullup_en = GPIO_PULLUP_ENABLE,
-        .master.clk_speed = 100000,
+    i2c_bus_device_config_t dev_conf = {
+        .i2c_port = config->i2c_port,
+        .address = DS1307_I2C_ADDRESS,
+        .priority = I2C_BUS_PRIORITY_HIGH, // time reads must not queue behind display repaints
+        .name = "ds1307",
     };
-    i2c_param_config(i2c_port, &conf);
-    return i2c_driver_install(i2c_port, conf.mode, 0, 0, 0);
+    dev = i2c_bus_add_device(&dev_conf);
+    return dev ? ESP_OK : ESP_ERR_INVALID_STATE;
 }
 
 esp_err_t ds1307_set_time(const rtc_time_t *time) {
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (DS1307_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(cmd, 0x00, true); // Start at register 0
-
-    i2c_master_write_byte(cmd, dec_to_bcd(time->seconds), true);
-    i2c_master_write_byte(cmd, dec_to_bcd(time->minutes), true);
-    i2c_master_write_byte(cmd, dec_to_bcd(time->hours), true);
-    i2c_master_write_byte(cmd, dec_to_bcd(time->day), true);
-    i2c_master_write_byte(cmd, dec_to_bcd(time->date), true);
-    i2c_master_write_byte(cmd, dec_to_bcd(time->month), true);
-    i2c_master_write_byte(cmd, dec_to_bcd(time->year), true);
-
-    i2c_master_stop(cmd);
-    esp_err_t ret = i2c_master_cmd_begin(i2c_port, cmd, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
-    return ret;
+    uint8_t data[7];
+    rtc_device_encode_time(time, data);
+    return ds1307_write_regs(DS1307_REG_SECONDS, data, sizeof(data));
 }
 
 esp_err_t ds1307_get_time(rtc_time_t *time) {
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (DS1307_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(cmd, 0x00, true); // Start at register 0
-    i2c_master_stop(cmd);
-    esp_err_t ret = i2c_master_cmd_begin(i2c_port, cmd, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
-
+    uint8_t data[7];
+    esp_err_t ret = ds1307_read_regs(DS1307_REG_SECONDS, data, sizeof(data));
     if (ret != ESP_OK) {
         return ret;
     }
 
-    cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (DS1307_I2C_ADDRESS << 1) | I2C_MASTER_READ, true);
-
-    i2c_master_read_byte(cmd, &time->seconds, I2C_MASTER_ACK);
-    i2c_master_read_byte(cmd, &time->minutes, I2C_MASTER_ACK);
-    i2c_master_read_byte(cmd, &time->hours, I2C_MASTER_ACK);
-    i2c_master_read_byte(cmd, &time->day, I2C_MASTER_ACK);
-    i2c_master_read_byte(cmd, &time->date, I2C_MASTER_ACK);
-    i2c_master_read_byte(cmd, &time->month, I2C_MASTER_ACK);
-    i2c_master_read_byte(cmd, &time->year, I2C_MASTER_NACK);
-
-    i2c_master_stop(cmd);
-    ret = i2c_master_cmd_begin(i2c_port, cmd, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
-
-    time->seconds = bcd_to_dec(time->seconds & 0x7F); // Mask the CH bit
-    time->minutes = bcd_to_dec(time->minutes);
-    time->hours = bcd_to_dec(time->hours);
-    time->day = bcd_to_dec(time->day);
-    time->date = bcd_to_dec(time->date);
-    time->month = bcd_to_dec(time->month);
-    time->year = bcd_to_dec(time->year);
-
+    rtc_device_decode_time(data, time);
     return ret;
 }
 
 esp_err_t ds1307_is_running(bool *is_running) {
     uint8_t seconds;
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (DS1307_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(cmd, 0x00, true); // Start at register 0
-    i2c_master_stop(cmd);
-    esp_err_t ret = i2c_master_cmd_begin(i2c_port, cmd, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
-
+    esp_err_t ret = ds1307_read_regs(DS1307_REG_SECONDS, &seconds, 1);
     if (ret != ESP_OK) {
         return ret;
     }
 
-    cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (DS1307_I2C_ADDRESS << 1) | I2C_MASTER_READ, true);
-    i2c_master_read_byte(cmd, &seconds, I2C_MASTER_NACK);
-    i2c_master_stop(cmd);
-    ret = i2c_master_cmd_begin(i2c_port, cmd, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
-
     *is_running = !(seconds & (1 << 7));
 
     return ret;
 }
 
 esp_err_t ds1307_reset(void) {
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (DS1307_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(cmd, 0x00, true); // Start at register 0
-
-    i2c_master_write_byte(cmd, 0x80, true); // Halt clock and clear seconds
-    i2c_master_write_byte(cmd, 0x00, true); // Clear minutes
-    i2c_master_write_byte(cmd, 0x00, true); // Clear hours
-    i2c_master_write_byte(cmd, 0x00, true); // Clear day
-    i2c_master_write_byte(cmd, 0x00, true); // Clear date
-    i2c_master_write_byte(cmd, 0x00, true); // Clear month
-    i2c_master_write_byte(cmd, 0x00, true); // Clear year
-
-    i2c_master_stop(cmd);
-    esp_err_t ret = i2c_master_cmd_begin(i2c_port, cmd, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
-    return ret;
+    const uint8_t data[7] = {
+        0x80, // Halt clock and clear seconds
+        0x00, // Clear minutes
+        0x00, // Clear hours
+        0x00, // Clear day
+        0x00, // Clear date
+        0x00, // Clear month
+        0x00, // Clear year
+    };
+    return ds1307_write_regs(DS1307_REG_SECONDS, data, sizeof(data));
+}
+
+esp_err_t ds1307_set_sqw(bool enable, ds1307_sqw_rate_t rate) {
+    uint8_t control = enable ? (DS1307_CONTROL_SQWE | (rate & 0x03)) : DS1307_CONTROL_OUT;
+    return ds1307_write_regs(DS1307_REG_CONTROL, &control, 1);
+}
+
+esp_err_t ds1307_nvram_read(uint8_t offset, uint8_t *data, size_t len) {
+    if (data == NULL || len == 0 || offset + len > DS1307_NVRAM_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ds1307_read_regs(DS1307_REG_NVRAM + offset, data, len);
+}
+
+esp_err_t ds1307_nvram_write(uint8_t offset, const uint8_t *data, size_t len) {
+    if (data == NULL || len == 0 || offset + len > DS1307_NVRAM_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ds1307_write_regs(DS1307_REG_NVRAM + offset, data, len);
+}
+
+// The SQW/OUT pin has no alarm; it can only carry the 1 Hz square wave
+static esp_err_t ds1307_set_tick(rtc_tick_t tick) {
+    switch (tick) {
+    case RTC_TICK_NONE:
+        return ds1307_set_sqw(false, DS1307_SQW_1HZ);
+    case RTC_TICK_SECOND:
+        return ds1307_set_sqw(true, DS1307_SQW_1HZ);
+    default:
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+}
+
+// Burst read: register pointer write, repeated START, sequential read
+static esp_err_t ds1307_read_regs(uint8_t reg, uint8_t *data, size_t len) {
+    return i2c_bus_write_read(dev, &reg, 1, data, len);
+}
+
+// Burst write: register pointer followed by the data, auto-incrementing
+static esp_err_t ds1307_write_regs(uint8_t reg, const uint8_t *data, size_t len) {
+    return i2c_bus_write(dev, &reg, 1, data, len);
 }
@@ -3,24 +3,23 @@
 
 #include <time.h>
 #include "driver/i2c.h"
+#include "i2c_bus.h"
+#include "rtc_device.h"
 #include <stdbool.h>
 
 #define DS1307_I2C_ADDRESS 0x68
+#define DS1307_NVRAM_SIZE 56 // battery-backed RAM at registers 0x08-0x3F
+#define DS1307_CONTROL_OUT 0x80 // SQW/OUT level while the square wave is off
 
-typedef struct {
-    uint8_t seconds;
-    uint8_t minutes;
-    uint8_t hours;
-    uint8_t day;
-    uint8_t date;
-    uint8_t month;
-    uint8_t year;
-} rtc_time_t;
+typedef enum {
+    DS1307_SQW_1HZ = 0,
+    DS1307_SQW_4096HZ = 1,
+    DS1307_SQW_8192HZ = 2,
+    DS1307_SQW_32768HZ = 3,
+} ds1307_sqw_rate_t;
 
 typedef struct {
-    i2c_port_t i2c_port;
-    int sda_pin;
-    int scl_pin;
+    i2c_port_t i2c_port; // must already be set up with i2c_bus_init()
 } ds1307_config_t;
 
 esp_err_t ds1307_init(const ds1307_config_t *config);
@@ -29,4 +28,15 @@ esp_err_t ds1307_get_time(rtc_time_t *time);
 esp_err_t ds1307_is_running(bool *is_running);
 esp_err_t ds1307_reset(void);
 
+// Configures the SQW/OUT pin (control register 0x07). The output is open drain;
+// disabled, it is released (OUT = 1) so the pull-up holds the line high.
+esp_err_t ds1307_set_sqw(bool enable, ds1307_sqw_rate_t rate);
+
+// Bulk access to the battery-backed NVRAM; offset is relative to its start (0-55)
+esp_err_t ds1307_nvram_read(uint8_t offset, uint8_t *data, size_t len);
+esp_err_t ds1307_nvram_write(uint8_t offset, const uint8_t *data, size_t len);
+
+// rtc_device_t for rtc_clock: 1 Hz ticks on SQW/OUT, no alarm
+extern const rtc_device_t ds1307_rtc_device;
+
 #endif // DS1307_H
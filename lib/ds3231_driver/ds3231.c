@@ -0,0 +1,311 @@
+#include "ds3231.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG = "DS3231";
+
+#define DS3231_REG_SECONDS 0x00
+#define DS3231_REG_ALARM_1 0x07
+#define DS3231_REG_ALARM_2 0x0B
+#define DS3231_REG_CONTROL 0x0E
+#define DS3231_REG_STATUS 0x0F
+#define DS3231_REG_AGING 0x10
+#define DS3231_REG_TEMP_MSB 0x11
+
+#define DS3231_CONTROL_EOSC (1 << 7)    // active low: oscillator stops on battery when set
+#define DS3231_CONTROL_RS_MASK (3 << 3) // 00 = 1 Hz
+#define DS3231_CONTROL_INTCN (1 << 2)
+#define DS3231_CONTROL_A2IE (1 << 1)
+#define DS3231_CONTROL_A1IE (1 << 0)
+
+#define DS3231_STATUS_OSF (1 << 7)
+#define DS3231_STATUS_A2F (1 << 1)
+#define DS3231_STATUS_A1F (1 << 0)
+
+#define DS3231_ALARM_MASK (1 << 7)      // Ax Mn: the field is not compared
+#define DS3231_ALARM_DY (1 << 6)        // day field holds the weekday, not the date
+
+// --- Private Module State ---
+static i2c_bus_device_handle_t dev;
+static portMUX_TYPE control_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t control;             // cached copy of the control register
+
+// --- Forward Declarations ---
+static esp_err_t update_control(uint8_t clear, uint8_t set);
+static esp_err_t clear_flags(uint8_t flags);
+static esp_err_t ds3231_read_regs(uint8_t reg, uint8_t* data, size_t len);
+static esp_err_t ds3231_write_regs(uint8_t reg, const uint8_t* data, size_t len);
+static esp_err_t device_set_tick(rtc_tick_t tick);
+static esp_err_t device_ack_interrupt(bool* tick, bool* alarm);
+static esp_err_t device_set_alarm(const rtc_time_t* at);
+static esp_err_t device_cancel_alarm(void);
+
+const rtc_device_t ds3231_rtc_device = {
+    .name = "ds3231",
+    .get_time = ds3231_get_time,
+    .set_time = ds3231_set_time,
+    .set_tick = device_set_tick,
+    .ack_interrupt = device_ack_interrupt,
+    .set_alarm = device_set_alarm,
+    .cancel_alarm = device_cancel_alarm,
+};
+
+// --- Public API Implementation ---
+
+esp_err_t ds3231_init(const ds3231_config_t* config) {
+    if (config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    i2c_bus_device_config_t dev_conf = {
+        .i2c_port = config->i2c_port,
+        .address = DS3231_I2C_ADDRESS,
+        .priority = I2C_BUS_PRIORITY_HIGH, // time reads must not queue behind display repaints
+        .name = "ds3231",
+    };
+    dev = i2c_bus_add_device(&dev_conf);
+    if (dev == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t err = ds3231_read_regs(DS3231_REG_CONTROL, &control, 1);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read control register: %s", esp_err_to_name(err));
+        return err;
+    }
+    // Keep time on battery
+    return update_control(DS3231_CONTROL_EOSC, 0);
+}
+
+esp_err_t ds3231_set_time(const rtc_time_t* time) {
+    uint8_t data[7];
+    rtc_device_encode_time(time, data);
+    esp_err_t err = ds3231_write_regs(DS3231_REG_SECONDS, data, sizeof(data));
+    if (err != ESP_OK) {
+        return err;
+    }
+    // The time is valid again
+    return clear_flags(DS3231_STATUS_OSF);
+}
+
+esp_err_t ds3231_get_time(rtc_time_t* time) {
+    uint8_t data[7];
+    esp_err_t err = ds3231_read_regs(DS3231_REG_SECONDS, data, sizeof(data));
+    if (err != ESP_OK) {
+        return err;
+    }
+    rtc_device_decode_time(data, time);
+    return ESP_OK;
+}
+
+esp_err_t ds3231_is_running(bool* is_running) {
+    uint8_t status;
+    esp_err_t err = ds3231_read_regs(DS3231_REG_STATUS, &status, 1);
+    if (err != ESP_OK) {
+        return err;
+    }
+    *is_running = !(status & DS3231_STATUS_OSF);
+    return ESP_OK;
+}
+
+esp_err_t ds3231_set_sqw(bool enable) {
+    if (enable) {
+        return update_control(DS3231_CONTROL_INTCN | DS3231_CONTROL_RS_MASK, 0);
+    }
+    return update_control(0, DS3231_CONTROL_INTCN);
+}
+
+esp_err_t ds3231_set_alarm(ds3231_alarm_num_t alarm, const ds3231_alarm_t* setting) {
+    if (setting == NULL || alarm > DS3231_ALARM_2 ||
+        (setting->mode == DS3231_ALARM_EVERY_SECOND && alarm != DS3231_ALARM_1) ||
+        (setting->mode == DS3231_ALARM_MATCH_SECONDS && alarm != DS3231_ALARM_1) ||
+        (setting->mode == DS3231_ALARM_EVERY_MINUTE && alarm != DS3231_ALARM_2)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Fields from the most to the least specific; a field is masked when the mode stops short of it
+    uint8_t day = rtc_device_dec_to_bcd(setting->day) |
+                  (setting->mode == DS3231_ALARM_MATCH_WEEKDAY ? DS3231_ALARM_DY : 0);
+    uint8_t regs[4] = {
+        rtc_device_dec_to_bcd(setting->seconds),
+        rtc_device_dec_to_bcd(setting->minutes),
+        rtc_device_dec_to_bcd(setting->hours),
+        day,
+    };
+    int compared; // fields compared, counting from seconds
+    switch (setting->mode) {
+    case DS3231_ALARM_EVERY_SECOND:
+    case DS3231_ALARM_EVERY_MINUTE:
+        compared = alarm == DS3231_ALARM_1 ? 0 : 1;
+        break;
+    case DS3231_ALARM_MATCH_SECONDS:
+        compared = 1;
+        break;
+    case DS3231_ALARM_MATCH_MINUTES:
+        compared = 2;
+        break;
+    case DS3231_ALARM_MATCH_TIME:
+        compared = 3;
+        break;
+    default:
+        compared = 4;
+        break;
+    }
+    for (int i = compared; i < 4; i++) {
+        regs[i] |= DS3231_ALARM_MASK;
+    }
+
+    esp_err_t err = alarm == DS3231_ALARM_1 ? ds3231_write_regs(DS3231_REG_ALARM_1, regs, 4)
+                                            : ds3231_write_regs(DS3231_REG_ALARM_2, &regs[1], 3);
+    if (err != ESP_OK) {
+        return err;
+    }
+    // A flag left over from the previous setting would fire at once
+    uint8_t flag = alarm == DS3231_ALARM_1 ? DS3231_STATUS_A1F : DS3231_STATUS_A2F;
+    err = clear_flags(flag);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return update_control(0, alarm == DS3231_ALARM_1 ? DS3231_CONTROL_A1IE : DS3231_CONTROL_A2IE);
+}
+
+esp_err_t ds3231_disable_alarm(ds3231_alarm_num_t alarm) {
+    if (alarm > DS3231_ALARM_2) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return update_control(alarm == DS3231_ALARM_1 ? DS3231_CONTROL_A1IE : DS3231_CONTROL_A2IE, 0);
+}
+
+esp_err_t ds3231_take_alarm_flags(uint8_t* fired) {
+    if (fired == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint8_t status;
+    esp_err_t err = ds3231_read_regs(DS3231_REG_STATUS, &status, 1);
+    if (err != ESP_OK) {
+        return err;
+    }
+    uint8_t flags = status & (DS3231_STATUS_A1F | DS3231_STATUS_A2F);
+    if (flags != 0) {
+        err = clear_flags(flags);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    taskENTER_CRITICAL(&control_lock);
+    uint8_t enabled = control & (DS3231_CONTROL_A1IE | DS3231_CONTROL_A2IE);
+    taskEXIT_CRITICAL(&control_lock);
+    // The flag and enable bits line up: A1 in bit 0, A2 in bit 1
+    *fired = flags & enabled;
+    return ESP_OK;
+}
+
+esp_err_t ds3231_get_aging_offset(int8_t* offset) {
+    if (offset == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ds3231_read_regs(DS3231_REG_AGING, (uint8_t*)offset, 1);
+}
+
+esp_err_t ds3231_set_aging_offset(int8_t offset) {
+    uint8_t value = (uint8_t)offset;
+    return ds3231_write_regs(DS3231_REG_AGING, &value, 1);
+}
+
+esp_err_t ds3231_get_temperature(int16_t* quarter_celsius) {
+    if (quarter_celsius == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint8_t data[2];
+    esp_err_t err = ds3231_read_regs(DS3231_REG_TEMP_MSB, data, sizeof(data));
+    if (err != ESP_OK) {
+        return err;
+    }
+    // Two's complement degrees, then the quarters in the top two bits of the LSB
+    *quarter_celsius = (int16_t)((int8_t)data[0] * 4 + (data[1] >> 6));
+    return ESP_OK;
+}
+
+// --- Private Functions ---
+
+static esp_err_t update_control(uint8_t clear, uint8_t set) {
+    taskENTER_CRITICAL(&control_lock);
+    control = (control & ~clear) | set;
+    uint8_t value = control;
+    taskEXIT_CRITICAL(&control_lock);
+    return ds3231_write_regs(DS3231_REG_CONTROL, &value, 1);
+}
+
+// Status flags can only be written to 0; writing 1 leaves a flag as it is,
+// so a flag that rises between the read and this write is not lost
+static esp_err_t clear_flags(uint8_t flags) {
+    uint8_t status;
+    esp_err_t err = ds3231_read_regs(DS3231_REG_STATUS, &status, 1);
+    if (err != ESP_OK) {
+        return err;
+    }
+    status = (status | DS3231_STATUS_OSF | DS3231_STATUS_A2F | DS3231_STATUS_A1F) & ~flags;
+    return ds3231_write_regs(DS3231_REG_STATUS, &status, 1);
+}
+
+static esp_err_t device_set_tick(rtc_tick_t tick) {
+    esp_err_t err;
+    switch (tick) {
+    case RTC_TICK_SECOND:
+        err = ds3231_disable_alarm(DS3231_ALARM_2);
+        return err == ESP_OK ? ds3231_set_sqw(true) : err;
+    case RTC_TICK_MINUTE: {
+        const ds3231_alarm_t every_minute = { .mode = DS3231_ALARM_EVERY_MINUTE };
+        err = ds3231_set_alarm(DS3231_ALARM_2, &every_minute);
+        return err == ESP_OK ? ds3231_set_sqw(false) : err;
+    }
+    case RTC_TICK_NONE:
+        err = ds3231_disable_alarm(DS3231_ALARM_2);
+        return err == ESP_OK ? ds3231_set_sqw(false) : err;
+    default:
+        return ESP_ERR_INVALID_ARG;
+    }
+}
+
+static esp_err_t device_ack_interrupt(bool* tick, bool* alarm) {
+    // A square wave releases the pin by itself
+    taskENTER_CRITICAL(&control_lock);
+    bool square_wave = !(control & DS3231_CONTROL_INTCN);
+    taskEXIT_CRITICAL(&control_lock);
+    if (square_wave) {
+        *tick = true;
+        *alarm = false;
+        return ESP_OK;
+    }
+    uint8_t fired;
+    esp_err_t err = ds3231_take_alarm_flags(&fired);
+    if (err != ESP_OK) {
+        return err;
+    }
+    *tick = fired & DS3231_ALARM_2_FIRED;
+    *alarm = fired & DS3231_ALARM_1_FIRED;
+    return ESP_OK;
+}
+
+static esp_err_t device_set_alarm(const rtc_time_t* at) {
+    const ds3231_alarm_t setting = {
+        .mode = DS3231_ALARM_MATCH_DATE,
+        .seconds = at->seconds,
+        .minutes = at->minutes,
+        .hours = at->hours,
+        .day = at->date,
+    };
+    return ds3231_set_alarm(DS3231_ALARM_1, &setting);
+}
+
+static esp_err_t device_cancel_alarm(void) {
+    return ds3231_disable_alarm(DS3231_ALARM_1);
+}
+
+// Burst read: register pointer write, repeated START, sequential read
+static esp_err_t ds3231_read_regs(uint8_t reg, uint8_t* data, size_t len) {
+    return i2c_bus_write_read(dev, &reg, 1, data, len);
+}
+
+// Burst write: register pointer followed by the data, auto-incrementing
+static esp_err_t ds3231_write_regs(uint8_t reg, const uint8_t* data, size_t len) {
+    return i2c_bus_write(dev, &reg, 1, data, len);
+}
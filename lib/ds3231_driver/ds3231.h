@@ -0,0 +1,115 @@
+#ifndef DS3231_H
+#define DS3231_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "driver/i2c.h"
+#include "i2c_bus.h"
+#include "rtc_device.h"
+
+#define DS3231_I2C_ADDRESS 0x68     // same as the DS1307: one of the two per bus
+
+/**
+ * @brief Flags returned by ds3231_take_alarm_flags().
+ */
+#define DS3231_ALARM_1_FIRED (1 << 0)
+#define DS3231_ALARM_2_FIRED (1 << 1)
+
+typedef enum {
+    DS3231_ALARM_1 = 0,             /*!< Seconds resolution. */
+    DS3231_ALARM_2 = 1,             /*!< Minute resolution; fires as the seconds wrap to 00. */
+} ds3231_alarm_num_t;
+
+/**
+ * @brief Which fields an alarm compares against the time.
+ */
+typedef enum {
+    DS3231_ALARM_EVERY_SECOND,      /*!< Alarm 1 only. */
+    DS3231_ALARM_EVERY_MINUTE,      /*!< Alarm 2 only. */
+    DS3231_ALARM_MATCH_SECONDS,     /*!< Alarm 1 only: once a minute. */
+    DS3231_ALARM_MATCH_MINUTES,     /*!< Minutes (and seconds): once an hour. */
+    DS3231_ALARM_MATCH_TIME,        /*!< Hours, minutes (and seconds): once a day. */
+    DS3231_ALARM_MATCH_DATE,        /*!< Day of the month and time: once a month. */
+    DS3231_ALARM_MATCH_WEEKDAY,     /*!< Day of the week and time: once a week. */
+} ds3231_alarm_mode_t;
+
+/**
+ * @brief An alarm setting. Fields the mode does not compare are ignored.
+ */
+typedef struct {
+    ds3231_alarm_mode_t mode;
+    uint8_t seconds;                /*!< Alarm 1 only. */
+    uint8_t minutes;
+    uint8_t hours;
+    uint8_t day;                    /*!< Day of the month, or of the week for DS3231_ALARM_MATCH_WEEKDAY. */
+} ds3231_alarm_t;
+
+typedef struct {
+    i2c_port_t i2c_port;            /*!< Must already be set up with i2c_bus_init(). */
+} ds3231_config_t;
+
+/**
+ * @brief Registers the RTC on the shared I2C bus and reads its control register.
+ */
+esp_err_t ds3231_init(const ds3231_config_t* config);
+
+esp_err_t ds3231_set_time(const rtc_time_t* time);
+esp_err_t ds3231_get_time(rtc_time_t* time);
+
+/**
+ * @brief Clear if the oscillator stopped (power lost with no battery) since the time was last set.
+ */
+esp_err_t ds3231_is_running(bool* is_running);
+
+/**
+ * @brief Chooses between the 1 Hz square wave and alarm interrupts on INT/SQW.
+ *
+ * With the square wave on (INTCN = 0) the alarms still set their flags but
+ * do not drive the pin. Off, the pin is held low while an enabled alarm's
+ * flag is set, until ds3231_take_alarm_flags() clears it.
+ */
+esp_err_t ds3231_set_sqw(bool enable);
+
+/**
+ * @brief Programs an alarm and enables its interrupt.
+ */
+esp_err_t ds3231_set_alarm(ds3231_alarm_num_t alarm, const ds3231_alarm_t* setting);
+
+/**
+ * @brief Disables an alarm's interrupt. Its flag still follows the registers.
+ */
+esp_err_t ds3231_disable_alarm(ds3231_alarm_num_t alarm);
+
+/**
+ * @brief Reads and clears the alarm flags, which releases INT/SQW.
+ *
+ * @param fired Receives DS3231_ALARM_*_FIRED bits. Flags of alarms whose
+ *              interrupt is disabled are left out but cleared as well.
+ */
+esp_err_t ds3231_take_alarm_flags(uint8_t* fired);
+
+/**
+ * @brief Aging offset trim of the temperature-compensated crystal.
+ *
+ * One step is about 0.1 ppm at 25 C; positive values slow the clock. The
+ * chip applies a new value at its next temperature conversion (within 64 s).
+ */
+esp_err_t ds3231_get_aging_offset(int8_t* offset);
+esp_err_t ds3231_set_aging_offset(int8_t offset);
+
+/**
+ * @brief Die temperature from the last compensation cycle, in quarter degrees Celsius.
+ */
+esp_err_t ds3231_get_temperature(int16_t* quarter_celsius);
+
+/**
+ * @brief rtc_device_t for rtc_clock.
+ *
+ * Second ticks use the 1 Hz square wave. Minute ticks use alarm 2 and the
+ * offloaded alarm uses alarm 1 (date, hours, minutes and seconds); both need
+ * the pin in interrupt mode, so while ticking every second the alarm only
+ * sets its flag and is reported when the ticks slow down or stop.
+ */
+extern const rtc_device_t ds3231_rtc_device;
+
+#endif // DS3231_H
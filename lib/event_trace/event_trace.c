@@ -0,0 +1,194 @@
+#include "event_trace.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static const char *TAG = "EVENT_TRACE";
+
+#define TRACE_TASK_STACK_SIZE 3072
+#define TRACE_MESSAGE_LEN 96
+
+/**
+ * @brief One fixed-size record, copied into the ring by the producer.
+ */
+typedef struct {
+    const event_trace_event_t* event;
+    uint32_t timestamp_us;          // low 32 bits of esp_timer time
+    int32_t args[2];
+} trace_record_t;
+
+/**
+ * @brief Single-consumer ring owned by one core.
+ *
+ * Producers on the owning core serialize by masking interrupts, so no lock is
+ * shared between cores. head and tail run freely and are masked on access.
+ */
+typedef struct {
+    trace_record_t* records;
+    uint32_t head;                  // written by the owning core only
+    uint32_t tail;                  // written by the drain task only
+    uint32_t dropped;
+} trace_ring_t;
+
+// --- Private Module State ---
+static trace_ring_t rings[portNUM_PROCESSORS];
+static uint32_t ring_mask = 0;
+static TickType_t drain_interval = 0;
+static TaskHandle_t drain_task_handle = NULL;
+static volatile bool running = false;
+
+// --- Forward Declarations ---
+static void drain_task(void* arg);
+static bool drain_one(void);
+static void print_record(const trace_record_t* record);
+
+// --- Public API Implementation ---
+
+esp_err_t event_trace_start(const event_trace_config_t* config) {
+    if (config == NULL || config->records_per_core == 0 || config->drain_interval_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (drain_task_handle != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint32_t size = 1;
+    while (size < config->records_per_core) {
+        size <<= 1;
+    }
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        rings[core].records = calloc(size, sizeof(trace_record_t));
+        if (rings[core].records == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate trace ring");
+            for (int i = 0; i < core; i++) {
+                free(rings[i].records);
+                rings[i].records = NULL;
+            }
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    ring_mask = size - 1;
+    drain_interval = pdMS_TO_TICKS(config->drain_interval_ms);
+    if (drain_interval == 0) {
+        drain_interval = 1;
+    }
+
+    if (xTaskCreate(drain_task, "trace_drain", TRACE_TASK_STACK_SIZE, NULL,
+                    config->task_priority, &drain_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create drain task");
+        for (int core = 0; core < portNUM_PROCESSORS; core++) {
+            free(rings[core].records);
+            rings[core].records = NULL;
+        }
+        return ESP_ERR_NO_MEM;
+    }
+
+    running = true;
+    ESP_LOGI(TAG, "Event trace started (%lu records per core)", (unsigned long)size);
+    return ESP_OK;
+}
+
+void IRAM_ATTR event_trace_write(const event_trace_event_t* event, int32_t arg0, int32_t arg1) {
+    // Records above the build's default log level would never be printed
+    if (!running || event == NULL || event->level > LOG_LOCAL_LEVEL) {
+        return;
+    }
+
+    // With interrupts masked nothing else can run on this core, so the task
+    // cannot migrate and no other producer can touch this ring.
+    UBaseType_t state = portSET_INTERRUPT_MASK_FROM_ISR();
+    trace_ring_t* ring = &rings[xPortGetCoreID()];
+    uint32_t head = ring->head;
+    uint32_t pending = head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    if (pending > ring_mask) {
+        ring->dropped++;
+    } else {
+        trace_record_t* record = &ring->records[head & ring_mask];
+        record->event = event;
+        record->timestamp_us = (uint32_t)esp_timer_get_time();
+        record->args[0] = arg0;
+        record->args[1] = arg1;
+        __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(state);
+
+    // Only the first record of a batch wakes the drain task, so an idle system stays asleep
+    if (pending == 0) {
+        if (xPortInIsrContext()) {
+            vTaskNotifyGiveFromISR(drain_task_handle, NULL);
+        } else {
+            xTaskNotifyGive(drain_task_handle);
+        }
+    }
+}
+
+uint32_t event_trace_dropped(void) {
+    uint32_t total = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        total += __atomic_load_n(&rings[core].dropped, __ATOMIC_RELAXED);
+    }
+    return total;
+}
+
+// --- Private Functions ---
+
+static void drain_task(void* arg) {
+    uint32_t reported_dropped = 0;
+
+    while (1) {
+        // Sleep until a record arrives, then give the burst time to collect
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        vTaskDelay(drain_interval);
+        while (drain_one()) {
+        }
+
+        uint32_t dropped = event_trace_dropped();
+        if (dropped != reported_dropped) {
+            ESP_LOGW(TAG, "%lu trace records dropped (%lu total)",
+                     (unsigned long)(dropped - reported_dropped), (unsigned long)dropped);
+            reported_dropped = dropped;
+        }
+    }
+}
+
+// Prints the oldest pending record across all cores; false once every ring is empty
+static bool drain_one(void) {
+    trace_ring_t* oldest = NULL;
+    const trace_record_t* oldest_record = NULL;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        trace_ring_t* ring = &rings[core];
+        if (ring->tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) {
+            continue;
+        }
+        const trace_record_t* record = &ring->records[ring->tail & ring_mask];
+        if (oldest == NULL || (int32_t)(record->timestamp_us - oldest_record->timestamp_us) < 0) {
+            oldest = ring;
+            oldest_record = record;
+        }
+    }
+    if (oldest == NULL) {
+        return false;
+    }
+
+    // Copy out first so the slot is free again while the UART is busy
+    trace_record_t record = *oldest_record;
+    __atomic_store_n(&oldest->tail, oldest->tail + 1, __ATOMIC_RELEASE);
+    print_record(&record);
+    return true;
+}
+
+static void print_record(const trace_record_t* record) {
+    static const char level_letters[] = { 'N', 'E', 'W', 'I', 'D', 'V' };
+    const event_trace_event_t* event = record->event;
+    char message[TRACE_MESSAGE_LEN];
+
+    // Records are far younger than the 71 minutes it takes the 32-bit stamp to wrap
+    int64_t now = esp_timer_get_time();
+    int64_t timestamp_us = now - (uint32_t)((uint32_t)now - record->timestamp_us);
+
+    snprintf(message, sizeof(message), event->format, (long)record->args[0], (long)record->args[1]);
+    esp_log_write(event->level, event->tag, "%c (%lu) %s: %s\n", level_letters[event->level],
+                  (unsigned long)(timestamp_us / 1000), event->tag, message);
+}
@@ -0,0 +1,58 @@
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+
+/**
+ * @brief Describes one kind of trace record. Define with EVENT_TRACE_DEFINE().
+ */
+typedef struct {
+    const char* tag;                /*!< Log tag the record is printed under. */
+    const char* format;             /*!< printf format taking up to two long arguments. */
+    esp_log_level_t level;          /*!< Log level the record is printed at. */
+} event_trace_event_t;
+
+/**
+ * @brief Defines a trace event. The strings are only used when the record is printed.
+ */
+#define EVENT_TRACE_DEFINE(name, tag_, level_, format_) \
+    static const event_trace_event_t name = { .tag = (tag_), .format = (format_), .level = (level_) }
+
+/**
+ * @brief Configuration for the trace buffer and its drain task.
+ */
+typedef struct {
+    uint32_t records_per_core;      /*!< Ring capacity per core, rounded up to a power of two. */
+    uint32_t drain_interval_ms;     /*!< Delay between the first pending record and printing the batch. */
+    UBaseType_t task_priority;      /*!< Priority of the drain task; keep it low. */
+} event_trace_config_t;
+
+/**
+ * @brief Allocates one ring per core and starts the drain task.
+ *
+ * @param config Pointer to the trace configuration.
+ * @return ESP_OK on success, or an error code on failure.
+ */
+esp_err_t event_trace_start(const event_trace_config_t* config);
+
+/**
+ * @brief Records an event with two integer arguments. Never blocks.
+ *
+ * Stores a 16-byte record (event, timestamp, arguments) in the calling core's
+ * ring; formatting and UART output happen later on the drain task. Safe from
+ * tasks and ISRs on either core, but not inside a critical section: the first
+ * record of a batch notifies the drain task. When the ring is full the record
+ * is dropped and counted. Does nothing before event_trace_start() or when the
+ * event's level is above the default log level.
+ */
+void event_trace_write(const event_trace_event_t* event, int32_t arg0, int32_t arg1);
+
+/**
+ * @brief Number of records dropped because a ring was full.
+ */
+uint32_t event_trace_dropped(void);
+
+#endif // EVENT_TRACE_H
@@ -0,0 +1,183 @@
+#include "glyph_cache.h"
+#include "display_server.h"
+#include "freertos/FreeRTOS.h"
+#include <stdbool.h>
+#include <string.h>
+
+// CGRAM slot n also answers to character code n + 8, which is never NUL
+#define SLOT_CODE_BASE 8
+#define NO_SLOT 0xFF
+
+// Character ROM codes for the two bitmaps every HD44780 already has
+#define ROM_CODE_BLANK ' '
+#define ROM_CODE_FULL ((char)0xFF)
+
+typedef struct {
+    uint8_t bitmap[8];
+    char rom_code;                  // non-zero if the character ROM has this bitmap
+    uint8_t slot;                   // NO_SLOT unless resident
+} glyph_t;
+
+typedef struct {
+    glyph_id_t glyph;
+    bool resident;
+    bool stale;                     // the upload could not be queued; retried on the next acquire
+    uint16_t refs;
+    uint32_t last_used;
+} slot_t;
+
+// --- Private Module State ---
+static portMUX_TYPE cache_lock = portMUX_INITIALIZER_UNLOCKED;
+static glyph_t glyphs[GLYPH_CACHE_MAX_GLYPHS];
+static uint8_t num_glyphs = 0;
+static slot_t slots[GLYPH_CACHE_SLOTS];
+static uint32_t use_counter = 0;
+static glyph_cache_stats_t stats;
+
+// --- Forward Declarations ---
+static int find_victim(void);
+
+// --- Public API Implementation ---
+
+esp_err_t glyph_cache_register(const uint8_t bitmap[8], glyph_id_t* id) {
+    if (bitmap == NULL || id == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint8_t rows[8];
+    bool blank = true, full = true;
+    for (int i = 0; i < 8; i++) {
+        rows[i] = bitmap[i] & 0x1F;
+        blank = blank && rows[i] == 0;
+        full = full && rows[i] == 0x1F;
+    }
+
+    esp_err_t err = ESP_OK;
+    taskENTER_CRITICAL(&cache_lock);
+    glyph_id_t found = num_glyphs;
+    for (glyph_id_t i = 0; i < num_glyphs; i++) {
+        if (memcmp(glyphs[i].bitmap, rows, sizeof(rows)) == 0) {
+            found = i;
+            break;
+        }
+    }
+    if (found == num_glyphs) {
+        if (num_glyphs == GLYPH_CACHE_MAX_GLYPHS) {
+            err = ESP_ERR_NO_MEM;
+        } else {
+            glyph_t* glyph = &glyphs[num_glyphs++];
+            memcpy(glyph->bitmap, rows, sizeof(rows));
+            glyph->rom_code = blank ? ROM_CODE_BLANK : full ? ROM_CODE_FULL : 0;
+            glyph->slot = NO_SLOT;
+        }
+    }
+    taskEXIT_CRITICAL(&cache_lock);
+
+    if (err == ESP_OK) {
+        *id = found;
+    }
+    return err;
+}
+
+esp_err_t glyph_cache_acquire(glyph_id_t id, char* code) {
+    if (code == NULL || id >= num_glyphs) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t bitmap[8];
+    bool upload = false;
+    int index;
+    taskENTER_CRITICAL(&cache_lock);
+    glyph_t* glyph = &glyphs[id];
+    if (glyph->rom_code) {
+        stats.hits++;
+        taskEXIT_CRITICAL(&cache_lock);
+        *code = glyph->rom_code;
+        return ESP_OK;
+    }
+
+    if (glyph->slot != NO_SLOT) {
+        index = glyph->slot;
+        upload = slots[index].stale;
+        if (upload) {
+            stats.loads++;
+        } else {
+            stats.hits++;
+        }
+    } else {
+        index = find_victim();
+        if (index < 0) {
+            stats.misses++;
+            taskEXIT_CRITICAL(&cache_lock);
+            return ESP_ERR_NOT_FOUND;
+        }
+        if (slots[index].resident) {
+            glyphs[slots[index].glyph].slot = NO_SLOT;
+            stats.evictions++;
+        }
+        slots[index].glyph = id;
+        slots[index].resident = true;
+        glyph->slot = (uint8_t)index;
+        stats.loads++;
+        upload = true;
+    }
+    slot_t* slot = &slots[index];
+    slot->stale = false;
+    slot->refs++;
+    slot->last_used = ++use_counter;
+    if (upload) {
+        memcpy(bitmap, glyph->bitmap, sizeof(bitmap));
+    }
+    taskEXIT_CRITICAL(&cache_lock);
+
+    // Queued outside the lock; the slot is referenced, so nobody can take it meanwhile
+    if (upload) {
+        esp_err_t err = display_server_set_glyph((uint8_t)index, bitmap);
+        if (err != ESP_OK) {
+            taskENTER_CRITICAL(&cache_lock);
+            slot->stale = true;
+            slot->refs--;
+            taskEXIT_CRITICAL(&cache_lock);
+            return err;
+        }
+    }
+    *code = (char)(SLOT_CODE_BASE + index);
+    return ESP_OK;
+}
+
+void glyph_cache_release(glyph_id_t id) {
+    if (id >= num_glyphs) {
+        return;
+    }
+    taskENTER_CRITICAL(&cache_lock);
+    uint8_t index = glyphs[id].slot;
+    if (index != NO_SLOT && slots[index].refs > 0) {
+        slots[index].refs--;
+    }
+    taskEXIT_CRITICAL(&cache_lock);
+}
+
+esp_err_t glyph_cache_get_stats(glyph_cache_stats_t* out) {
+    if (out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    taskENTER_CRITICAL(&cache_lock);
+    *out = stats;
+    taskEXIT_CRITICAL(&cache_lock);
+    return ESP_OK;
+}
+
+// --- Private Functions ---
+
+// An empty slot if there is one, else the least recently used one without references; -1 if all are in use
+static int find_victim(void) {
+    int victim = -1;
+    for (int i = 0; i < GLYPH_CACHE_SLOTS; i++) {
+        if (!slots[i].resident) {
+            return i;
+        }
+        if (slots[i].refs == 0 && (victim < 0 || slots[i].last_used < slots[victim].last_used)) {
+            victim = i;
+        }
+    }
+    return victim;
+}
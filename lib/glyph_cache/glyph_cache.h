@@ -0,0 +1,65 @@
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#define GLYPH_CACHE_MAX_GLYPHS 32
+#define GLYPH_CACHE_SLOTS 8
+
+/**
+ * @brief Handle of a registered glyph.
+ */
+typedef uint8_t glyph_id_t;
+
+/**
+ * @brief Counters for how often CGRAM had to be reprogrammed.
+ */
+typedef struct {
+    uint32_t hits;                  /*!< Acquires served by a resident glyph or a ROM character. */
+    uint32_t loads;                 /*!< Acquires that programmed a slot. */
+    uint32_t evictions;             /*!< Loads that replaced an unused glyph. */
+    uint32_t misses;                /*!< Acquires that failed because every slot was in use. */
+} glyph_cache_stats_t;
+
+/**
+ * @brief Adds a 5x8 bitmap to the logical glyph set.
+ *
+ * Identical bitmaps share one id. The blank and the full 5x8 block map to the
+ * ROM characters ' ' and 0xFF and never take a CGRAM slot.
+ *
+ * @param bitmap 8 rows, the low 5 bits of each used.
+ * @param id Receives the glyph's id.
+ * @return ESP_OK, or ESP_ERR_NO_MEM once GLYPH_CACHE_MAX_GLYPHS distinct bitmaps are registered.
+ */
+esp_err_t glyph_cache_register(const uint8_t bitmap[8], glyph_id_t* id);
+
+/**
+ * @brief Makes a glyph resident in one of the 8 CGRAM slots and takes a reference to it.
+ *
+ * A glyph that is still resident is reused as is. Otherwise the least recently
+ * used slot without references is reprogrammed through the display server.
+ * A slot whose glyph is referenced is never replaced, since every cell showing
+ * it would change with it. Codes are 8-15, the aliases of CGRAM 0-7, so that
+ * they can be part of a C string.
+ *
+ * @param id Glyph from glyph_cache_register().
+ * @param code Receives the character code that shows the glyph.
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if every slot is referenced, or the
+ *         display server's error if the upload could not be queued.
+ */
+esp_err_t glyph_cache_acquire(glyph_id_t id, char* code);
+
+/**
+ * @brief Drops a reference taken by glyph_cache_acquire().
+ *
+ * The glyph stays resident until its slot is needed for another one.
+ */
+void glyph_cache_release(glyph_id_t id);
+
+/**
+ * @brief Copies the cache counters.
+ */
+esp_err_t glyph_cache_get_stats(glyph_cache_stats_t* stats);
+
+#endif // GLYPH_CACHE_H
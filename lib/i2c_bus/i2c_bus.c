@@ -0,0 +1,312 @@
+#include "i2c_bus.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+static const char *TAG = "I2C_BUS";
+
+#define I2C_BUS_TIMEOUT_MS 1000
+
+// Enough for start + address + prefix + data + repeated start + address + read + stop
+#define I2C_BUS_CMD_LINK_SIZE I2C_LINK_RECOMMENDED_SIZE(2)
+
+/**
+ * @brief A task blocked waiting for the bus. Lives on the waiting task's stack.
+ */
+typedef struct bus_waiter_t {
+    uint8_t priority;
+    SemaphoreHandle_t granted;
+    StaticSemaphore_t granted_buf;
+    struct bus_waiter_t* next;
+} bus_waiter_t;
+
+/**
+ * @brief Internal structure for a device instance.
+ */
+struct i2c_bus_device_t {
+    i2c_bus_device_config_t config;
+    i2c_bus_stats_t stats;
+    struct i2c_bus_device_t* next;
+};
+
+/**
+ * @brief State of one I2C port.
+ */
+typedef struct {
+    bool installed;
+    bool busy;
+    portMUX_TYPE lock;
+    bus_waiter_t* waiters;          // sorted by priority, FIFO within a priority
+    i2c_bus_device_handle_t devices;
+    uint8_t cmd_buf[I2C_BUS_CMD_LINK_SIZE]; // only touched by the current bus owner
+} i2c_bus_t;
+
+// --- Private Module State ---
+static i2c_bus_t buses[I2C_NUM_MAX] = {
+    [0 ... I2C_NUM_MAX - 1] = { .lock = portMUX_INITIALIZER_UNLOCKED },
+};
+
+// --- Forward Declarations ---
+static uint32_t bus_acquire(i2c_bus_t* bus, i2c_bus_device_handle_t dev);
+static void bus_release(i2c_bus_t* bus);
+static esp_err_t run_transfer(i2c_bus_device_handle_t dev, i2c_cmd_handle_t cmd, uint32_t* transfer_us);
+static void record_result(i2c_bus_t* bus, i2c_bus_device_handle_t dev, esp_err_t err, size_t bytes,
+                          uint32_t waited_us, uint32_t transfer_us);
+
+// --- Public API Implementation ---
+
+esp_err_t i2c_bus_init(const i2c_bus_config_t* config) {
+    if (config == NULL || config->i2c_port >= I2C_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    i2c_bus_t* bus = &buses[config->i2c_port];
+    if (bus->installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    i2c_config_t conf = {
+        .mode = I2C_MODE_MASTER,
+        .sda_io_num = config->sda_pin,
+        .scl_io_num = config->scl_pin,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .master.clk_speed = config->clk_speed,
+    };
+    esp_err_t err = i2c_param_config(config->i2c_port, &conf);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = i2c_driver_install(config->i2c_port, conf.mode, 0, 0, 0);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    bus->installed = true;
+    ESP_LOGI(TAG, "I2C%d ready (SDA:%d, SCL:%d, %lu Hz)", config->i2c_port, config->sda_pin,
+             config->scl_pin, (unsigned long)config->clk_speed);
+    return ESP_OK;
+}
+
+i2c_bus_device_handle_t i2c_bus_add_device(const i2c_bus_device_config_t* config) {
+    if (config == NULL || config->i2c_port >= I2C_NUM_MAX || !buses[config->i2c_port].installed) {
+        return NULL;
+    }
+
+    i2c_bus_device_handle_t dev = calloc(1, sizeof(struct i2c_bus_device_t));
+    if (dev == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate memory for device");
+        return NULL;
+    }
+    dev->config = *config;
+
+    i2c_bus_t* bus = &buses[config->i2c_port];
+    taskENTER_CRITICAL(&bus->lock);
+    dev->next = bus->devices;
+    bus->devices = dev;
+    taskEXIT_CRITICAL(&bus->lock);
+
+    ESP_LOGI(TAG, "Device '%s' at 0x%02x added (priority %d)", config->name ? config->name : "?",
+             config->address, config->priority);
+    return dev;
+}
+
+esp_err_t i2c_bus_write(i2c_bus_device_handle_t dev, const uint8_t* prefix, size_t prefix_len,
+                        const uint8_t* data, size_t len) {
+    if (dev == NULL || (prefix_len && prefix == NULL) || (len && data == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    i2c_bus_t* bus = &buses[dev->config.i2c_port];
+
+    uint32_t waited_us = bus_acquire(bus, dev);
+
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(bus->cmd_buf, sizeof(bus->cmd_buf));
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (dev->config.address << 1) | I2C_MASTER_WRITE, true);
+    if (prefix_len) {
+        i2c_master_write(cmd, prefix, prefix_len, true);
+    }
+    if (len) {
+        i2c_master_write(cmd, data, len, true);
+    }
+    i2c_master_stop(cmd);
+    uint32_t transfer_us;
+    esp_err_t err = run_transfer(dev, cmd, &transfer_us);
+    i2c_cmd_link_delete_static(cmd);
+
+    record_result(bus, dev, err, prefix_len + len, waited_us, transfer_us);
+    bus_release(bus);
+    return err;
+}
+
+esp_err_t i2c_bus_read(i2c_bus_device_handle_t dev, uint8_t* data, size_t len) {
+    if (dev == NULL || data == NULL || len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    i2c_bus_t* bus = &buses[dev->config.i2c_port];
+
+    uint32_t waited_us = bus_acquire(bus, dev);
+
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(bus->cmd_buf, sizeof(bus->cmd_buf));
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (dev->config.address << 1) | I2C_MASTER_READ, true);
+    i2c_master_read(cmd, data, len, I2C_MASTER_LAST_NACK);
+    i2c_master_stop(cmd);
+    uint32_t transfer_us;
+    esp_err_t err = run_transfer(dev, cmd, &transfer_us);
+    i2c_cmd_link_delete_static(cmd);
+
+    record_result(bus, dev, err, len, waited_us, transfer_us);
+    bus_release(bus);
+    return err;
+}
+
+esp_err_t i2c_bus_write_read(i2c_bus_device_handle_t dev, const uint8_t* wdata, size_t wlen,
+                             uint8_t* rdata, size_t rlen) {
+    if (dev == NULL || wdata == NULL || wlen == 0 || rdata == NULL || rlen == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    i2c_bus_t* bus = &buses[dev->config.i2c_port];
+
+    uint32_t waited_us = bus_acquire(bus, dev);
+
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(bus->cmd_buf, sizeof(bus->cmd_buf));
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (dev->config.address << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_write(cmd, wdata, wlen, true);
+    i2c_master_start(cmd); // repeated START, no STOP in between
+    i2c_master_write_byte(cmd, (dev->config.address << 1) | I2C_MASTER_READ, true);
+    i2c_master_read(cmd, rdata, rlen, I2C_MASTER_LAST_NACK);
+    i2c_master_stop(cmd);
+    uint32_t transfer_us;
+    esp_err_t err = run_transfer(dev, cmd, &transfer_us);
+    i2c_cmd_link_delete_static(cmd);
+
+    record_result(bus, dev, err, wlen + rlen, waited_us, transfer_us);
+    bus_release(bus);
+    return err;
+}
+
+esp_err_t i2c_bus_get_stats(i2c_bus_device_handle_t dev, i2c_bus_stats_t* stats) {
+    if (dev == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    i2c_bus_t* bus = &buses[dev->config.i2c_port];
+    taskENTER_CRITICAL(&bus->lock);
+    *stats = dev->stats;
+    taskEXIT_CRITICAL(&bus->lock);
+    return ESP_OK;
+}
+
+size_t i2c_bus_get_devices(i2c_port_t port, i2c_bus_device_handle_t* devices, size_t max_devices) {
+    if (port >= I2C_NUM_MAX || (devices == NULL && max_devices > 0)) {
+        return 0;
+    }
+    i2c_bus_t* bus = &buses[port];
+    size_t count = 0;
+    taskENTER_CRITICAL(&bus->lock);
+    for (i2c_bus_device_handle_t dev = bus->devices; dev != NULL; dev = dev->next) {
+        if (count < max_devices) {
+            devices[count] = dev;
+        }
+        count++;
+    }
+    taskEXIT_CRITICAL(&bus->lock);
+    return count;
+}
+
+const char* i2c_bus_device_name(i2c_bus_device_handle_t dev) {
+    return (dev && dev->config.name) ? dev->config.name : "?";
+}
+
+// --- Private Functions ---
+
+/**
+ * @brief Takes the bus for one transaction.
+ *
+ * If the bus is idle the caller takes it immediately. Otherwise the caller
+ * queues itself by priority and sleeps until the current owner hands the bus
+ * over directly in bus_release(), so a high-priority device only ever waits
+ * for the transaction already on the wire.
+ *
+ * @return Time spent waiting, in microseconds.
+ */
+static uint32_t bus_acquire(i2c_bus_t* bus, i2c_bus_device_handle_t dev) {
+    int64_t start = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&bus->lock);
+    if (!bus->busy) {
+        bus->busy = true;
+        taskEXIT_CRITICAL(&bus->lock);
+    } else {
+        taskEXIT_CRITICAL(&bus->lock);
+
+        bus_waiter_t waiter = { .priority = dev->config.priority };
+        waiter.granted = xSemaphoreCreateBinaryStatic(&waiter.granted_buf);
+
+        taskENTER_CRITICAL(&bus->lock);
+        if (!bus->busy) {
+            // Released while we were setting up
+            bus->busy = true;
+            taskEXIT_CRITICAL(&bus->lock);
+        } else {
+            bus_waiter_t** pos = &bus->waiters;
+            while (*pos != NULL && (*pos)->priority >= waiter.priority) {
+                pos = &(*pos)->next;
+            }
+            waiter.next = *pos;
+            *pos = &waiter;
+            taskEXIT_CRITICAL(&bus->lock);
+
+            xSemaphoreTake(waiter.granted, portMAX_DELAY);
+        }
+        vSemaphoreDelete(waiter.granted);
+    }
+
+    return (uint32_t)(esp_timer_get_time() - start);
+}
+
+static void bus_release(i2c_bus_t* bus) {
+    taskENTER_CRITICAL(&bus->lock);
+    bus_waiter_t* next = bus->waiters;
+    if (next != NULL) {
+        bus->waiters = next->next; // ownership passes straight to the waiter
+    } else {
+        bus->busy = false;
+    }
+    taskEXIT_CRITICAL(&bus->lock);
+
+    if (next != NULL) {
+        xSemaphoreGive(next->granted);
+    }
+}
+
+static esp_err_t run_transfer(i2c_bus_device_handle_t dev, i2c_cmd_handle_t cmd, uint32_t* transfer_us) {
+    int64_t start = esp_timer_get_time();
+    esp_err_t err = i2c_master_cmd_begin(dev->config.i2c_port, cmd, pdMS_TO_TICKS(I2C_BUS_TIMEOUT_MS));
+    *transfer_us = (uint32_t)(esp_timer_get_time() - start);
+    return err;
+}
+
+static void record_result(i2c_bus_t* bus, i2c_bus_device_handle_t dev, esp_err_t err, size_t bytes,
+                          uint32_t waited_us, uint32_t transfer_us) {
+    taskENTER_CRITICAL(&bus->lock);
+    dev->stats.transactions++;
+    dev->stats.wait_time_us += waited_us;
+    if (waited_us > dev->stats.max_wait_us) {
+        dev->stats.max_wait_us = waited_us;
+    }
+    dev->stats.transfer_time_us += transfer_us;
+    if (transfer_us > dev->stats.max_transfer_us) {
+        dev->stats.max_transfer_us = transfer_us;
+    }
+    if (err == ESP_OK) {
+        dev->stats.bytes += bytes;
+    } else if (err == ESP_FAIL) {
+        dev->stats.nacks++;
+    } else if (err == ESP_ERR_TIMEOUT) {
+        dev->stats.timeouts++;
+    }
+    taskEXIT_CRITICAL(&bus->lock);
+}
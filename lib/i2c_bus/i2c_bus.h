@@ -0,0 +1,114 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/i2c.h"
+
+/**
+ * @brief Transaction priorities. Higher values are served first when several devices wait for the bus.
+ */
+#define I2C_BUS_PRIORITY_LOW 0
+#define I2C_BUS_PRIORITY_NORMAL 1
+#define I2C_BUS_PRIORITY_HIGH 2
+
+/**
+ * @brief Opaque handle for a device attached to a bus.
+ */
+typedef struct i2c_bus_device_t* i2c_bus_device_handle_t;
+
+/**
+ * @brief Configuration for an I2C bus. The bus manager installs and owns the port.
+ */
+typedef struct {
+    i2c_port_t i2c_port;
+    int sda_pin;
+    int scl_pin;
+    uint32_t clk_speed;             /*!< SCL frequency in Hz. */
+} i2c_bus_config_t;
+
+/**
+ * @brief Configuration for a device on an initialized bus.
+ */
+typedef struct {
+    i2c_port_t i2c_port;
+    uint8_t address;                /*!< 7-bit device address. */
+    uint8_t priority;               /*!< One of the I2C_BUS_PRIORITY_* values. */
+    const char* name;               /*!< Short name used in logs and diagnostics. */
+} i2c_bus_device_config_t;
+
+/**
+ * @brief Per-device transaction counters.
+ */
+typedef struct {
+    uint32_t transactions;          /*!< Completed transactions, including failed ones. */
+    uint32_t bytes;                 /*!< Payload bytes written and read (address bytes excluded). */
+    uint32_t nacks;                 /*!< Transactions the device did not acknowledge. */
+    uint32_t timeouts;              /*!< Transactions that timed out on the bus. */
+    uint64_t wait_time_us;          /*!< Total time spent waiting for the bus. */
+    uint32_t max_wait_us;           /*!< Longest single wait for the bus. */
+    uint64_t transfer_time_us;      /*!< Total time spent in transfers once the bus was granted. */
+    uint32_t max_transfer_us;       /*!< Longest single transfer. */
+} i2c_bus_stats_t;
+
+/**
+ * @brief Installs the I2C driver for a port and takes ownership of it.
+ *
+ * @param config Pointer to the bus configuration.
+ * @return ESP_OK on success, or an error code on failure.
+ */
+esp_err_t i2c_bus_init(const i2c_bus_config_t* config);
+
+/**
+ * @brief Attaches a device to an initialized bus.
+ *
+ * @param config Pointer to the device configuration.
+ * @return A handle to the device, or NULL on failure.
+ */
+i2c_bus_device_handle_t i2c_bus_add_device(const i2c_bus_device_config_t* config);
+
+/**
+ * @brief Writes prefix followed by data in a single transaction.
+ *
+ * The prefix is typically a register address; either part may be empty.
+ * Blocks until the bus is granted to this device and the transfer completes.
+ *
+ * @return ESP_OK on success, ESP_FAIL if the device did not acknowledge,
+ *         ESP_ERR_TIMEOUT if the bus timed out, or another error code.
+ */
+esp_err_t i2c_bus_write(i2c_bus_device_handle_t dev, const uint8_t* prefix, size_t prefix_len,
+                        const uint8_t* data, size_t len);
+
+/**
+ * @brief Reads len bytes from the device in a single transaction.
+ */
+esp_err_t i2c_bus_read(i2c_bus_device_handle_t dev, uint8_t* data, size_t len);
+
+/**
+ * @brief Writes wdata, then reads rlen bytes after a repeated START, as one transaction.
+ *
+ * This is the usual register read: wdata holds the register address.
+ */
+esp_err_t i2c_bus_write_read(i2c_bus_device_handle_t dev, const uint8_t* wdata, size_t wlen,
+                             uint8_t* rdata, size_t rlen);
+
+/**
+ * @brief Copies the device's transaction counters.
+ */
+esp_err_t i2c_bus_get_stats(i2c_bus_device_handle_t dev, i2c_bus_stats_t* stats);
+
+/**
+ * @brief Lists the devices attached to a port, most recently added first.
+ *
+ * @param devices Array that receives up to max_devices handles.
+ * @return The number of devices on the port, which may exceed max_devices.
+ */
+size_t i2c_bus_get_devices(i2c_port_t port, i2c_bus_device_handle_t* devices, size_t max_devices);
+
+/**
+ * @brief Returns the name the device was registered with.
+ */
+const char* i2c_bus_device_name(i2c_bus_device_handle_t dev);
+
+#endif // I2C_BUS_H
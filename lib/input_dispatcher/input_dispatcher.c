@@ -0,0 +1,103 @@
+#include "input_dispatcher.h"
+#include "esp_log.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+static const char *TAG = "INPUT_DISPATCHER";
+
+#define DISPATCHER_TASK_STACK_SIZE 3072
+
+// --- Private Module State ---
+static QueueHandle_t event_queue = NULL;
+static TaskHandle_t dispatcher_task_handle = NULL;
+static volatile uint32_t dropped_events = 0;
+static int64_t delivering_since_us = 0; // written only by the dispatcher task
+
+// --- Forward Declarations ---
+static void dispatcher_task(void* arg);
+
+// --- Public API Implementation ---
+
+esp_err_t input_dispatcher_start(const input_dispatcher_config_t* config) {
+    if (config == NULL || config->queue_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (dispatcher_task_handle != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    event_queue = xQueueCreate(config->queue_size, sizeof(input_event_t));
+    if (event_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create event queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(dispatcher_task, "input_dispatch", DISPATCHER_TASK_STACK_SIZE, NULL,
+                    config->task_priority, &dispatcher_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create dispatcher task");
+        vQueueDelete(event_queue);
+        event_queue = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Input dispatcher started (queue size %lu)", (unsigned long)config->queue_size);
+    return ESP_OK;
+}
+
+bool input_dispatcher_running(void) {
+    return dispatcher_task_handle != NULL;
+}
+
+bool input_dispatcher_in_task(void) {
+    return dispatcher_task_handle != NULL && xTaskGetCurrentTaskHandle() == dispatcher_task_handle;
+}
+
+esp_err_t input_dispatcher_post(const input_event_t* event, TickType_t ticks_to_wait) {
+    if (event == NULL || event->deliver == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (event_queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (input_dispatcher_in_task()) {
+        ticks_to_wait = 0;
+    }
+    if (xQueueSend(event_queue, event, ticks_to_wait) != pdTRUE) {
+        dropped_events++;
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+esp_err_t IRAM_ATTR input_dispatcher_post_from_isr(const input_event_t* event, BaseType_t* higher_priority_task_woken) {
+    if (event_queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (xQueueSendFromISR(event_queue, event, higher_priority_task_woken) != pdTRUE) {
+        dropped_events++;
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+int64_t input_dispatcher_event_time(void) {
+    return input_dispatcher_in_task() ? delivering_since_us : 0;
+}
+
+uint32_t input_dispatcher_dropped(void) {
+    return dropped_events;
+}
+
+// --- Private Functions ---
+
+static void dispatcher_task(void* arg) {
+    input_event_t event;
+
+    while (1) {
+        if (xQueueReceive(event_queue, &event, portMAX_DELAY) == pdTRUE) {
+            delivering_since_us = event.timestamp_us;
+            event.deliver(&event);
+            delivering_since_us = 0;
+        }
+    }
+}
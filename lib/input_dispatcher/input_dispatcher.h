@@ -0,0 +1,96 @@
+#ifndef INPUT_DISPATCHER_H
+#define INPUT_DISPATCHER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+typedef struct input_event_t input_event_t;
+
+/**
+ * @brief Delivers one event on the dispatcher task.
+ *
+ * Set by the driver that posted the event; typically looks up the driver
+ * object in event->source and calls the application's callback.
+ *
+ * @param event The event being delivered.
+ */
+typedef void (*input_deliver_fn_t)(const input_event_t* event);
+
+/**
+ * @brief A compact input event, copied into the dispatcher queue.
+ */
+struct input_event_t {
+    int64_t timestamp_us;           /*!< esp_timer time the driver detected the input. */
+    input_deliver_fn_t deliver;     /*!< Driver function that handles the event. */
+    void* source;                   /*!< Driver object, e.g. a button or encoder handle. */
+    int32_t value;                  /*!< Driver-defined payload, e.g. a click count. */
+    uint16_t type;                  /*!< Driver-defined event type. */
+};
+
+/**
+ * @brief Configuration for the input dispatcher.
+ */
+typedef struct {
+    uint32_t queue_size;            /*!< Number of events that can be pending. */
+    UBaseType_t task_priority;      /*!< Priority of the dispatcher task. */
+} input_dispatcher_config_t;
+
+/**
+ * @brief Starts the dispatcher task.
+ *
+ * All input drivers post into this one queue and all input callbacks run on
+ * this one task, in the order the events were posted. Must be called before
+ * any button or encoder is created.
+ *
+ * @param config Pointer to the dispatcher configuration.
+ * @return ESP_OK on success, or an error code on failure.
+ */
+esp_err_t input_dispatcher_start(const input_dispatcher_config_t* config);
+
+/**
+ * @brief Whether input_dispatcher_start() has succeeded.
+ */
+bool input_dispatcher_running(void);
+
+/**
+ * @brief Whether the caller is running on the dispatcher task.
+ */
+bool input_dispatcher_in_task(void);
+
+/**
+ * @brief Queues an event for delivery.
+ *
+ * When called from the dispatcher task itself the call never blocks, since
+ * nobody else would drain the queue.
+ *
+ * @param event The event to copy into the queue.
+ * @param ticks_to_wait How long to wait for space.
+ * @return ESP_OK, ESP_ERR_TIMEOUT if the queue stayed full, or ESP_ERR_INVALID_STATE if not started.
+ */
+esp_err_t input_dispatcher_post(const input_event_t* event, TickType_t ticks_to_wait);
+
+/**
+ * @brief ISR-safe variant of input_dispatcher_post(). Never blocks.
+ *
+ * @param event The event to copy into the queue.
+ * @param higher_priority_task_woken Set to pdTRUE if a context switch should be requested.
+ * @return ESP_OK, ESP_ERR_TIMEOUT if the queue was full, or ESP_ERR_INVALID_STATE if not started.
+ */
+esp_err_t input_dispatcher_post_from_isr(const input_event_t* event, BaseType_t* higher_priority_task_woken);
+
+/**
+ * @brief Detection time (timestamp_us) of the event being delivered.
+ *
+ * Only meaningful from an input callback on the dispatcher task; returns 0
+ * anywhere else.
+ */
+int64_t input_dispatcher_event_time(void);
+
+/**
+ * @brief Number of events that could not be queued because the queue was full.
+ */
+uint32_t input_dispatcher_dropped(void);
+
+#endif // INPUT_DISPATCHER_H
@@ -1,15 +1,21 @@
 #include "lcd_i2c.h"
 #include "driver/i2c.h"
+#include "i2c_bus.h"
 #include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include <string.h>
 
 // Commands
 #define LCD_CMD_CLEAR_DISPLAY 0x01
 #define LCD_CMD_RETURN_HOME 0x02
 #define LCD_CMD_ENTRY_MODE_SET 0x04
 #define LCD_CMD_DISPLAY_CONTROL 0x08
+#define LCD_CMD_CURSOR_SHIFT 0x10
 #define LCD_CMD_FUNCTION_SET 0x20
+#define LCD_CMD_SET_CGRAM_ADDR 0x40
 #define LCD_CMD_SET_DDRAM_ADDR 0x80
 
 // Flags for entry mode
@@ -26,6 +32,11 @@
 #define LCD_FLAG_BLINK_ON 0x01
 #define LCD_FLAG_BLINK_OFF 0x00
 
+// Flags for cursor/display shift
+#define LCD_FLAG_DISPLAY_MOVE 0x08
+#define LCD_FLAG_MOVE_RIGHT 0x04
+#define LCD_FLAG_MOVE_LEFT 0x00
+
 // Flags for function set
 #define LCD_FLAG_8BIT_MODE 0x10
 #define LCD_FLAG_4BIT_MODE 0x00
@@ -40,97 +51,511 @@
 #define LCD_BIT_E (1 << 2)  // Enable
 #define LCD_BACKLIGHT (1 << 3)
 
+// Clear/home take 1.52 ms at the nominal 270 kHz oscillator; every other
+// instruction finishes in ~37 us, which is shorter than the 4 I2C bytes it
+// takes to send one (>= 90 us at 400 kHz), so only these two need a wait.
+// Without the busy flag the wait is the datasheet time scaled to the slowest
+// oscillator (190 kHz).
+#define LCD_CLEAR_DELAY_US (1520 * 270 / 190)
+
+// Busy flag polling. A backpack without RW wired reads back BF set forever.
+#define LCD_STATUS_BUSY 0x80
+#define LCD_BUSY_TIMEOUT_US 5000
+
+// lcd_wait_ready() results other than an address counter
+#define LCD_WAIT_NO_BUSY_FLAG -1    // busy flag not used; the fixed delay was waited
+#define LCD_WAIT_READ_FAILED -2     // status read NACKed; the fixed delay was waited
+#define LCD_WAIT_STUCK -3           // still busy after LCD_BUSY_TIMEOUT_US
+
+// With the busy flag readable, the address counter is compared with the
+// driver's copy at most this often; a mismatch means the panel lost track
+#define LCD_VERIFY_INTERVAL_US 10000000
+
+// Every controller byte costs 4 PCF8574 writes (E high/low per nibble).
+// Streams are packed into transactions of up to this many bytes; this also
+// bounds how long a higher-priority device waits behind a repaint.
+#define LCD_TX_BUF_SIZE 128
+
+// DDRAM geometry: two lines of 40 bytes at 0x00 and 0x40
+#define LCD_DDRAM_LINE_LEN 40
+#define LCD_DDRAM_SIZE (2 * LCD_DDRAM_LINE_LEN)
+#define LCD_MAX_ROWS 4
+
+// After a failed write the shadow holds this in every cell, so each cell
+// differs from what the view wants and is sent again. Codes 0x08-0x0F only
+// repeat the CGRAM glyphs at 0x00-0x07, so nothing draws this one.
+#define LCD_DDRAM_UNKNOWN '\x08'
+#define LCD_ADDR_UNKNOWN 0xFF      // never equal to a cell's address, so the next run sets it
+
 static const char *TAG = "LCD_I2C";
 
+static const uint8_t row_offsets[] = {0x00, 0x40, 0x14, 0x54};
+
 // Driver state
-static i2c_port_t g_i2c_port;
-static uint8_t g_i2c_address;
+static i2c_bus_device_handle_t g_dev;
 static uint8_t g_cols;
 static uint8_t g_rows;
+static uint8_t g_addr; // DDRAM address counter as tracked by the driver
+static uint8_t g_shift; // display shift: each row shows its DDRAM line from this many cells further on
+static bool g_read_busy; // BF/AC can be read back through the PCF8574
+static int64_t g_next_verify_us;
+static bool g_resync_pending; // a write failed: set the controller up again before the next frame
+
+// Framebuffer: g_view is what the application wants on screen, by row and
+// column. g_ddram is what has actually been written to the controller and
+// g_fb what the next flush will make of it, both indexed by DDRAM address
+// (see ddram_index()).
+static char g_view[LCD_MAX_ROWS][LCD_DDRAM_LINE_LEN];
+static char g_fb[LCD_DDRAM_SIZE];
+static char g_ddram[LCD_DDRAM_SIZE];
+
+// Pending PCF8574 output bytes, sent as one I2C write by lcd_tx_flush()
+static uint8_t g_tx_buf[LCD_TX_BUF_SIZE];
+static size_t g_tx_len;
+static esp_err_t g_tx_err; // first failed write since lcd_tx_flush() last reported
 
 // Static functions
-static esp_err_t lcd_send_nibble(uint8_t nibble, uint8_t flags);
-static esp_err_t lcd_send_byte(uint8_t byte, uint8_t flags);
-static esp_err_t lcd_write_i2c(uint8_t data);
+static void lcd_send_nibble(uint8_t nibble, uint8_t flags);
+static void lcd_send_byte(uint8_t byte, uint8_t flags);
+static esp_err_t lcd_write_i2c(const uint8_t *data, size_t len);
+static void lcd_tx_send(void);
+static esp_err_t lcd_tx_flush(void);
+static void lcd_set_addr(uint8_t addr);
+static void lcd_write_data(char c);
+static size_t lcd_setup_controller(void);
+static void lcd_clear_ddram(void);
+static void lcd_forget_ddram(void);
+static esp_err_t lcd_read_status(uint8_t *status);
+static int lcd_wait_ready(uint32_t fallback_us);
+static void view_put_ddram(uint8_t index, char c);
+static void plan_frame(uint8_t shift, char *target);
+static size_t plan_bytes(const char *target);
+
+// Returns LCD_DDRAM_SIZE for addresses that do not exist (0x28-0x3F, 0x68-0x7F)
+static inline uint8_t ddram_index(uint8_t addr) {
+    if ((addr & 0x3F) >= LCD_DDRAM_LINE_LEN) {
+        return LCD_DDRAM_SIZE;
+    }
+    return (addr & 0x40 ? LCD_DDRAM_LINE_LEN : 0) + (addr & 0x3F);
+}
+
+static inline uint8_t ddram_addr(uint8_t index) {
+    return index < LCD_DDRAM_LINE_LEN ? index : 0x40 + (index - LCD_DDRAM_LINE_LEN);
+}
+
+// The DDRAM cell shown at row/col when the display is shifted by 'shift'.
+// Rows wrap around within their 40-byte line.
+static inline uint8_t visible_index(uint8_t row, uint8_t col, uint8_t shift) {
+    uint8_t base = row_offsets[row];
+    return (base & 0x40 ? LCD_DDRAM_LINE_LEN : 0) + ((base & 0x3F) + col + shift) % LCD_DDRAM_LINE_LEN;
+}
 
 esp_err_t lcd_i2c_init(const lcd_i2c_config_t *config) {
-    g_i2c_port = config->i2c_port;
-    g_i2c_address = config->i2c_address;
+    i2c_bus_device_config_t dev_conf = {
+        .i2c_port = config->i2c_port,
+        .address = config->i2c_address,
+        .priority = I2C_BUS_PRIORITY_LOW,
+        .name = "lcd",
+    };
+    g_dev = i2c_bus_add_device(&dev_conf);
+    if (g_dev == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
     g_cols = config->cols;
     g_rows = config->rows;
+    if (g_rows > sizeof(row_offsets)) {
+        g_rows = sizeof(row_offsets);
+    }
+    if (g_cols > LCD_DDRAM_LINE_LEN) {
+        g_cols = LCD_DDRAM_LINE_LEN;
+    }
 
     vTaskDelay(pdMS_TO_TICKS(100)); // Wait for >40ms after power-on
 
-    // Put LCD into 4-bit mode
+    // The first clear tells whether the busy flag is readable
+    g_read_busy = config->read_busy_flag;
+    lcd_setup_controller();
+    memset(g_view, ' ', sizeof(g_view));
+    esp_err_t err = lcd_tx_flush();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "LCD not responding: %s", esp_err_to_name(err));
+        return err;
+    }
+    g_next_verify_us = esp_timer_get_time() + LCD_VERIFY_INTERVAL_US;
+
+    ESP_LOGI(TAG, "LCD initialized successfully (%s)", g_read_busy ? "busy flag" : "fixed delays");
+    return ESP_OK;
+}
+
+void lcd_i2c_clear(void) {
+    lcd_clear_ddram();
+    memset(g_view, ' ', sizeof(g_view));
+}
+
+void lcd_i2c_set_cursor(uint8_t row, uint8_t col) {
+    if (row >= g_rows) {
+        row = g_rows - 1;
+    }
+    lcd_set_addr(ddram_addr(visible_index(row, col % LCD_DDRAM_LINE_LEN, g_shift)));
+    lcd_tx_flush();
+}
+
+void lcd_i2c_send_string(const char *str) {
+    while (*str) {
+        view_put_ddram(ddram_index(g_addr), *str);
+        lcd_write_data(*str);
+        str++;
+    }
+    lcd_tx_flush();
+}
+
+void lcd_i2c_create_char(uint8_t slot, const uint8_t bitmap[8]) {
+    lcd_send_byte(LCD_CMD_SET_CGRAM_ADDR | ((slot & 0x07) << 3), 0);
+    for (int i = 0; i < 8; i++) {
+        lcd_send_byte(bitmap[i] & 0x1F, LCD_BIT_RS);
+    }
+    // The address counter now points into CGRAM; move it back to DDRAM. With
+    // the position unknown the next flush sets the controller up anyway.
+    if (g_addr != LCD_ADDR_UNKNOWN) {
+        lcd_set_addr(g_addr);
+    }
+    lcd_tx_flush();
+}
+
+// --- Framebuffer ---
+
+uint8_t lcd_i2c_get_cols(void) {
+    return g_cols;
+}
+
+void lcd_i2c_fb_clear(void) {
+    memset(g_view, ' ', sizeof(g_view));
+}
+
+void lcd_i2c_fb_put_char(uint8_t row, uint8_t col, char c) {
+    if (row >= g_rows || col >= g_cols) {
+        return;
+    }
+    g_view[row][col] = c;
+}
+
+void lcd_i2c_fb_write(uint8_t row, uint8_t col, const char *str) {
+    while (*str && col < g_cols) {
+        lcd_i2c_fb_put_char(row, col++, *str++);
+    }
+}
+
+void lcd_i2c_fb_write_line(uint8_t row, const char *str) {
+    uint8_t col = 0;
+    while (*str && col < g_cols) {
+        lcd_i2c_fb_put_char(row, col++, *str++);
+    }
+    while (col < g_cols) {
+        lcd_i2c_fb_put_char(row, col++, ' ');
+    }
+}
+
+esp_err_t lcd_i2c_fb_flush(size_t *bytes_sent) {
+    // Plan the frame at the current shift and one cell either way. When every
+    // row moved by a cell, the shifted plan only needs the cells scrolling in
+    // plus one shift instruction; otherwise the unshifted plan is cheaper.
+    static const int8_t moves[] = {0, 1, -1};
+    static char candidate[LCD_DDRAM_SIZE];
+    int8_t move = 0;
+    size_t best = SIZE_MAX;
+    size_t sent = 0;
+
+    // A failed frame may have stopped anywhere: between the two nibbles of a
+    // byte, or before or after the shift instruction. The setup sequence
+    // works from any nibble phase and clears the panel and the shift.
+    if (g_resync_pending) {
+        sent += lcd_setup_controller();
+    }
+
+    for (size_t m = 0; m < sizeof(moves); m++) {
+        uint8_t shift = (g_shift + LCD_DDRAM_LINE_LEN + moves[m]) % LCD_DDRAM_LINE_LEN;
+        plan_frame(shift, candidate);
+        size_t cost = plan_bytes(candidate) + (moves[m] != 0);
+        if (cost < best) {
+            best = cost;
+            move = moves[m];
+            memcpy(g_fb, candidate, sizeof(g_fb));
+        }
+    }
+
+    uint8_t i = 0;
+
+    while (i < LCD_DDRAM_SIZE) {
+        if (g_fb[i] == g_ddram[i]) {
+            i++;
+            continue;
+        }
+
+        // Start of a run of changed cells: one cursor move, then stream the
+        // data bytes while the controller auto-increments the address.
+        if (g_addr != ddram_addr(i)) {
+            lcd_set_addr(ddram_addr(i));
+            sent++;
+        }
+        while (i < LCD_DDRAM_SIZE && g_fb[i] != g_ddram[i]) {
+            lcd_write_data(g_fb[i]);
+            sent++;
+            i++;
+        }
+    }
+
+    // Shift last, so the cells scrolling in already hold their characters
+    if (move != 0) {
+        lcd_send_byte(LCD_CMD_CURSOR_SHIFT | LCD_FLAG_DISPLAY_MOVE |
+                      (move > 0 ? LCD_FLAG_MOVE_LEFT : LCD_FLAG_MOVE_RIGHT), 0);
+        g_shift = (g_shift + LCD_DDRAM_LINE_LEN + move) % LCD_DDRAM_LINE_LEN;
+        sent++;
+    }
+
+    esp_err_t err = lcd_tx_flush();
+    if (err != ESP_OK) {
+        // The shadow already claims the whole frame; resend it next time
+        lcd_forget_ddram();
+    }
+
+    // Every so often check that the controller's cursor is where ours is. If
+    // not, a nibble was lost or the panel browned out: set it up again and
+    // send the whole view. CGRAM may be gone too; the caller is told so.
+    if (err == ESP_OK && g_read_busy && esp_timer_get_time() >= g_next_verify_us) {
+        g_next_verify_us = esp_timer_get_time() + LCD_VERIFY_INTERVAL_US;
+        int ac = lcd_wait_ready(0);
+        if (ac == LCD_WAIT_READ_FAILED) {
+            // Says nothing about the controller; the frame itself went out
+            ESP_LOGW(TAG, "Could not read the address counter; checking again next flush");
+            g_next_verify_us = 0;
+        } else if (ac != g_addr) {
+            if (ac == LCD_WAIT_STUCK) {
+                ESP_LOGW(TAG, "Busy flag stuck; re-initializing");
+            } else {
+                ESP_LOGW(TAG, "Address counter 0x%02x, expected 0x%02x; re-initializing", ac, g_addr);
+            }
+            sent += lcd_setup_controller();
+            size_t resent = 0;
+            err = lcd_i2c_fb_flush(&resent);
+            sent += resent;
+            if (err == ESP_OK) {
+                err = ESP_ERR_INVALID_RESPONSE;
+            }
+        }
+    }
+
+    if (bytes_sent) {
+        *bytes_sent = sent;
+    }
+    return err;
+}
+
+// --- Private Functions ---
+
+// 4-bit sync, configuration and clear. Works from any nibble phase, so it also
+// recovers a controller that got out of step. Leaves the view alone. Returns
+// the instructions sent; each 8-bit mode sync write counts as one.
+static size_t lcd_setup_controller(void) {
     lcd_send_nibble(0x03, 0);
+    lcd_tx_send();
     vTaskDelay(pdMS_TO_TICKS(10));
     lcd_send_nibble(0x03, 0);
+    lcd_tx_send();
     vTaskDelay(pdMS_TO_TICKS(5));
     lcd_send_nibble(0x03, 0);
+    lcd_tx_send();
     vTaskDelay(pdMS_TO_TICKS(5));
     lcd_send_nibble(0x02, 0); // Set 4-bit interface
 
-    // Configure LCD
     lcd_send_byte(LCD_CMD_FUNCTION_SET | LCD_FLAG_4BIT_MODE | LCD_FLAG_2LINE | LCD_FLAG_5x8DOTS, 0);
     lcd_send_byte(LCD_CMD_DISPLAY_CONTROL | LCD_FLAG_DISPLAY_ON | LCD_FLAG_CURSOR_OFF | LCD_FLAG_BLINK_OFF, 0);
-    lcd_i2c_clear();
+    lcd_clear_ddram();
     lcd_send_byte(LCD_CMD_ENTRY_MODE_SET | LCD_FLAG_ENTRY_LEFT | LCD_FLAG_ENTRY_SHIFT_DECREMENT, 0);
-
-    ESP_LOGI(TAG, "LCD initialized successfully");
-    return ESP_OK;
+    return 8; // four sync writes, function set, display control, clear, entry mode
 }
 
-void lcd_i2c_clear(void) {
+static void lcd_clear_ddram(void) {
     lcd_send_byte(LCD_CMD_CLEAR_DISPLAY, 0);
-    vTaskDelay(pdMS_TO_TICKS(5)); // this command takes a long time
+    lcd_tx_send();
+    if (lcd_wait_ready(LCD_CLEAR_DELAY_US) == LCD_WAIT_STUCK) {
+        // Timed out, so the clear has finished anyway
+        ESP_LOGW(TAG, "Busy flag does not clear; RW not wired? Using fixed delays");
+        g_read_busy = false;
+    }
+    g_addr = 0;
+    g_shift = 0; // clear also undoes any display shift
+    g_resync_pending = false;
+    memset(g_ddram, ' ', sizeof(g_ddram));
 }
 
-void lcd_i2c_set_cursor(uint8_t row, uint8_t col) {
-    uint8_t row_offsets[] = {0x00, 0x40, 0x14, 0x54};
-    if (row >= g_rows) {
-        row = g_rows - 1;
+// Until the next flush sets the controller up again, nothing is known to be on the panel
+static void lcd_forget_ddram(void) {
+    memset(g_ddram, LCD_DDRAM_UNKNOWN, sizeof(g_ddram));
+    g_addr = LCD_ADDR_UNKNOWN;
+    g_resync_pending = true;
+}
+
+// Reads BF and the address counter: D7-D4 written high so the controller can
+// drive them, RW high, then one E pulse per nibble with the port read while E is high
+static esp_err_t lcd_read_status(uint8_t *status) {
+    uint8_t idle = 0xF0 | LCD_BIT_RW | LCD_BACKLIGHT;
+    uint8_t strobe = idle | LCD_BIT_E;
+    uint8_t high, low;
+
+    lcd_tx_send();
+    esp_err_t err = i2c_bus_write_read(g_dev, &strobe, 1, &high, 1);
+    if (err == ESP_OK) {
+        const uint8_t next[] = { idle, strobe };
+        err = i2c_bus_write_read(g_dev, next, sizeof(next), &low, 1);
+    }
+    if (err == ESP_OK) {
+        err = lcd_write_i2c(&idle, 1);
     }
-    lcd_send_byte(LCD_CMD_SET_DDRAM_ADDR | (col + row_offsets[row]), 0);
+    if (err == ESP_OK) {
+        *status = (high & 0xF0) | (low >> 4);
+    }
+    return err;
 }
 
-void lcd_i2c_send_string(const char *str) {
-    while (*str) {
-        lcd_send_byte((uint8_t)(*str), LCD_BIT_RS);
-        str++;
+// Returns the address counter once the controller is ready, or one of the
+// LCD_WAIT_* results. Without a status to go by, waits fallback_us instead.
+static int lcd_wait_ready(uint32_t fallback_us) {
+    if (!g_read_busy) {
+        esp_rom_delay_us(fallback_us);
+        return LCD_WAIT_NO_BUSY_FLAG;
+    }
+    int64_t deadline = esp_timer_get_time() + LCD_BUSY_TIMEOUT_US;
+    uint8_t status;
+    do {
+        if (lcd_read_status(&status) != ESP_OK) {
+            esp_rom_delay_us(fallback_us);
+            return LCD_WAIT_READ_FAILED;
+        }
+        if (!(status & LCD_STATUS_BUSY)) {
+            return status & 0x7F;
+        }
+    } while (esp_timer_get_time() < deadline);
+    return LCD_WAIT_STUCK;
+}
+
+// Direct writes also go into the view, wherever the cell shows at the current
+// shift, so that they and framebuffer flushes never disagree about the panel
+static void view_put_ddram(uint8_t index, char c) {
+    if (index >= LCD_DDRAM_SIZE) {
+        return;
+    }
+    for (uint8_t row = 0; row < g_rows; row++) {
+        uint8_t base = ddram_index(row_offsets[row]);
+        if ((base < LCD_DDRAM_LINE_LEN) != (index < LCD_DDRAM_LINE_LEN)) {
+            continue;
+        }
+        uint8_t col = (index - base + 2 * LCD_DDRAM_LINE_LEN - g_shift) % LCD_DDRAM_LINE_LEN;
+        if (col < g_cols) {
+            g_view[row][col] = c;
+        }
+    }
+}
+
+// What DDRAM must hold for the view to show at the given shift. Cells no row
+// shows keep their current content.
+static void plan_frame(uint8_t shift, char *target) {
+    memcpy(target, g_ddram, LCD_DDRAM_SIZE);
+    for (uint8_t row = 0; row < g_rows; row++) {
+        for (uint8_t col = 0; col < g_cols; col++) {
+            target[visible_index(row, col, shift)] = g_view[row][col];
+        }
+    }
+}
+
+// Controller bytes lcd_i2c_fb_flush() needs to write target: one cursor move per run plus the data
+static size_t plan_bytes(const char *target) {
+    size_t bytes = 0;
+    uint8_t addr = g_addr;
+    uint8_t i = 0;
+    while (i < LCD_DDRAM_SIZE) {
+        if (target[i] == g_ddram[i]) {
+            i++;
+            continue;
+        }
+        if (addr != ddram_addr(i)) {
+            bytes++;
+        }
+        while (i < LCD_DDRAM_SIZE && target[i] != g_ddram[i]) {
+            bytes++;
+            i++;
+        }
+        addr = ddram_addr(i);
     }
+    return bytes;
 }
 
-static esp_err_t lcd_write_i2c(uint8_t data) {
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (g_i2c_address << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(cmd, data, true);
-    i2c_master_stop(cmd);
-    esp_err_t err = i2c_master_cmd_begin(g_i2c_port, cmd, pdMS_TO_TICKS(1000));
-    i2c_cmd_link_delete(cmd);
+static void lcd_set_addr(uint8_t addr) {
+    lcd_send_byte(LCD_CMD_SET_DDRAM_ADDR | addr, 0);
+    g_addr = addr;
+}
+
+static void lcd_write_data(char c) {
+    lcd_send_byte((uint8_t)c, LCD_BIT_RS);
+
+    // Keep the shadow in step with the controller
+    uint8_t index = ddram_index(g_addr);
+    if (index < LCD_DDRAM_SIZE) {
+        g_ddram[index] = c;
+        g_fb[index] = c;
+    }
+
+    // In 2-line mode the address counter wraps 0x27 -> 0x40 -> 0x67 -> 0x00
+    if (g_addr == LCD_DDRAM_LINE_LEN - 1) {
+        g_addr = 0x40;
+    } else if (g_addr == 0x40 + LCD_DDRAM_LINE_LEN - 1) {
+        g_addr = 0x00;
+    } else {
+        g_addr++;
+    }
+}
+
+static esp_err_t lcd_write_i2c(const uint8_t *data, size_t len) {
+    return i2c_bus_write(g_dev, NULL, 0, data, len);
+}
+
+// Sends the pending bytes; a failure is kept for the next lcd_tx_flush()
+static void lcd_tx_send(void) {
+    if (g_tx_len == 0) {
+        return;
+    }
+    esp_err_t err = lcd_write_i2c(g_tx_buf, g_tx_len);
+    g_tx_len = 0;
+    if (g_tx_err == ESP_OK) {
+        g_tx_err = err;
+    }
+}
+
+// Sends the pending bytes and reports the first failure since the last flush,
+// so a chunk lost in the middle of a frame is not hidden by the ones after it
+static esp_err_t lcd_tx_flush(void) {
+    lcd_tx_send();
+    esp_err_t err = g_tx_err;
+    g_tx_err = ESP_OK;
     return err;
 }
 
-static esp_err_t lcd_send_nibble(uint8_t nibble, uint8_t flags) {
+static void lcd_send_nibble(uint8_t nibble, uint8_t flags) {
     uint8_t data = (nibble << 4) | flags | LCD_BACKLIGHT;
 
-    // Set data lines and pull E high
-    lcd_write_i2c(data | LCD_BIT_E);
-    vTaskDelay(pdMS_TO_TICKS(1)); // Enable pulse width
-
-    // Pull E low
-    lcd_write_i2c(data & ~LCD_BIT_E);
-    vTaskDelay(pdMS_TO_TICKS(1)); // Hold time
+    if (g_tx_len + 2 > LCD_TX_BUF_SIZE) {
+        lcd_tx_send();
+    }
 
-    return ESP_OK;
+    // E high then E low: each PCF8574 write takes 9 SCL cycles, which already
+    // exceeds the enable pulse width and hold time, so no delay is needed.
+    g_tx_buf[g_tx_len++] = data | LCD_BIT_E;
+    g_tx_buf[g_tx_len++] = data & ~LCD_BIT_E;
 }
 
-static esp_err_t lcd_send_byte(uint8_t byte, uint8_t flags) {
+static void lcd_send_byte(uint8_t byte, uint8_t flags) {
     uint8_t high_nibble = byte >> 4;
     uint8_t low_nibble = byte & 0x0F;
 
     lcd_send_nibble(high_nibble, flags);
     lcd_send_nibble(low_nibble, flags);
-
-    return ESP_OK;
 }
@@ -1,16 +1,19 @@
 #ifndef LCD_I2C_H
 #define LCD_I2C_H
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "driver/i2c.h"
 
 #define LCD_I2C_DEFAULT_ADDRESS 0x27
 
 typedef struct {
-    i2c_port_t i2c_port;
+    i2c_port_t i2c_port; // must already be set up with i2c_bus_init()
     uint8_t i2c_address;
     uint8_t cols;
     uint8_t rows;
+    bool read_busy_flag; // RW is wired through the backpack: poll the busy flag and check the cursor
 } lcd_i2c_config_t;
 
 esp_err_t lcd_i2c_init(const lcd_i2c_config_t *config);
@@ -18,4 +21,30 @@ void lcd_i2c_clear(void);
 void lcd_i2c_set_cursor(uint8_t row, uint8_t col);
 void lcd_i2c_send_string(const char *str);
 
+// Programs one of the 8 CGRAM slots; the glyph is shown as character code 'slot'.
+// Use codes 0-7 for them: the driver reserves the 0x08-0x0F aliases.
+void lcd_i2c_create_char(uint8_t slot, const uint8_t bitmap[8]);
+
+uint8_t lcd_i2c_get_cols(void);
+
+// Framebuffer API: draw into an in-RAM copy of the screen, then call
+// lcd_i2c_fb_flush() to send only the cells that differ from the panel.
+void lcd_i2c_fb_clear(void);
+void lcd_i2c_fb_put_char(uint8_t row, uint8_t col, char c);
+void lcd_i2c_fb_write(uint8_t row, uint8_t col, const char *str);
+void lcd_i2c_fb_write_line(uint8_t row, const char *str); // pads the rest of the row with spaces
+
+// Sends every changed cell, coalescing adjacent cells into a single cursor
+// move plus a data run. When the whole screen moved one cell sideways, e.g.
+// a marquee over otherwise blank rows, the display-shift instruction moves it
+// instead and only the cells scrolling in are written to the DDRAM past the
+// visible columns. If bytes_sent is not NULL it receives the number of bytes
+// (setup, cursor and shift commands + characters) written to the controller.
+// With read_busy_flag, a flush now and then reads the address counter back;
+// if the panel lost track it is set up again, the view is sent in full and
+// ESP_ERR_INVALID_RESPONSE tells the caller to reload CGRAM. After a failed
+// write the driver no longer trusts what the panel shows, so the next flush
+// sets the controller up again and sends the whole view.
+esp_err_t lcd_i2c_fb_flush(size_t *bytes_sent);
+
 #endif // LCD_I2C_H
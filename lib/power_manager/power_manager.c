@@ -0,0 +1,173 @@
+#include "power_manager.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG = "POWER_MANAGER";
+
+// --- Private Module State ---
+static power_manager_wake_pin_t wake_pins[POWER_MANAGER_MAX_WAKE_PINS];
+static uint8_t num_wake_pins = 0;
+static int64_t start_time_us = 0;
+
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t asleep_us = 0;
+static uint32_t sleeps = 0;
+
+static esp_pm_lock_handle_t awake_lock = NULL;
+static esp_timer_handle_t awake_timer = NULL;
+static portMUX_TYPE awake_lock_mux = portMUX_INITIALIZER_UNLOCKED;
+static bool awake_held = false;
+static int64_t awake_until_us = 0;
+
+// --- Forward Declarations ---
+static esp_err_t on_sleep_enter(int64_t sleep_time_us, void* arg);
+static esp_err_t on_sleep_exit(int64_t sleep_time_us, void* arg);
+static void awake_timer_callback(void* arg);
+
+// --- Public API Implementation ---
+
+esp_err_t power_manager_start(const power_manager_config_t* config) {
+    if (config == NULL || config->num_wake_pins > POWER_MANAGER_MAX_WAKE_PINS ||
+        (config->num_wake_pins > 0 && config->wake_pins == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (awake_lock != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t err = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "pm_awake", &awake_lock);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create PM lock: %s", esp_err_to_name(err));
+        return err;
+    }
+    const esp_timer_create_args_t timer_args = {
+        .callback = awake_timer_callback,
+        .name = "pm_awake",
+    };
+    err = esp_timer_create(&timer_args, &awake_timer);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create awake timer: %s", esp_err_to_name(err));
+        esp_pm_lock_delete(awake_lock);
+        awake_lock = NULL;
+        return err;
+    }
+
+    for (uint8_t i = 0; i < config->num_wake_pins; i++) {
+        wake_pins[i] = config->wake_pins[i];
+    }
+    num_wake_pins = config->num_wake_pins;
+    if (num_wake_pins > 0) {
+        esp_sleep_enable_gpio_wakeup();
+    }
+
+    if (config->light_sleep) {
+        esp_pm_sleep_cbs_register_config_t cbs = {
+            .enter_cb = on_sleep_enter,
+            .exit_cb = on_sleep_exit,
+        };
+        err = esp_pm_light_sleep_register_cbs(&cbs);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to register sleep callbacks: %s", esp_err_to_name(err));
+            return err;
+        }
+    }
+
+    start_time_us = esp_timer_get_time();
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = config->max_freq_mhz,
+        .min_freq_mhz = config->min_freq_mhz,
+        .light_sleep_enable = config->light_sleep,
+    };
+    err = esp_pm_configure(&pm_config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure power management: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    ESP_LOGI(TAG, "Power management on: %d-%d MHz, light sleep %s, %u wake pins", config->min_freq_mhz,
+             config->max_freq_mhz, config->light_sleep ? "on" : "off", num_wake_pins);
+    return ESP_OK;
+}
+
+esp_err_t power_manager_keep_awake(uint32_t ms) {
+    if (awake_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    int64_t until = esp_timer_get_time() + (int64_t)ms * 1000;
+    bool start_timer = false;
+
+    // esp_pm locks are ISR-safe, so they may be taken inside the critical section
+    taskENTER_CRITICAL(&awake_lock_mux);
+    if (until > awake_until_us) {
+        awake_until_us = until;
+    }
+    if (!awake_held) {
+        esp_pm_lock_acquire(awake_lock);
+        awake_held = true;
+        start_timer = true;
+    }
+    taskEXIT_CRITICAL(&awake_lock_mux);
+
+    // While the lock is held the timer is already running and re-checks the deadline
+    if (start_timer) {
+        return esp_timer_start_once(awake_timer, (uint64_t)ms * 1000);
+    }
+    return ESP_OK;
+}
+
+esp_err_t power_manager_get_stats(power_manager_stats_t* stats) {
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&stats_lock);
+    stats->asleep_us = asleep_us;
+    stats->sleeps = sleeps;
+    taskEXIT_CRITICAL(&stats_lock);
+    stats->uptime_us = start_time_us ? now - start_time_us : 0;
+    return ESP_OK;
+}
+
+// --- Private Functions ---
+
+// Called on the idle task, inside a critical section, just before light sleep
+static esp_err_t on_sleep_enter(int64_t sleep_time_us, void* arg) {
+    for (uint8_t i = 0; i < num_wake_pins; i++) {
+        int level = gpio_get_level(wake_pins[i].pin);
+        gpio_wakeup_enable(wake_pins[i].pin, level ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    }
+    return ESP_OK;
+}
+
+// Called right after wakeup, before interrupts are enabled again. A pin whose
+// change woke the chip still has its interrupt status set, so its driver's
+// handler runs as soon as the edge type is back.
+static esp_err_t on_sleep_exit(int64_t sleep_time_us, void* arg) {
+    for (uint8_t i = 0; i < num_wake_pins; i++) {
+        gpio_wakeup_disable(wake_pins[i].pin);
+        gpio_set_intr_type(wake_pins[i].pin, wake_pins[i].intr_type);
+    }
+    taskENTER_CRITICAL_ISR(&stats_lock);
+    asleep_us += sleep_time_us;
+    sleeps++;
+    taskEXIT_CRITICAL_ISR(&stats_lock);
+    return ESP_OK;
+}
+
+static void awake_timer_callback(void* arg) {
+    int64_t remaining;
+    taskENTER_CRITICAL(&awake_lock_mux);
+    remaining = awake_until_us - esp_timer_get_time();
+    if (remaining <= 0) {
+        esp_pm_lock_release(awake_lock);
+        awake_held = false;
+    }
+    taskEXIT_CRITICAL(&awake_lock_mux);
+
+    if (remaining > 0) {
+        esp_timer_start_once(awake_timer, (uint64_t)remaining);
+    }
+}
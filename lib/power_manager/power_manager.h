@@ -0,0 +1,67 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+
+#define POWER_MANAGER_MAX_WAKE_PINS 8
+
+/**
+ * @brief A GPIO that wakes the chip from light sleep when its level changes.
+ */
+typedef struct {
+    gpio_num_t pin;
+    gpio_int_type_t intr_type;      /*!< Interrupt type the pin's driver uses; restored after every sleep. */
+} power_manager_wake_pin_t;
+
+/**
+ * @brief Configuration for dynamic frequency scaling and automatic light sleep.
+ */
+typedef struct {
+    int max_freq_mhz;               /*!< CPU frequency while any task needs it. */
+    int min_freq_mhz;               /*!< CPU frequency when idle but awake. */
+    bool light_sleep;               /*!< Enter light sleep when every task is blocked. */
+    const power_manager_wake_pin_t* wake_pins; /*!< Inputs that must wake the chip. */
+    uint8_t num_wake_pins;          /*!< Entries in wake_pins, up to POWER_MANAGER_MAX_WAKE_PINS. */
+} power_manager_config_t;
+
+/**
+ * @brief Time spent in light sleep since power_manager_start().
+ */
+typedef struct {
+    int64_t uptime_us;              /*!< Time since power_manager_start(). */
+    int64_t asleep_us;              /*!< Part of uptime_us spent in light sleep. */
+    uint32_t sleeps;                /*!< Number of light sleep periods. */
+} power_manager_stats_t;
+
+/**
+ * @brief Configures esp_pm and arms the wake pins.
+ *
+ * With tickless idle the chip sleeps whenever no task is ready until the next
+ * FreeRTOS or esp_timer deadline. GPIO wakeup on the ESP32 is level-triggered
+ * and shares the interrupt type field with the pin's edge interrupt, so before
+ * each sleep every wake pin is armed for the level opposite to its current
+ * one, and its own interrupt type is put back on wakeup. Needs CONFIG_PM_ENABLE,
+ * CONFIG_FREERTOS_USE_TICKLESS_IDLE and CONFIG_PM_LIGHT_SLEEP_CALLBACKS.
+ *
+ * @param config Pointer to the power configuration.
+ * @return ESP_OK on success, or an error code on failure.
+ */
+esp_err_t power_manager_start(const power_manager_config_t* config);
+
+/**
+ * @brief Keeps the chip out of light sleep for at least ms milliseconds.
+ *
+ * For bursts of input faster than the wakeup time, such as a spinning
+ * encoder. Calls extend the window. Not for use from an ISR.
+ */
+esp_err_t power_manager_keep_awake(uint32_t ms);
+
+/**
+ * @brief Reads the sleep statistics.
+ */
+esp_err_t power_manager_get_stats(power_manager_stats_t* stats);
+
+#endif // POWER_MANAGER_H
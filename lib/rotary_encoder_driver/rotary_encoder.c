@@ -1,7 +1,8 @@
 #include "rotary_encoder.h"
+#include "rotary_encoder_hal.h"
+#include "input_dispatcher.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "freertos/queue.h"
+#include "esp_timer.h"
 #include "esp_log.h"
 
 static const char *TAG = "ROTARY_ENCODER";
@@ -9,17 +10,90 @@ static const char *TAG = "ROTARY_ENCODER";
 // State machine table for decoding
 const int8_t KNOB_STATES[] = {0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
 
+// Transitions where both CLK and DT changed at once: the direction is unknown
+#define INVALID_TRANSITIONS ((1 << 0x3) | (1 << 0x6) | (1 << 0x9) | (1 << 0xC))
+
+// Velocity estimation
+#define VELOCITY_SMOOTHING 0.5f     // weight of the newest sample
+#define VELOCITY_IDLE_US 250000     // a gap this long starts a new movement from rest
+
+// A motion event the full dispatcher queue refused is posted again this much later
+#define RETRY_INTERVAL_US 10000
+
+// Event types posted to the input dispatcher
+#define ENCODER_EVENT_MOTION 0
+#define ENCODER_EVENT_FREE 1
+
+// PCNT backend defaults
+#define DEFAULT_GLITCH_FILTER_NS 1000
+#define DEFAULT_WATCH_STEPS 4
+
 /**
  * @brief Internal structure for a rotary encoder instance.
  */
 typedef struct rotary_encoder_t {
     rotary_encoder_config_t config;
-    QueueHandle_t event_queue;
     rotary_encoder_callback_t callback;
     void* user_data;
     uint8_t last_state;
+    rotary_encoder_counter_handle_t counter;    // PCNT backend only
+
+    // Written by the ISR. With PCNT, position only holds whole watch steps;
+    // the rest is still in the hardware counter.
+    volatile int32_t position;
+    volatile uint32_t steps;
+    volatile uint32_t invalid_transitions;
+    volatile bool event_pending;                // a motion event is queued, or waiting for the retry timer
+    esp_timer_handle_t retry_timer;             // posts the event the queue refused; last, the free
+    volatile bool deleted;                      // set by rotary_encoder_delete()
+
+    // Owned by the dispatcher task
+    int32_t delivered_position;
+    int64_t last_event_us;
+    float velocity;
+    uint32_t events;
 } rotary_encoder_t;
 
+static void deliver_event(const input_event_t* event);
+
+/**
+ * @brief Queues one motion event for this encoder unless one is already queued.
+ *
+ * Steps that arrive while an event is pending only move the position, and the
+ * pending event picks them up when it is delivered, so a fast spin costs one
+ * queue slot and loses nothing. If the queue is full the event stays pending
+ * and the retry timer posts it, so the last steps of a spin are not stranded.
+ */
+static void IRAM_ATTR post_motion_from_isr(rotary_encoder_handle_t handle, BaseType_t* higher_priority_task_woken) {
+    if (__atomic_exchange_n(&handle->event_pending, true, __ATOMIC_ACQ_REL)) {
+        return;
+    }
+    input_event_t event = {
+        .timestamp_us = esp_timer_get_time(),
+        .deliver = deliver_event,
+        .source = handle,
+        .type = ENCODER_EVENT_MOTION,
+    };
+    if (input_dispatcher_post_from_isr(&event, higher_priority_task_woken) != ESP_OK) {
+        esp_timer_start_once(handle->retry_timer, RETRY_INTERVAL_US);
+    }
+}
+
+// Runs in the esp_timer task: posts the motion event the queue refused, or,
+// once the encoder is deleted, the free. Keeps trying while the queue is full.
+static void retry_timer_callback(void* arg) {
+    rotary_encoder_handle_t handle = (rotary_encoder_handle_t)arg;
+    input_event_t event = {
+        .timestamp_us = esp_timer_get_time(),
+        .deliver = deliver_event,
+        .source = handle,
+        .type = handle->deleted ? ENCODER_EVENT_FREE : ENCODER_EVENT_MOTION,
+    };
+    if (input_dispatcher_post(&event, 0) != ESP_OK) {
+        esp_timer_start_once(handle->retry_timer, RETRY_INTERVAL_US);
+    }
+}
+
 static void IRAM_ATTR gpio_isr_handler(void* arg) {
     rotary_encoder_handle_t handle = (rotary_encoder_handle_t)arg;
 
@@ -33,39 +107,60 @@ static void IRAM_ATTR gpio_isr_handler(void* arg) {
     int8_t state = KNOB_STATES[handle->last_state];
 
     if (state != 0) {
-        rotary_encoder_event_t event = (state == 1) ? ROTARY_ENCODER_EVENT_CLOCKWISE : ROTARY_ENCODER_EVENT_COUNTER_CLOCKWISE;
-        xQueueSendFromISR(handle->event_queue, &event, NULL);
+        // Both pins share this handler, so the ISR cannot race itself; the
+        // atomic keeps the task's reads consistent on the other core.
+        __atomic_fetch_add(&handle->position, state, __ATOMIC_RELAXED);
+        handle->steps++;
+
+        BaseType_t higher_priority_task_woken = pdFALSE;
+        post_motion_from_isr(handle, &higher_priority_task_woken);
+        portYIELD_FROM_ISR(higher_priority_task_woken);
+    } else if (INVALID_TRANSITIONS & (1 << handle->last_state)) {
+        handle->invalid_transitions++;
     }
 }
 
-static void encoder_task(void* arg) {
+// PCNT watch point reached: the hardware has already moved its count back to 0
+static bool pcnt_watch_handler(int32_t steps, void* arg) {
     rotary_encoder_handle_t handle = (rotary_encoder_handle_t)arg;
-    rotary_encoder_event_t event;
 
-    while (1) {
-        if (xQueueReceive(handle->event_queue, &event, portMAX_DELAY)) {
-            if (handle->callback) {
-                handle->callback(handle, &event, handle->user_data);
-            }
-        }
-    }
+    __atomic_fetch_add(&handle->position, steps, __ATOMIC_RELAXED);
+    handle->steps += steps > 0 ? steps : -steps;
+
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    post_motion_from_isr(handle, &higher_priority_task_woken);
+    return higher_priority_task_woken == pdTRUE;
 }
 
-rotary_encoder_handle_t rotary_encoder_create(const rotary_encoder_config_t *config) {
-    rotary_encoder_handle_t handle = calloc(1, sizeof(rotary_encoder_t));
-    if (!handle) {
-        ESP_LOGE(TAG, "Failed to allocate memory for handle");
-        return NULL;
+static int32_t read_position(rotary_encoder_handle_t handle) {
+    int32_t position = __atomic_load_n(&handle->position, __ATOMIC_RELAXED);
+    if (handle->counter) {
+        // A watch point may fire between the two reads; retry until position is stable
+        int32_t partial, again;
+        do {
+            rotary_encoder_counter_ops.get_count(handle->counter, &partial);
+            again = position;
+            position = __atomic_load_n(&handle->position, __ATOMIC_RELAXED);
+        } while (position != again);
+        position += partial;
     }
+    return position;
+}
 
-    handle->config = *config;
+static esp_err_t start_pcnt_backend(rotary_encoder_handle_t handle) {
+    rotary_encoder_counter_config_t counter_config = {
+        .clk_pin = handle->config.clk_pin,
+        .dt_pin = handle->config.dt_pin,
+        .glitch_filter_ns = handle->config.glitch_filter_ns ? handle->config.glitch_filter_ns : DEFAULT_GLITCH_FILTER_NS,
+        .watch_steps = handle->config.watch_steps > 0 ? handle->config.watch_steps : DEFAULT_WATCH_STEPS,
+        .on_watch = pcnt_watch_handler,
+        .user_data = handle,
+    };
+    return rotary_encoder_counter_ops.create(&counter_config, &handle->counter);
+}
 
-    handle->event_queue = xQueueCreate(config->queue_size, sizeof(rotary_encoder_event_t));
-    if (!handle->event_queue) {
-        ESP_LOGE(TAG, "Failed to create event queue");
-        free(handle);
-        return NULL;
-    }
+static void start_gpio_backend(rotary_encoder_handle_t handle) {
+    const rotary_encoder_config_t* config = &handle->config;
 
     gpio_config_t io_conf = {};
     io_conf.intr_type = GPIO_INTR_ANYEDGE;
@@ -74,15 +169,106 @@ rotary_encoder_handle_t rotary_encoder_create(const rotary_encoder_config_t *con
     io_conf.pull_down_en = 1;
     gpio_config(&io_conf);
 
+    handle->last_state = (gpio_get_level(config->clk_pin) << 1) | gpio_get_level(config->dt_pin);
+
     // Install ISR service if not already installed
     gpio_install_isr_service(0);
 
     gpio_isr_handler_add(config->clk_pin, gpio_isr_handler, handle);
     gpio_isr_handler_add(config->dt_pin, gpio_isr_handler, handle);
+}
+
+// Runs on the input dispatcher task
+static void deliver_event(const input_event_t* event) {
+    rotary_encoder_handle_t handle = (rotary_encoder_handle_t)event->source;
 
-    xTaskCreate(encoder_task, "encoder_task", 2048, handle, 5, NULL);
+    if (event->type == ENCODER_EVENT_FREE) {
+        // Queued by the retry timer's last run behind every event that
+        // referenced the handle, so no delivery can still be reading the
+        // counter and the timer is idle for good
+        if (handle->counter) {
+            rotary_encoder_counter_ops.destroy(handle->counter);
+        }
+        esp_timer_delete(handle->retry_timer);
+        free(handle);
+        return;
+    }
+
+    // Clear first so a step during delivery queues a new event
+    __atomic_store_n(&handle->event_pending, false, __ATOMIC_RELEASE);
+
+    int32_t position = read_position(handle);
+    int32_t delta = position - handle->delivered_position;
+    if (delta == 0) {
+        return; // steps cancelled out, or already delivered
+    }
+    handle->delivered_position = position;
+
+    int64_t now = esp_timer_get_time();
+    int64_t dt_us = now - handle->last_event_us;
+    float previous = handle->velocity;
+    if (handle->last_event_us == 0 || dt_us >= VELOCITY_IDLE_US) {
+        // Starting from rest: treat the gap as one idle period
+        dt_us = VELOCITY_IDLE_US;
+        previous = 0.0f;
+    }
+    float sample = delta * 1e6f / (float)dt_us;
+    handle->velocity = previous + VELOCITY_SMOOTHING * (sample - previous);
+    handle->last_event_us = now;
+    handle->events++;
+
+    rotary_encoder_event_t motion = {
+        .delta = delta,
+        .position = position,
+        .direction = delta > 0 ? ROTARY_ENCODER_CLOCKWISE : ROTARY_ENCODER_COUNTER_CLOCKWISE,
+        .velocity = handle->velocity,
+        .acceleration = (handle->velocity - previous) * 1e6f / (float)dt_us,
+    };
+    rotary_encoder_callback_t callback = handle->callback;
+    if (callback) {
+        callback(handle, &motion, handle->user_data);
+    }
+}
+
+rotary_encoder_handle_t rotary_encoder_create(const rotary_encoder_config_t *config) {
+    if (!input_dispatcher_running()) {
+        ESP_LOGE(TAG, "Input dispatcher is not running");
+        return NULL;
+    }
+    rotary_encoder_handle_t handle = calloc(1, sizeof(rotary_encoder_t));
+    if (!handle) {
+        ESP_LOGE(TAG, "Failed to allocate memory for handle");
+        return NULL;
+    }
+
+    handle->config = *config;
+
+    const esp_timer_create_args_t retry_args = {
+        .callback = retry_timer_callback,
+        .arg = handle,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "enc_retry",
+    };
+    if (esp_timer_create(&retry_args, &handle->retry_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create retry timer");
+        free(handle);
+        return NULL;
+    }
+
+    if (config->backend == ROTARY_ENCODER_BACKEND_PCNT) {
+        esp_err_t err = start_pcnt_backend(handle);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to start PCNT backend: %s", esp_err_to_name(err));
+            esp_timer_delete(handle->retry_timer);
+            free(handle);
+            return NULL;
+        }
+    } else {
+        start_gpio_backend(handle);
+    }
 
-    ESP_LOGI(TAG, "Rotary encoder created for CLK:%d, DT:%d", config->clk_pin, config->dt_pin);
+    ESP_LOGI(TAG, "Rotary encoder created for CLK:%d, DT:%d (%s)", config->clk_pin, config->dt_pin,
+             config->backend == ROTARY_ENCODER_BACKEND_PCNT ? "PCNT" : "GPIO");
     return handle;
 }
 
@@ -93,8 +279,33 @@ esp_err_t rotary_encoder_register_callback(rotary_encoder_handle_t handle, rotar
     return ESP_OK;
 }
 
+esp_err_t rotary_encoder_get_stats(rotary_encoder_handle_t handle, rotary_encoder_stats_t* stats) {
+    if (!handle || !stats) return ESP_ERR_INVALID_ARG;
+    stats->steps = handle->steps;
+    stats->invalid_transitions = handle->invalid_transitions;
+    stats->events = handle->events;
+    return ESP_OK;
+}
+
 esp_err_t rotary_encoder_delete(rotary_encoder_handle_t handle) {
     if (!handle) return ESP_ERR_INVALID_ARG;
-    // TODO: Implement deletion logic (remove ISRs, delete task, delete queue, free handle)
-    return ESP_OK;
+
+    // Stop the event sources first so nothing new is posted for this handle.
+    // Queued events may still read the counter; it goes with the handle.
+    if (handle->counter) {
+        rotary_encoder_counter_ops.stop(handle->counter);
+    } else {
+        gpio_isr_handler_remove(handle->config.clk_pin);
+        gpio_isr_handler_remove(handle->config.dt_pin);
+        gpio_intr_disable(handle->config.clk_pin);
+        gpio_intr_disable(handle->config.dt_pin);
+    }
+    handle->callback = NULL;
+
+    // Events already queued still point at the handle, so free it behind
+    // them. The retry timer posts the free, after any run of it that is
+    // already under way.
+    handle->deleted = true;
+    esp_timer_stop(handle->retry_timer);
+    return esp_timer_start_once(handle->retry_timer, 0);
 }
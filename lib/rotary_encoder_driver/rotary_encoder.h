@@ -10,27 +10,60 @@
 typedef struct rotary_encoder_t* rotary_encoder_handle_t;
 
 /**
- * @brief Enumeration of rotary encoder events.
+ * @brief Direction of the net movement in an event.
  */
 typedef enum {
-    ROTARY_ENCODER_EVENT_COUNTER_CLOCKWISE,
-    ROTARY_ENCODER_EVENT_CLOCKWISE,
+    ROTARY_ENCODER_COUNTER_CLOCKWISE,
+    ROTARY_ENCODER_CLOCKWISE,
+} rotary_encoder_direction_t;
+
+/**
+ * @brief Movement since the previous event.
+ *
+ * Steps that arrive while the callback is still running are not lost; they
+ * are folded into the next event's delta.
+ */
+typedef struct {
+    int32_t delta;                          /*!< Net steps since the last event, positive is clockwise. Never 0. */
+    int32_t position;                       /*!< Total steps since creation. */
+    rotary_encoder_direction_t direction;   /*!< Sign of delta. */
+    float velocity;                         /*!< Smoothed speed in steps per second, signed like delta. */
+    float acceleration;                     /*!< Change of velocity in steps per second squared. */
 } rotary_encoder_event_t;
 
+/**
+ * @brief Counters for diagnosing a noisy or miswired encoder.
+ */
+typedef struct {
+    uint32_t steps;                         /*!< Valid quadrature transitions decoded. */
+    uint32_t invalid_transitions;           /*!< Both channels changed between two samples; the step was lost. */
+    uint32_t events;                        /*!< Callback invocations. */
+} rotary_encoder_stats_t;
+
+/**
+ * @brief How quadrature is decoded.
+ */
+typedef enum {
+    ROTARY_ENCODER_BACKEND_GPIO,    /*!< Software decoding from a GPIO interrupt on every CLK and DT edge. */
+    ROTARY_ENCODER_BACKEND_PCNT,    /*!< Pulse counter peripheral with glitch filter; interrupts only at watch points. */
+} rotary_encoder_backend_t;
+
 /**
  * @brief Configuration structure for a rotary encoder.
  */
 typedef struct {
     gpio_num_t clk_pin;
     gpio_num_t dt_pin;
-    uint32_t queue_size;
+    rotary_encoder_backend_t backend;   /*!< Defaults to ROTARY_ENCODER_BACKEND_GPIO. */
+    uint32_t glitch_filter_ns;          /*!< PCNT only: pulses shorter than this are ignored. 0 uses 1000 ns. */
+    int32_t watch_steps;                /*!< PCNT only: steps between callbacks. 0 uses 4, one detent on most encoders. */
 } rotary_encoder_config_t;
 
 /**
  * @brief Callback function type for rotary encoder events.
  *
  * @param handle The handle of the rotary encoder that generated the event.
- * @param event The type of event that occurred.
+ * @param event Net movement since the previous event.
  * @param user_data User-provided data associated with the encoder.
  */
 typedef void (*rotary_encoder_callback_t)(rotary_encoder_handle_t handle, const rotary_encoder_event_t* event, void* user_data);
@@ -38,6 +71,9 @@ typedef void (*rotary_encoder_callback_t)(rotary_encoder_handle_t handle, const
 /**
  * @brief Creates a new rotary encoder instance.
  *
+ * The callback runs on the input dispatcher task, which must already be
+ * running (see input_dispatcher_start()).
+ *
  * @param config Pointer to the rotary encoder configuration structure.
  * @return A handle to the created encoder instance, or NULL if creation fails.
  */
@@ -53,9 +89,23 @@ rotary_encoder_handle_t rotary_encoder_create(const rotary_encoder_config_t *con
  */
 esp_err_t rotary_encoder_register_callback(rotary_encoder_handle_t handle, rotary_encoder_callback_t callback, void* user_data);
 
+/**
+ * @brief Returns the encoder's counters.
+ *
+ * @param handle The handle of the rotary encoder.
+ * @param stats Filled with the current counters.
+ * @return ESP_OK on success, or an error code.
+ */
+esp_err_t rotary_encoder_get_stats(rotary_encoder_handle_t handle, rotary_encoder_stats_t* stats);
+
 /**
  * @brief Deletes a rotary encoder instance and frees its resources.
  *
+ * Removes the interrupt handlers (or stops the PCNT unit) right away and
+ * no new callback is started after this returns. The PCNT unit and the memory
+ * are released on the dispatcher task once events already queued for the
+ * encoder have been discarded.
+ *
  * @param handle The handle of the encoder to delete.
  * @return ESP_OK on success, or an error code.
  */
@@ -0,0 +1,70 @@
+#ifndef ROTARY_ENCODER_HAL_H
+#define ROTARY_ENCODER_HAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "esp_err.h"
+
+/*
+ * Hardware quadrature counter used by the PCNT backend.
+ *
+ * On the target this is the pulse counter peripheral. Host builds (no
+ * ESP_PLATFORM) link a simulated counter instead, driven by
+ * rotary_encoder_counter_sim_rotate(), so the backend's logic can be
+ * exercised on Linux.
+ */
+
+/**
+ * @brief Opaque handle for a counter instance.
+ */
+typedef struct rotary_encoder_counter_t* rotary_encoder_counter_handle_t;
+
+/**
+ * @brief Called, possibly from an ISR, each time the count reaches +/- watch_steps.
+ *
+ * The counter restarts from 0 right after.
+ *
+ * @param steps The watch point that was reached (+watch_steps or -watch_steps).
+ * @param user_data User data provided in the configuration.
+ * @return Whether a higher-priority task was woken.
+ */
+typedef bool (*rotary_encoder_watch_cb_t)(int32_t steps, void* user_data);
+
+/**
+ * @brief Configuration for a counter instance.
+ */
+typedef struct {
+    gpio_num_t clk_pin;
+    gpio_num_t dt_pin;
+    uint32_t glitch_filter_ns;          /*!< Pulses shorter than this are ignored. 0 disables the filter. */
+    int32_t watch_steps;                /*!< Threshold for on_watch, in quadrature steps. Must be > 0. */
+    rotary_encoder_watch_cb_t on_watch;
+    void* user_data;
+} rotary_encoder_counter_config_t;
+
+/**
+ * @brief Operations of a counter implementation.
+ */
+typedef struct {
+    esp_err_t (*create)(const rotary_encoder_counter_config_t* config, rotary_encoder_counter_handle_t* out);
+    esp_err_t (*get_count)(rotary_encoder_counter_handle_t counter, int32_t* count); /*!< Steps since the last watch point. */
+    esp_err_t (*stop)(rotary_encoder_counter_handle_t counter); /*!< Stops counting and on_watch; get_count still works. */
+    esp_err_t (*destroy)(rotary_encoder_counter_handle_t counter);
+} rotary_encoder_counter_ops_t;
+
+/**
+ * @brief The counter implementation for this build: PCNT on the target, simulated on the host.
+ */
+extern const rotary_encoder_counter_ops_t rotary_encoder_counter_ops;
+
+#ifndef ESP_PLATFORM
+/**
+ * @brief Moves the most recently created simulated counter by the given number of steps.
+ *
+ * Steps are applied one at a time, so every watch point on the way fires.
+ */
+void rotary_encoder_counter_sim_rotate(int32_t steps);
+#endif
+
+#endif // ROTARY_ENCODER_HAL_H
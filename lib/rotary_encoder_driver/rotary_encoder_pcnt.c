@@ -0,0 +1,129 @@
+#ifdef ESP_PLATFORM
+
+#include "rotary_encoder_hal.h"
+#include "driver/pulse_cnt.h"
+#include "esp_log.h"
+#include <stdlib.h>
+
+static const char *TAG = "ROTARY_PCNT";
+
+/**
+ * @brief Internal structure for a PCNT counter instance.
+ */
+struct rotary_encoder_counter_t {
+    pcnt_unit_handle_t unit;
+    pcnt_channel_handle_t chan_clk;
+    pcnt_channel_handle_t chan_dt;
+    rotary_encoder_counter_config_t config;
+};
+
+static bool pcnt_on_reach(pcnt_unit_handle_t unit, const pcnt_watch_event_data_t* edata, void* user_ctx) {
+    rotary_encoder_counter_handle_t counter = (rotary_encoder_counter_handle_t)user_ctx;
+    return counter->config.on_watch(edata->watch_point_value, counter->config.user_data);
+}
+
+static esp_err_t pcnt_counter_destroy(rotary_encoder_counter_handle_t counter);
+
+/**
+ * @brief Sets up a PCNT unit as a x4 quadrature decoder.
+ *
+ * Each channel counts the edges of one pin and uses the other pin's level
+ * to pick the direction. The signs match KNOB_STATES in rotary_encoder.c,
+ * so both backends agree on what clockwise means. The watch points sit on
+ * the unit limits, where the hardware also resets the count to 0.
+ */
+static esp_err_t pcnt_counter_create(const rotary_encoder_counter_config_t* config, rotary_encoder_counter_handle_t* out) {
+    rotary_encoder_counter_handle_t counter = calloc(1, sizeof(struct rotary_encoder_counter_t));
+    if (counter == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    counter->config = *config;
+
+    pcnt_unit_config_t unit_config = {
+        .high_limit = config->watch_steps,
+        .low_limit = -config->watch_steps,
+    };
+    esp_err_t err = pcnt_new_unit(&unit_config, &counter->unit);
+    if (err != ESP_OK) {
+        free(counter);
+        return err;
+    }
+
+    if (config->glitch_filter_ns > 0) {
+        pcnt_glitch_filter_config_t filter_config = { .max_glitch_ns = config->glitch_filter_ns };
+        err = pcnt_unit_set_glitch_filter(counter->unit, &filter_config);
+    }
+
+    // CLK edges: rising counts up while DT is low
+    pcnt_chan_config_t clk_config = { .edge_gpio_num = config->clk_pin, .level_gpio_num = config->dt_pin };
+    if (err == ESP_OK) err = pcnt_new_channel(counter->unit, &clk_config, &counter->chan_clk);
+    if (err == ESP_OK) err = pcnt_channel_set_edge_action(counter->chan_clk, PCNT_CHANNEL_EDGE_ACTION_INCREASE, PCNT_CHANNEL_EDGE_ACTION_DECREASE);
+    if (err == ESP_OK) err = pcnt_channel_set_level_action(counter->chan_clk, PCNT_CHANNEL_LEVEL_ACTION_INVERSE, PCNT_CHANNEL_LEVEL_ACTION_KEEP);
+
+    // DT edges: rising counts down while CLK is low
+    pcnt_chan_config_t dt_config = { .edge_gpio_num = config->dt_pin, .level_gpio_num = config->clk_pin };
+    if (err == ESP_OK) err = pcnt_new_channel(counter->unit, &dt_config, &counter->chan_dt);
+    if (err == ESP_OK) err = pcnt_channel_set_edge_action(counter->chan_dt, PCNT_CHANNEL_EDGE_ACTION_DECREASE, PCNT_CHANNEL_EDGE_ACTION_INCREASE);
+    if (err == ESP_OK) err = pcnt_channel_set_level_action(counter->chan_dt, PCNT_CHANNEL_LEVEL_ACTION_INVERSE, PCNT_CHANNEL_LEVEL_ACTION_KEEP);
+
+    // Same pulls as the GPIO backend
+    gpio_pulldown_en(config->clk_pin);
+    gpio_pulldown_en(config->dt_pin);
+
+    if (err == ESP_OK) err = pcnt_unit_add_watch_point(counter->unit, config->watch_steps);
+    if (err == ESP_OK) err = pcnt_unit_add_watch_point(counter->unit, -config->watch_steps);
+    pcnt_event_callbacks_t cbs = { .on_reach = pcnt_on_reach };
+    if (err == ESP_OK) err = pcnt_unit_register_event_callbacks(counter->unit, &cbs, counter);
+    if (err == ESP_OK) err = pcnt_unit_enable(counter->unit);
+    if (err == ESP_OK) err = pcnt_unit_clear_count(counter->unit);
+    if (err == ESP_OK) err = pcnt_unit_start(counter->unit);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "PCNT setup failed: %s", esp_err_to_name(err));
+        pcnt_counter_destroy(counter);
+        return err;
+    }
+
+    *out = counter;
+    return ESP_OK;
+}
+
+static esp_err_t pcnt_counter_get_count(rotary_encoder_counter_handle_t counter, int32_t* count) {
+    int value = 0;
+    esp_err_t err = pcnt_unit_get_count(counter->unit, &value);
+    *count = value;
+    return err;
+}
+
+// A disabled unit raises no more interrupts, but its count can still be read
+static esp_err_t pcnt_counter_stop(rotary_encoder_counter_handle_t counter) {
+    esp_err_t err = pcnt_unit_stop(counter->unit);
+    if (err == ESP_OK) {
+        err = pcnt_unit_disable(counter->unit);
+    }
+    return err;
+}
+
+// Tears down whatever part of the unit exists; used for create failures too
+static esp_err_t pcnt_counter_destroy(rotary_encoder_counter_handle_t counter) {
+    pcnt_unit_stop(counter->unit);
+    pcnt_unit_disable(counter->unit);
+    if (counter->chan_clk) {
+        pcnt_del_channel(counter->chan_clk);
+    }
+    if (counter->chan_dt) {
+        pcnt_del_channel(counter->chan_dt);
+    }
+    esp_err_t err = pcnt_del_unit(counter->unit);
+    free(counter);
+    return err;
+}
+
+const rotary_encoder_counter_ops_t rotary_encoder_counter_ops = {
+    .create = pcnt_counter_create,
+    .get_count = pcnt_counter_get_count,
+    .stop = pcnt_counter_stop,
+    .destroy = pcnt_counter_destroy,
+};
+
+#endif // ESP_PLATFORM
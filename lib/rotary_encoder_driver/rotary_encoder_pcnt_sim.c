@@ -0,0 +1,73 @@
+#ifndef ESP_PLATFORM
+
+#include "rotary_encoder_hal.h"
+#include <stdlib.h>
+
+/**
+ * @brief Simulated counter: counts steps and fires watch points like PCNT would.
+ */
+struct rotary_encoder_counter_t {
+    rotary_encoder_counter_config_t config;
+    int32_t count;
+    bool stopped;
+};
+
+static rotary_encoder_counter_handle_t last_counter = NULL;
+
+static esp_err_t sim_counter_create(const rotary_encoder_counter_config_t* config, rotary_encoder_counter_handle_t* out) {
+    if (config->watch_steps <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    rotary_encoder_counter_handle_t counter = calloc(1, sizeof(struct rotary_encoder_counter_t));
+    if (counter == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    counter->config = *config;
+    last_counter = counter;
+    *out = counter;
+    return ESP_OK;
+}
+
+static esp_err_t sim_counter_get_count(rotary_encoder_counter_handle_t counter, int32_t* count) {
+    *count = counter->count;
+    return ESP_OK;
+}
+
+static esp_err_t sim_counter_stop(rotary_encoder_counter_handle_t counter) {
+    counter->stopped = true;
+    return ESP_OK;
+}
+
+static esp_err_t sim_counter_destroy(rotary_encoder_counter_handle_t counter) {
+    if (last_counter == counter) {
+        last_counter = NULL;
+    }
+    free(counter);
+    return ESP_OK;
+}
+
+void rotary_encoder_counter_sim_rotate(int32_t steps) {
+    rotary_encoder_counter_handle_t counter = last_counter;
+    if (counter == NULL || counter->stopped) {
+        return;
+    }
+    int32_t dir = steps > 0 ? 1 : -1;
+    for (int32_t i = 0; i != steps; i += dir) {
+        counter->count += dir;
+        if (counter->count == counter->config.watch_steps || counter->count == -counter->config.watch_steps) {
+            // The unit limits reset the hardware count to 0 before the event
+            int32_t reached = counter->count;
+            counter->count = 0;
+            counter->config.on_watch(reached, counter->config.user_data);
+        }
+    }
+}
+
+const rotary_encoder_counter_ops_t rotary_encoder_counter_ops = {
+    .create = sim_counter_create,
+    .get_count = sim_counter_get_count,
+    .stop = sim_counter_stop,
+    .destroy = sim_counter_destroy,
+};
+
+#endif // ESP_PLATFORM
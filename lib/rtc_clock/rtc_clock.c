@@ -0,0 +1,358 @@
+#include "rtc_clock.h"
+#include "time_core.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+
+static const char *TAG = "RTC_CLOCK";
+
+#define CLOCK_TASK_STACK_SIZE 3072
+
+// With no edge for this long we assume SQW is not connected and poll instead
+#define SQW_TIMEOUT_MS 1500
+#define FALLBACK_POLL_MS 500
+// Minute ticks that stop coming are caught a second late
+#define MINUTE_TIMEOUT_MS 61000
+
+// --- Private Module State ---
+static rtc_clock_config_t clock_config;
+static TaskHandle_t clock_task_handle = NULL;
+static portMUX_TYPE time_lock = portMUX_INITIALIZER_UNLOCKED;
+static rtc_time_t local_time;
+static uint32_t seconds_since_sync;
+static int64_t pending_edge_us;     // esp_timer time of the latest edge, set by the ISR
+static int64_t edge_us;             // edge at which local_time began; 0 when unknown
+static int64_t base_us;             // when local_time was read or began, for carrying it forward
+static rtc_tick_t tick_rate;
+static volatile bool stop_requested = false;
+
+// --- Forward Declarations ---
+static void clock_task(void* arg);
+static void notify_tick(void);
+static void on_second_tick(uint32_t edges);
+static void on_interrupt(uint32_t edges, rtc_tick_t tick);
+static void advance_one_second(rtc_time_t* t);
+static esp_err_t resync(int64_t at_us);
+
+static void IRAM_ATTR sqw_isr_handler(void* arg) {
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL_ISR(&time_lock);
+    pending_edge_us = now;
+    taskEXIT_CRITICAL_ISR(&time_lock);
+    vTaskNotifyGiveFromISR(clock_task_handle, &higher_priority_task_woken);
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+// --- Public API Implementation ---
+
+esp_err_t rtc_clock_start(const rtc_clock_config_t* config) {
+    if (config == NULL || config->device == NULL || config->resync_interval_s == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (clock_task_handle != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    clock_config = *config;
+    tick_rate = config->tick;
+
+    esp_err_t err = resync(0);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Initial RTC read failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    err = clock_config.device->set_tick(config->tick);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set the tick rate: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    if (xTaskCreate(clock_task, "rtc_clock", CLOCK_TASK_STACK_SIZE, NULL, config->task_priority,
+                    &clock_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create clock task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // SQW/OUT and INT/SQW are open drain
+    gpio_config_t io_conf = {
+        .pin_bit_mask = (1ULL << config->sqw_pin),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_NEGEDGE,
+    };
+    gpio_config(&io_conf);
+
+    // Install ISR service if not already installed
+    gpio_install_isr_service(0);
+    gpio_isr_handler_add(config->sqw_pin, sqw_isr_handler, NULL);
+
+    ESP_LOGI(TAG, "Clock running from the %s on GPIO %d, resync every %lus", clock_config.device->name,
+             config->sqw_pin, (unsigned long)config->resync_interval_s);
+    return ESP_OK;
+}
+
+esp_err_t rtc_clock_stop(void) {
+    if (clock_task_handle == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    gpio_isr_handler_remove(clock_config.sqw_pin);
+
+    // The task clears its handle on the way out
+    stop_requested = true;
+    xTaskNotifyGive(clock_task_handle);
+    while (clock_task_handle != NULL) {
+        vTaskDelay(1);
+    }
+    stop_requested = false;
+
+    if (clock_config.device->cancel_alarm) {
+        clock_config.device->cancel_alarm();
+    }
+    return clock_config.device->set_tick(RTC_TICK_NONE);
+}
+
+esp_err_t rtc_clock_get_time(rtc_time_t* time) {
+    if (time == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    taskENTER_CRITICAL(&time_lock);
+    *time = local_time;
+    int64_t since_us = tick_rate == RTC_TICK_SECOND ? 0 : esp_timer_get_time() - base_us;
+    taskEXIT_CRITICAL(&time_lock);
+
+    if (since_us >= 1000000) {
+        time_core_to_rtc(time_core_from_rtc(time) + since_us / 1000000, time);
+    }
+    return ESP_OK;
+}
+
+esp_err_t rtc_clock_get_edge(rtc_time_t* time, int64_t* at_us) {
+    if (time == NULL || at_us == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    taskENTER_CRITICAL(&time_lock);
+    *time = local_time;
+    *at_us = edge_us;
+    taskEXIT_CRITICAL(&time_lock);
+    return *at_us != 0 ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t rtc_clock_set_time(const rtc_time_t* time) {
+    if (time == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // Writing the seconds register restarts the RTC's one-second countdown,
+    // so the next edge is a full second after this write.
+    esp_err_t err = clock_config.device->set_time(time);
+    if (err == ESP_OK) {
+        int64_t now = esp_timer_get_time();
+        taskENTER_CRITICAL(&time_lock);
+        local_time = *time;
+        seconds_since_sync = 0;
+        edge_us = now;
+        base_us = now;
+        taskEXIT_CRITICAL(&time_lock);
+    }
+    return err;
+}
+
+esp_err_t rtc_clock_set_tick(rtc_tick_t tick) {
+    if (clock_task_handle == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t err = clock_config.device->set_tick(tick);
+    if (err != ESP_OK) {
+        return err;
+    }
+    // Carry the time over at the old rate, then start afresh at the new one
+    rtc_time_t now;
+    rtc_clock_get_time(&now);
+    taskENTER_CRITICAL(&time_lock);
+    tick_rate = tick;
+    taskEXIT_CRITICAL(&time_lock);
+    err = resync(0);
+    if (err != ESP_OK) {
+        // Keep going on the CPU clock until the next edge reads the registers
+        taskENTER_CRITICAL(&time_lock);
+        local_time = now;
+        base_us = esp_timer_get_time();
+        edge_us = 0;
+        taskEXIT_CRITICAL(&time_lock);
+    }
+    ESP_LOGI(TAG, "Ticking %s", tick == RTC_TICK_SECOND ? "every second" :
+                                tick == RTC_TICK_MINUTE ? "every minute" : "only for the alarm");
+    return ESP_OK;
+}
+
+esp_err_t rtc_clock_set_alarm(const rtc_time_t* utc) {
+    if (utc == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (clock_task_handle == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (clock_config.device->set_alarm == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return clock_config.device->set_alarm(utc);
+}
+
+esp_err_t rtc_clock_cancel_alarm(void) {
+    if (clock_task_handle == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (clock_config.device->cancel_alarm == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return clock_config.device->cancel_alarm();
+}
+
+// --- Private Functions ---
+
+// at_us is the edge at which the registers' current second began, or 0 when unknown
+static esp_err_t resync(int64_t at_us) {
+    rtc_time_t now;
+    esp_err_t err = clock_config.device->get_time(&now);
+    if (err == ESP_OK) {
+        int64_t read_us = esp_timer_get_time();
+        taskENTER_CRITICAL(&time_lock);
+        local_time = now;
+        seconds_since_sync = 0;
+        edge_us = at_us;
+        base_us = at_us != 0 ? at_us : read_us;
+        taskEXIT_CRITICAL(&time_lock);
+    }
+    return err;
+}
+
+static void clock_task(void* arg) {
+    bool sqw_seen = false;
+
+    while (!stop_requested) {
+        taskENTER_CRITICAL(&time_lock);
+        rtc_tick_t tick = tick_rate;
+        taskEXIT_CRITICAL(&time_lock);
+
+        TickType_t timeout = portMAX_DELAY;
+        if (tick == RTC_TICK_SECOND) {
+            timeout = pdMS_TO_TICKS(sqw_seen ? SQW_TIMEOUT_MS : FALLBACK_POLL_MS);
+        } else if (tick == RTC_TICK_MINUTE) {
+            timeout = pdMS_TO_TICKS(MINUTE_TIMEOUT_MS);
+        }
+        uint32_t edges = ulTaskNotifyTake(pdTRUE, timeout);
+        if (stop_requested) {
+            break;
+        }
+
+        // The rate may have changed while waiting
+        taskENTER_CRITICAL(&time_lock);
+        tick = tick_rate;
+        taskEXIT_CRITICAL(&time_lock);
+        if (tick == RTC_TICK_SECOND) {
+            sqw_seen = edges > 0;
+            on_second_tick(edges);
+        } else {
+            on_interrupt(edges, tick);
+        }
+    }
+
+    clock_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+static void notify_tick(void) {
+    if (clock_config.tick_cb) {
+        rtc_time_t now;
+        rtc_clock_get_time(&now);
+        clock_config.tick_cb(&now, clock_config.user_data);
+    }
+}
+
+static void on_second_tick(uint32_t edges) {
+    if (edges == 0) {
+        // No square wave: fall back to reading the registers
+        ESP_LOGD(TAG, "No SQW edge, polling RTC");
+        resync(0);
+    } else {
+        // A square wave needs no acknowledging
+        taskENTER_CRITICAL(&time_lock);
+        for (uint32_t i = 0; i < edges; i++) {
+            advance_one_second(&local_time);
+        }
+        seconds_since_sync += edges;
+        edge_us = pending_edge_us;
+        base_us = edge_us;
+        bool resync_due = seconds_since_sync >= clock_config.resync_interval_s;
+        int64_t at_us = edge_us;
+        taskEXIT_CRITICAL(&time_lock);
+
+        // Right after an edge the registers already hold the new second
+        if (resync_due && resync(at_us) != ESP_OK) {
+            ESP_LOGW(TAG, "Resync failed, keeping local time");
+        }
+    }
+    notify_tick();
+}
+
+// The pin stays low until the chip's flags are cleared, so a timeout is
+// acknowledged as well in case an edge was lost in the meantime
+static void on_interrupt(uint32_t edges, rtc_tick_t tick) {
+    bool ticked = false;
+    bool alarm = false;
+    if (clock_config.device->ack_interrupt &&
+        clock_config.device->ack_interrupt(&ticked, &alarm) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to acknowledge the RTC interrupt");
+    }
+
+    if (ticked || (edges == 0 && tick == RTC_TICK_MINUTE)) {
+        // Only a tick edge is known to fall on a second boundary; a stale
+        // alarm flag pulls the pin whenever interrupts are switched on
+        taskENTER_CRITICAL(&time_lock);
+        int64_t at_us = ticked && edges > 0 ? pending_edge_us : 0;
+        taskEXIT_CRITICAL(&time_lock);
+        if (resync(at_us) != ESP_OK) {
+            ESP_LOGW(TAG, "Resync failed, keeping local time");
+        }
+        notify_tick();
+    }
+    if (alarm) {
+        ESP_LOGD(TAG, "RTC alarm");
+        if (clock_config.alarm_cb) {
+            clock_config.alarm_cb(clock_config.user_data);
+        }
+    }
+}
+
+static uint8_t days_in_month(uint8_t month, uint8_t year) {
+    static const uint8_t days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month == 2 && (year % 4) == 0) { // RTC years are 2000-2099
+        return 29;
+    }
+    return (month >= 1 && month <= 12) ? days[month - 1] : 31;
+}
+
+static void advance_one_second(rtc_time_t* t) {
+    if (++t->seconds < 60) {
+        return;
+    }
+    t->seconds = 0;
+    if (++t->minutes < 60) {
+        return;
+    }
+    t->minutes = 0;
+    if (++t->hours < 24) {
+        return;
+    }
+    t->hours = 0;
+    t->day = (t->day % 7) + 1;
+    if (++t->date <= days_in_month(t->month, t->year)) {
+        return;
+    }
+    t->date = 1;
+    if (++t->month <= 12) {
+        return;
+    }
+    t->month = 1;
+    t->year = (t->year + 1) % 100;
+}
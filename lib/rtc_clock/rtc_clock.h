@@ -0,0 +1,110 @@
+#ifndef RTC_CLOCK_H
+#define RTC_CLOCK_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "rtc_device.h"
+
+/**
+ * @brief Callback invoked on every tick, right after the RTC's registers changed.
+ *
+ * @param now The current time.
+ * @param user_data User data provided in the configuration.
+ */
+typedef void (*rtc_clock_tick_cb_t)(const rtc_time_t* now, void* user_data);
+
+/**
+ * @brief Callback invoked on the clock task when the alarm set with rtc_clock_set_alarm() fires.
+ */
+typedef void (*rtc_clock_alarm_cb_t)(void* user_data);
+
+/**
+ * @brief Configuration for the SQW-driven clock.
+ */
+typedef struct {
+    const rtc_device_t* device;     /*!< RTC chip, e.g. &ds1307_rtc_device. Its init must have been called. */
+    gpio_num_t sqw_pin;             /*!< GPIO wired to the chip's SQW/OUT or INT/SQW pin. */
+    rtc_tick_t tick;                /*!< Initial tick rate; see rtc_clock_set_tick(). */
+    uint32_t resync_interval_s;     /*!< Seconds between full register reads. */
+    UBaseType_t task_priority;      /*!< Priority of the clock task. */
+    rtc_clock_tick_cb_t tick_cb;    /*!< Optional per-tick callback. */
+    rtc_clock_alarm_cb_t alarm_cb;  /*!< Optional alarm callback. */
+    void* user_data;                /*!< User data passed to the callbacks. */
+} rtc_clock_config_t;
+
+/**
+ * @brief Starts keeping time from the RTC's square wave.
+ *
+ * Reads the RTC once, sets its tick rate and, at one tick per second,
+ * advances a local copy of the time on every falling edge. The registers are
+ * only read again every resync_interval_s seconds, after rtc_clock_set_time(),
+ * or every second if no edge arrives (SQW not wired).
+ *
+ * @param config Pointer to the clock configuration.
+ * @return ESP_OK on success, or an error code on failure.
+ */
+esp_err_t rtc_clock_start(const rtc_clock_config_t* config);
+
+/**
+ * @brief Stops the clock task, releases the pin and turns the chip's ticks off.
+ *
+ * Waits for the clock task to exit, so it must not be called from tick_cb or
+ * alarm_cb, which run on that task.
+ */
+esp_err_t rtc_clock_stop(void);
+
+/**
+ * @brief Returns the local copy of the time without touching the bus.
+ *
+ * Below one tick per second the copy is carried forward on the CPU clock
+ * from the last edge or register read.
+ */
+esp_err_t rtc_clock_get_time(rtc_time_t* time);
+
+/**
+ * @brief Returns the time of the last edge with the esp_timer time it was seen at.
+ *
+ * The pair pins the RTC's second boundaries to the CPU clock, to within the
+ * interrupt latency, without touching the bus.
+ *
+ * @return ESP_OK, or ESP_ERR_INVALID_STATE while no edge has been seen (SQW
+ *         not wired, or no ticks); time is filled in either way.
+ */
+esp_err_t rtc_clock_get_edge(rtc_time_t* time, int64_t* at_us);
+
+/**
+ * @brief Writes the time to the RTC and the local copy.
+ */
+esp_err_t rtc_clock_set_time(const rtc_time_t* time);
+
+/**
+ * @brief Changes how often the chip wakes the clock task.
+ *
+ * Fewer ticks mean fewer wakeups while idle: at RTC_TICK_MINUTE the
+ * registers are read once a minute, at RTC_TICK_NONE only when the alarm
+ * fires. tick_cb follows the rate.
+ *
+ * @return ESP_ERR_NOT_SUPPORTED if the chip cannot produce the rate.
+ */
+esp_err_t rtc_clock_set_tick(rtc_tick_t tick);
+
+/**
+ * @brief Arms the chip's alarm to pull the pin at a UTC time, replacing any armed one.
+ *
+ * The chip compares the date of the month but not the month, so a time
+ * more than a month ahead fires early; alarm_cb should check and re-arm.
+ *
+ * @return ESP_ERR_NOT_SUPPORTED if the chip has no alarm.
+ */
+esp_err_t rtc_clock_set_alarm(const rtc_time_t* utc);
+
+/**
+ * @brief Disarms the chip's alarm.
+ *
+ * @return ESP_ERR_NOT_SUPPORTED if the chip has no alarm.
+ */
+esp_err_t rtc_clock_cancel_alarm(void);
+
+#endif // RTC_CLOCK_H
@@ -0,0 +1,31 @@
+#include "rtc_device.h"
+
+// --- Public API Implementation ---
+
+uint8_t rtc_device_bcd_to_dec(uint8_t bcd) {
+    return (bcd >> 4) * 10 + (bcd & 0x0F);
+}
+
+uint8_t rtc_device_dec_to_bcd(uint8_t dec) {
+    return ((dec / 10) << 4) | (dec % 10);
+}
+
+void rtc_device_decode_time(const uint8_t regs[7], rtc_time_t* time) {
+    time->seconds = rtc_device_bcd_to_dec(regs[0] & 0x7F); // DS1307 clock halt bit
+    time->minutes = rtc_device_bcd_to_dec(regs[1] & 0x7F);
+    time->hours = rtc_device_bcd_to_dec(regs[2] & 0x3F);   // 24-hour mode
+    time->day = rtc_device_bcd_to_dec(regs[3] & 0x07);
+    time->date = rtc_device_bcd_to_dec(regs[4] & 0x3F);
+    time->month = rtc_device_bcd_to_dec(regs[5] & 0x1F);   // DS3231 century bit
+    time->year = rtc_device_bcd_to_dec(regs[6]);
+}
+
+void rtc_device_encode_time(const rtc_time_t* time, uint8_t regs[7]) {
+    regs[0] = rtc_device_dec_to_bcd(time->seconds);
+    regs[1] = rtc_device_dec_to_bcd(time->minutes);
+    regs[2] = rtc_device_dec_to_bcd(time->hours);
+    regs[3] = rtc_device_dec_to_bcd(time->day);
+    regs[4] = rtc_device_dec_to_bcd(time->date);
+    regs[5] = rtc_device_dec_to_bcd(time->month);
+    regs[6] = rtc_device_dec_to_bcd(time->year);
+}
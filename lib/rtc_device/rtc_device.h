@@ -0,0 +1,55 @@
+#ifndef RTC_DEVICE_H
+#define RTC_DEVICE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "rtc_time.h"
+
+/*
+ * Interface between rtc_clock and an RTC chip. Each driver exports one
+ * rtc_device_t next to its own chip-specific API (ds1307_rtc_device,
+ * ds3231_rtc_device). Times are UTC.
+ */
+
+/**
+ * @brief What the chip's SQW/INT pin signals besides the alarm.
+ */
+typedef enum {
+    RTC_TICK_SECOND = 0,            /*!< A falling edge at every seconds update. */
+    RTC_TICK_MINUTE,                /*!< A falling edge when the seconds wrap to 00. */
+    RTC_TICK_NONE,                  /*!< Only the alarm, if the chip has one. */
+} rtc_tick_t;
+
+/**
+ * @brief Operations of an RTC chip. Optional operations are NULL when the chip lacks the feature.
+ */
+typedef struct {
+    const char* name;
+    esp_err_t (*get_time)(rtc_time_t* time);
+    esp_err_t (*set_time)(const rtc_time_t* time);
+    esp_err_t (*set_tick)(rtc_tick_t tick);             /*!< ESP_ERR_NOT_SUPPORTED for rates the chip cannot produce. */
+    esp_err_t (*ack_interrupt)(bool* tick, bool* alarm); /*!< Optional: after an edge, releases a latched pin and says what caused it. */
+    esp_err_t (*set_alarm)(const rtc_time_t* at);       /*!< Optional: pulls the pin low once at this date and time. */
+    esp_err_t (*cancel_alarm)(void);                    /*!< Optional; present when set_alarm is. */
+} rtc_device_t;
+
+/**
+ * @brief Decodes the seven BCD timekeeping registers (0x00-0x06) that the DS1307 and DS3231 share.
+ *
+ * Control bits in the same registers (clock halt, 12-hour mode, century) are ignored.
+ */
+void rtc_device_decode_time(const uint8_t regs[7], rtc_time_t* time);
+
+/**
+ * @brief Encodes a time into the seven BCD timekeeping registers, in 24-hour mode.
+ */
+void rtc_device_encode_time(const rtc_time_t* time, uint8_t regs[7]);
+
+/**
+ * @brief BCD helpers for the chips' other registers.
+ */
+uint8_t rtc_device_bcd_to_dec(uint8_t bcd);
+uint8_t rtc_device_dec_to_bcd(uint8_t dec);
+
+#endif // RTC_DEVICE_H
@@ -0,0 +1,19 @@
+#ifndef RTC_TIME_H
+#define RTC_TIME_H
+
+#include <stdint.h>
+
+/**
+ * @brief Broken-down time as kept by the RTC chips (BCD already decoded).
+ */
+typedef struct {
+    uint8_t seconds;                /*!< 0-59 */
+    uint8_t minutes;                /*!< 0-59 */
+    uint8_t hours;                  /*!< 0-23 */
+    uint8_t day;                    /*!< Day of the week, 1-7; time_core uses 1 = Sunday. */
+    uint8_t date;                   /*!< Day of the month, 1-31. */
+    uint8_t month;                  /*!< 1-12 */
+    uint8_t year;                   /*!< Years since 2000, 0-99. */
+} rtc_time_t;
+
+#endif // RTC_TIME_H
@@ -0,0 +1,180 @@
+#include "time_core.h"
+#include <string.h>
+
+// Days from 0000-03-01 to 1970-01-01 in the proleptic Gregorian calendar
+#define DAYS_TO_EPOCH 719468
+#define DAYS_PER_ERA 146097         // 400 years
+
+// --- Private Module State ---
+// Rules follow the POSIX TZ strings; the hour is in the offset in force before each change
+static const time_core_zone_t zones[] = {
+    { "UTC",                    0,    0, { 0 },            { 0 } },
+    { "Europe/London",          0,   60, { 3, 5, 0, 1 },   { 10, 5, 0, 2 } },
+    { "Europe/Berlin",         60,  120, { 3, 5, 0, 2 },   { 10, 5, 0, 3 } },
+    { "Europe/Helsinki",      120,  180, { 3, 5, 0, 3 },   { 10, 5, 0, 4 } },
+    { "America/New_York",    -300, -240, { 3, 2, 0, 2 },   { 11, 1, 0, 2 } },
+    { "America/Chicago",     -360, -300, { 3, 2, 0, 2 },   { 11, 1, 0, 2 } },
+    { "America/Denver",      -420, -360, { 3, 2, 0, 2 },   { 11, 1, 0, 2 } },
+    { "America/Los_Angeles", -480, -420, { 3, 2, 0, 2 },   { 11, 1, 0, 2 } },
+    { "Asia/Kolkata",         330,  330, { 0 },            { 0 } },
+    { "Asia/Tokyo",           540,  540, { 0 },            { 0 } },
+    { "Australia/Sydney",     600,  660, { 10, 1, 0, 2 },  { 4, 1, 0, 3 } },
+};
+
+// --- Forward Declarations ---
+static int64_t floor_div(int64_t a, int64_t b);
+static int64_t rule_local_seconds(const time_core_rule_t* rule, int32_t year);
+static bool in_dst(const time_core_zone_t* zone, int64_t utc);
+
+// --- Public API Implementation ---
+
+int64_t time_core_days_from_civil(int32_t year, uint8_t month, uint8_t date) {
+    // Count from March so the leap day is the last day of the year
+    int64_t y = (int64_t)year - (month <= 2);
+    int64_t era = floor_div(y, 400);
+    int64_t year_of_era = y - era * 400;                                    // 0-399
+    int64_t day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + date - 1; // 0-365
+    int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * DAYS_PER_ERA + day_of_era - DAYS_TO_EPOCH;
+}
+
+void time_core_civil_from_days(int64_t days, int32_t* year, uint8_t* month, uint8_t* date) {
+    days += DAYS_TO_EPOCH;
+    int64_t era = floor_div(days, DAYS_PER_ERA);
+    int64_t day_of_era = days - era * DAYS_PER_ERA;                         // 0-146096
+    int64_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    int64_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    int64_t month_index = (5 * day_of_year + 2) / 153;                      // 0 = March
+    uint8_t m = (uint8_t)(month_index < 10 ? month_index + 3 : month_index - 9);
+
+    *date = (uint8_t)(day_of_year - (153 * month_index + 2) / 5 + 1);
+    *month = m;
+    *year = (int32_t)(year_of_era + era * 400 + (m <= 2));
+}
+
+uint8_t time_core_weekday(int64_t days) {
+    // 1970-01-01 was a Thursday
+    int64_t wd = (days + 4) % 7;
+    return (uint8_t)(wd < 0 ? wd + 7 : wd);
+}
+
+int64_t time_core_from_rtc(const rtc_time_t* time) {
+    int64_t days = time_core_days_from_civil(2000 + time->year, time->month, time->date);
+    return days * TIME_CORE_SECONDS_PER_DAY + time->hours * 3600 + time->minutes * 60 + time->seconds;
+}
+
+void time_core_to_rtc(int64_t seconds, rtc_time_t* time) {
+    int64_t days = floor_div(seconds, TIME_CORE_SECONDS_PER_DAY);
+    int32_t time_of_day = (int32_t)(seconds - days * TIME_CORE_SECONDS_PER_DAY);
+    int32_t year;
+
+    time_core_civil_from_days(days, &year, &time->month, &time->date);
+    time->year = (uint8_t)(((year - 2000) % 100 + 100) % 100);
+    time->day = time_core_weekday(days) + 1;
+    time->hours = (uint8_t)(time_of_day / 3600);
+    time->minutes = (uint8_t)(time_of_day / 60 % 60);
+    time->seconds = (uint8_t)(time_of_day % 60);
+}
+
+const time_core_zone_t* time_core_find_zone(const char* name) {
+    if (name == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < sizeof(zones) / sizeof(zones[0]); i++) {
+        if (strcmp(zones[i].name, name) == 0) {
+            return &zones[i];
+        }
+    }
+    return NULL;
+}
+
+int64_t time_core_utc_to_local(const time_core_zone_t* zone, int64_t utc, bool* is_dst) {
+    bool dst = in_dst(zone, utc);
+    if (is_dst) {
+        *is_dst = dst;
+    }
+    if (zone == NULL) {
+        return utc;
+    }
+    return utc + (int64_t)(dst ? zone->dst_offset_min : zone->std_offset_min) * 60;
+}
+
+int64_t time_core_local_to_utc(const time_core_zone_t* zone, int64_t local) {
+    if (zone == NULL) {
+        return local;
+    }
+    // Prefer the daylight reading: it is the first of two candidates in the repeated hour
+    int64_t as_dst = local - (int64_t)zone->dst_offset_min * 60;
+    if (in_dst(zone, as_dst)) {
+        return as_dst;
+    }
+    return local - (int64_t)zone->std_offset_min * 60;
+}
+
+char* time_core_put_two_digits(char* p, uint8_t value) {
+    value %= 100;
+    p[0] = (char)('0' + value / 10);
+    p[1] = (char)('0' + value % 10);
+    return p + 2;
+}
+
+char* time_core_format_time(const rtc_time_t* time, char* buf) {
+    char* p = time_core_put_two_digits(buf, time->hours);
+    *p++ = ':';
+    p = time_core_put_two_digits(p, time->minutes);
+    *p++ = ':';
+    p = time_core_put_two_digits(p, time->seconds);
+    *p = '\0';
+    return buf;
+}
+
+char* time_core_format_date(const rtc_time_t* time, char* buf) {
+    char* p = time_core_put_two_digits(buf, time->date);
+    *p++ = '/';
+    p = time_core_put_two_digits(p, time->month);
+    *p++ = '/';
+    p = time_core_put_two_digits(p, 20);
+    p = time_core_put_two_digits(p, time->year);
+    *p = '\0';
+    return buf;
+}
+
+// --- Private Functions ---
+
+static int64_t floor_div(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+// Local seconds of a rule's change in the given year
+static int64_t rule_local_seconds(const time_core_rule_t* rule, int32_t year) {
+    int64_t first = time_core_days_from_civil(year, rule->month, 1);
+    int64_t day = first + (rule->weekday + 7 - time_core_weekday(first)) % 7;
+    if (rule->week >= 5) {
+        int64_t next_month = rule->month == 12 ? time_core_days_from_civil(year + 1, 1, 1)
+                                               : time_core_days_from_civil(year, rule->month + 1, 1);
+        day += 7 * ((next_month - 1 - day) / 7);
+    } else {
+        day += 7 * (rule->week - 1);
+    }
+    return day * TIME_CORE_SECONDS_PER_DAY + rule->hour * 3600;
+}
+
+static bool in_dst(const time_core_zone_t* zone, int64_t utc) {
+    if (zone == NULL || zone->dst_offset_min == zone->std_offset_min) {
+        return false;
+    }
+    int64_t std_offset = (int64_t)zone->std_offset_min * 60;
+    int64_t dst_offset = (int64_t)zone->dst_offset_min * 60;
+    int32_t year;
+    uint8_t month, date;
+    time_core_civil_from_days(floor_div(utc + std_offset, TIME_CORE_SECONDS_PER_DAY), &year, &month, &date);
+
+    int64_t start = rule_local_seconds(&zone->dst_start, year) - std_offset;
+    int64_t end = rule_local_seconds(&zone->dst_end, year) - dst_offset;
+    if (start < end) {
+        return utc >= start && utc < end;
+    }
+    // Southern hemisphere: daylight time spans the new year
+    return utc >= start || utc < end;
+}
@@ -0,0 +1,128 @@
+#ifndef TIME_CORE_H
+#define TIME_CORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rtc_time.h"
+
+/*
+ * Calendar arithmetic on 64-bit seconds since 1970-01-01 00:00. Pure C with
+ * no hardware or RTOS dependency, no allocation and no loops over years or
+ * months: dates convert with the days-from-civil algorithm, which treats the
+ * year as starting in March so that February's length only matters at the
+ * very end. Valid for the whole proleptic Gregorian calendar; rtc_time_t
+ * limits it to the RTC's 2000-2099.
+ */
+
+#define TIME_CORE_SECONDS_PER_DAY 86400
+
+/**
+ * @brief Buffer size for time_core_format_time(): "HH:MM:SS" and the terminator.
+ */
+#define TIME_CORE_TIME_LEN 9
+
+/**
+ * @brief Buffer size for time_core_format_date(): "DD/MM/YYYY" and the terminator.
+ */
+#define TIME_CORE_DATE_LEN 11
+
+/**
+ * @brief Day of the year on which DST starts or ends, POSIX TZ "Mm.w.d/h" style.
+ */
+typedef struct {
+    uint8_t month;                  /*!< 1-12 */
+    uint8_t week;                   /*!< 1-4 for the nth weekday of the month, 5 for the last one. */
+    uint8_t weekday;                /*!< 0 = Sunday ... 6 = Saturday */
+    uint8_t hour;                   /*!< Local time of the change, in the offset in force before it. */
+} time_core_rule_t;
+
+/**
+ * @brief A timezone: its standard offset and, optionally, when DST applies.
+ */
+typedef struct {
+    const char* name;               /*!< IANA-style name, e.g. "Europe/Berlin". */
+    int16_t std_offset_min;         /*!< Offset from UTC in standard time, minutes east. */
+    int16_t dst_offset_min;         /*!< Offset from UTC in daylight time; equal to std_offset_min when there is no DST. */
+    time_core_rule_t dst_start;
+    time_core_rule_t dst_end;
+} time_core_zone_t;
+
+/**
+ * @brief Days since 1970-01-01 of a Gregorian date. Constant time.
+ */
+int64_t time_core_days_from_civil(int32_t year, uint8_t month, uint8_t date);
+
+/**
+ * @brief Gregorian date of a day count since 1970-01-01. Constant time.
+ */
+void time_core_civil_from_days(int64_t days, int32_t* year, uint8_t* month, uint8_t* date);
+
+/**
+ * @brief Day of the week of a day count since 1970-01-01; 0 = Sunday.
+ */
+uint8_t time_core_weekday(int64_t days);
+
+/**
+ * @brief Seconds since 1970-01-01 00:00 of an RTC time.
+ */
+int64_t time_core_from_rtc(const rtc_time_t* time);
+
+/**
+ * @brief RTC time of a second count, day of the week included.
+ *
+ * The year field only holds 2000-2099; other years wrap modulo 100.
+ */
+void time_core_to_rtc(int64_t seconds, rtc_time_t* time);
+
+/**
+ * @brief Looks a zone up by name in the built-in table.
+ *
+ * @return The zone, or NULL when the name is unknown.
+ */
+const time_core_zone_t* time_core_find_zone(const char* name);
+
+/**
+ * @brief Local time of a UTC instant.
+ *
+ * @param zone Zone to convert to; NULL is UTC.
+ * @param utc Seconds since 1970-01-01 00:00 UTC.
+ * @param is_dst Set to whether daylight time applies; may be NULL.
+ * @return Local seconds since 1970-01-01 00:00.
+ */
+int64_t time_core_utc_to_local(const time_core_zone_t* zone, int64_t utc, bool* is_dst);
+
+/**
+ * @brief UTC instant of a local time.
+ *
+ * A time repeated when DST ends resolves to its first, daylight occurrence; a
+ * time skipped when DST starts is read in standard time and so lands just
+ * after the change.
+ *
+ * @param zone Zone to convert from; NULL is UTC.
+ * @param local Local seconds since 1970-01-01 00:00.
+ * @return Seconds since 1970-01-01 00:00 UTC.
+ */
+int64_t time_core_local_to_utc(const time_core_zone_t* zone, int64_t local);
+
+/**
+ * @brief Writes value % 100 as two digits. Not terminated.
+ *
+ * @return Pointer just past the digits, for chaining.
+ */
+char* time_core_put_two_digits(char* p, uint8_t value);
+
+/**
+ * @brief Writes "HH:MM:SS" to buf, which must hold TIME_CORE_TIME_LEN bytes.
+ *
+ * @return buf
+ */
+char* time_core_format_time(const rtc_time_t* time, char* buf);
+
+/**
+ * @brief Writes "DD/MM/YYYY" to buf, which must hold TIME_CORE_DATE_LEN bytes.
+ *
+ * @return buf
+ */
+char* time_core_format_date(const rtc_time_t* time, char* buf);
+
+#endif // TIME_CORE_H
@@ -0,0 +1,164 @@
+#include "time_sync.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include "rtc_clock.h"
+#include "time_core.h"
+#include <stdlib.h>
+#include <sys/time.h>
+
+static const char *TAG = "TIME_SYNC";
+
+#define SYNC_TASK_STACK_SIZE 3072
+#define SYNC_RETRY_MS 1000          // until the first SQW edge
+
+// Each comparison moves the estimate a quarter of the way to the new slope;
+// slopes further than this from the estimate are taken for glitches
+#define DRIFT_FILTER_WEIGHT 4
+#define DRIFT_OUTLIER_PPM 200.0f
+
+// --- Private Module State ---
+static time_sync_config_t sync_config;
+static TaskHandle_t sync_task_handle = NULL;
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static time_sync_stats_t stats;
+
+// Only touched by the sync task
+static int64_t slewed_us;           // sum of the adjtime() corrections actually applied
+static uint32_t slopes;             // drift slopes measured so far
+static bool have_reference;
+static int64_t reference_edge_us;
+static int64_t reference_free_offset_us;
+
+// --- Forward Declarations ---
+static void sync_task(void* arg);
+static void compare_clocks(void);
+static int64_t timeval_to_us(const struct timeval* tv);
+static struct timeval us_to_timeval(int64_t us);
+
+// --- Public API Implementation ---
+
+esp_err_t time_sync_start(const time_sync_config_t* config) {
+    if (config == NULL || config->interval_s == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (sync_task_handle != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    sync_config = *config;
+
+    // Good to a second until the first edge pins the phase
+    rtc_time_t now;
+    esp_err_t err = rtc_clock_get_time(&now);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read RTC: %s", esp_err_to_name(err));
+        return err;
+    }
+    struct timeval tv = { .tv_sec = (time_t)time_core_from_rtc(&now), .tv_usec = 0 };
+    settimeofday(&tv, NULL);
+
+    if (xTaskCreate(sync_task, "time_sync", SYNC_TASK_STACK_SIZE, NULL, config->task_priority,
+                    &sync_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create sync task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "System clock seeded from RTC, compared every %lus", (unsigned long)config->interval_s);
+    return ESP_OK;
+}
+
+esp_err_t time_sync_get_stats(time_sync_stats_t* out) {
+    if (out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    taskENTER_CRITICAL(&stats_lock);
+    *out = stats;
+    taskEXIT_CRITICAL(&stats_lock);
+    return ESP_OK;
+}
+
+// --- Private Functions ---
+
+static void sync_task(void* arg) {
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(stats.synced ? sync_config.interval_s * 1000 : SYNC_RETRY_MS));
+        compare_clocks();
+    }
+}
+
+static void compare_clocks(void) {
+    rtc_time_t rtc_time;
+    int64_t edge_us;
+    if (rtc_clock_get_edge(&rtc_time, &edge_us) != ESP_OK) {
+        ESP_LOGD(TAG, "No SQW edge yet");
+        return;
+    }
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    int64_t since_edge_us = esp_timer_get_time() - edge_us;
+    int64_t system_us = timeval_to_us(&tv);
+    int64_t offset_us = system_us - since_edge_us - time_core_from_rtc(&rtc_time) * 1000000;
+
+    time_sync_stats_t next;
+    time_sync_get_stats(&next);
+    next.comparisons++;
+    next.last_offset_us = offset_us;
+
+    if (!next.synced || llabs(offset_us) > (int64_t)sync_config.max_slew_ms * 1000) {
+        // First edge, or the RTC was set: nothing to slew from
+        tv = us_to_timeval(system_us - offset_us);
+        settimeofday(&tv, NULL);
+        next.last_correction_us = -offset_us;
+        next.steps++;
+        next.synced = true;
+        slewed_us = 0;
+        have_reference = false;
+        ESP_LOGI(TAG, "System clock stepped by %lld us", (long long)-offset_us);
+    } else {
+        // A slew still running only counts for the part already applied
+        struct timeval unapplied;
+        if (adjtime(NULL, &unapplied) == 0) {
+            slewed_us -= timeval_to_us(&unapplied);
+        }
+
+        // The offset the clock would show had it never been corrected grows at the drift rate
+        int64_t free_offset_us = offset_us - slewed_us;
+        if (have_reference && edge_us > reference_edge_us) {
+            float slope_ppm = (float)(free_offset_us - reference_free_offset_us) * 1e6f /
+                              (float)(edge_us - reference_edge_us);
+            if (slopes++ == 0) {
+                next.drift_ppm = slope_ppm;
+            } else if (slope_ppm - next.drift_ppm < DRIFT_OUTLIER_PPM &&
+                       next.drift_ppm - slope_ppm < DRIFT_OUTLIER_PPM) {
+                next.drift_ppm += (slope_ppm - next.drift_ppm) / DRIFT_FILTER_WEIGHT;
+            } else {
+                ESP_LOGW(TAG, "Ignoring a %.1f ppm slope", slope_ppm);
+            }
+        }
+        reference_edge_us = edge_us;
+        reference_free_offset_us = free_offset_us;
+        have_reference = true;
+
+        // Aim at zero offset halfway to the next comparison
+        int64_t correction_us = -offset_us -
+            (int64_t)(next.drift_ppm * (float)sync_config.interval_s * 0.5f);
+        struct timeval delta = us_to_timeval(correction_us);
+        if (adjtime(&delta, NULL) == 0) {
+            slewed_us += correction_us;
+        }
+        next.last_correction_us = correction_us;
+    }
+
+    taskENTER_CRITICAL(&stats_lock);
+    stats = next;
+    taskEXIT_CRITICAL(&stats_lock);
+}
+
+static int64_t timeval_to_us(const struct timeval* tv) {
+    return (int64_t)tv->tv_sec * 1000000 + tv->tv_usec;
+}
+
+static struct timeval us_to_timeval(int64_t us) {
+    struct timeval tv = { .tv_sec = (time_t)(us / 1000000), .tv_usec = (suseconds_t)(us % 1000000) };
+    return tv;
+}
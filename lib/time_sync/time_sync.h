@@ -0,0 +1,55 @@
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+/**
+ * @brief Configuration for the RTC-to-system-clock service.
+ */
+typedef struct {
+    uint32_t interval_s;            /*!< Seconds between clock comparisons. */
+    uint32_t max_slew_ms;           /*!< Larger offsets are stepped instead of slewed. */
+    UBaseType_t task_priority;      /*!< Priority of the sync task. */
+} time_sync_config_t;
+
+/**
+ * @brief State of the service, for diagnostics.
+ */
+typedef struct {
+    bool synced;                    /*!< The system clock has been pinned to an SQW edge. */
+    float drift_ppm;                /*!< Filtered rate of the system clock against the RTC; positive when it runs fast. */
+    int64_t last_offset_us;         /*!< System clock minus RTC at the last comparison. */
+    int64_t last_correction_us;     /*!< Adjustment made after the last comparison. */
+    uint32_t comparisons;
+    uint32_t steps;                 /*!< Corrections made with settimeofday() rather than slewed. */
+} time_sync_stats_t;
+
+/**
+ * @brief Seeds the system clock from the RTC and starts keeping it in step.
+ *
+ * The system clock (gettimeofday()) is set to UTC from rtc_clock_get_time()
+ * at once, then pinned to the first SQW edge seen by rtc_clock. Every
+ * interval_s the two clocks are compared at an edge, again without bus
+ * traffic, and the system clock is slewed with adjtime() towards where it
+ * should be halfway to the next comparison, drift included, so it never
+ * jumps backwards. The drift is the slope of the offset the system clock
+ * would have had without the corrections, smoothed by an exponential filter.
+ * Offsets above max_slew_ms, as after rtc_clock_set_time(), are stepped.
+ * Readers then get the time from gettimeofday() in microseconds.
+ *
+ * rtc_clock_start() must have been called.
+ *
+ * @param config Pointer to the sync configuration.
+ * @return ESP_OK on success, or an error code on failure.
+ */
+esp_err_t time_sync_start(const time_sync_config_t* config);
+
+/**
+ * @brief Reads the drift estimate and the last correction.
+ */
+esp_err_t time_sync_get_stats(time_sync_stats_t* stats);
+
+#endif // TIME_SYNC_H
@@ -1,12 +1,25 @@
 #include <stdio.h>
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "i2c_bus.h"
 #include "ds1307.h"
 #include "lcd_i2c.h"
 #include "button_reader.h"
 #include "rotary_encoder.h"
+#include "input_dispatcher.h"
+#include "display_server.h"
+#include "big_digits.h"
+#include "rtc_clock.h"
+#include "time_core.h"
+#include "time_sync.h"
+#include "alarm_store.h"
+#include "alarm_scheduler.h"
+#include "diagnostics.h"
+#include "event_trace.h"
+#include "power_manager.h"
 
 static const char *TAG = "APP_MAIN";
 
@@ -14,6 +27,7 @@ static const char *TAG = "APP_MAIN";
 #define I2C_MASTER_SCL_IO   22
 #define I2C_MASTER_SDA_IO   21
 #define I2C_MASTER_NUM      I2C_NUM_0
+#define I2C_MASTER_FREQ_HZ  100000 // DS1307 is limited to 100 kHz
 
 #define LCD_COLS 16
 #define LCD_ROWS 4
@@ -22,9 +36,34 @@ static const char *TAG = "APP_MAIN";
 #define BUTTON_B_GPIO GPIO_NUM_26
 #define BUTTON_C_GPIO GPIO_NUM_27
 
+#define RTC_SQW_GPIO GPIO_NUM_4
+#define RTC_RESYNC_INTERVAL_S 3600
+#define TIME_SYNC_INTERVAL_S 30
+#define TIME_SYNC_MAX_SLEW_MS 500
+#define TIME_ZONE "UTC" // the RTC keeps UTC; the face and the alarms follow this zone, DST included
+
 #define ROTARY_CLK_GPIO GPIO_NUM_19
 #define ROTARY_DT_GPIO  GPIO_NUM_18
 #define ROTARY_SW_GPIO  GPIO_NUM_23
+#define ENCODER_FAST_STEPS_PER_S 40.0f // above this the count moves ENCODER_FAST_MULTIPLIER per step
+#define ENCODER_FAST_MULTIPLIER  5
+
+// Holding B and C together toggles the diagnostics page
+#define DIAG_CHORD_HOLD_MS 2000
+#define DIAG_SAMPLE_INTERVAL_US 1000000
+
+// Bursts of changes, e.g. a spinning encoder, are drawn at most this often
+#define DISPLAY_FRAME_BUDGET_MS 30
+#define DISPLAY_MARQUEE_STEP_MS 300
+
+#define TRACE_RECORDS_PER_CORE 256
+#define TRACE_DRAIN_INTERVAL_MS 100
+
+// Light sleep between events. The encoder's quadrature edges come faster than
+// the chip wakes up, so it stays awake for a while once the knob moves.
+#define PM_MAX_FREQ_MHZ 240
+#define PM_MIN_FREQ_MHZ 40
+#define ENCODER_AWAKE_MS 1000
 
 // --- Button Context ---
 typedef struct {
@@ -32,128 +71,399 @@ typedef struct {
 } button_context_t;
 
 // --- Global Handles & State ---
-static SemaphoreHandle_t lcd_mutex;
+// Input state is written only on the input dispatcher task; volatile because
+// render_status() reads it from the display server task.
 static volatile int32_t encoder_count = 0;
 static volatile char g_current_button_pressed = ' ';
+static alarm_record_t g_alarms[ALARM_STORE_MAX_ALARMS];
+
+// Alarm ids in the scheduler match the alarm_store index
+static alarm_scheduler_handle_t g_scheduler;
+static SemaphoreHandle_t g_alarm_mutex;
+static volatile int g_ringing_alarm = -1;
+static const time_core_zone_t* g_zone;
+// Next alarm handed to the RTC chip, in local seconds; -1 for none
+static int64_t g_rtc_alarm_armed = -1;
+static bool g_rtc_alarm_offload = true; // cleared when the chip has no alarm
+
+// Diagnostics page: toggled on the dispatcher task, sampled and drawn on the
+// display server task, which alone touches g_diag_snapshot.
+static volatile bool g_diag_page = false;
+static volatile bool g_diag_opened = false;
+static volatile int32_t g_diag_scroll = 0;
+static diagnostics_snapshot_t g_diag_snapshot;
+
+// Per-input log lines go through the trace buffer so they never wait on the
+// UART. The tag has to be a literal here; it matches TAG.
+EVENT_TRACE_DEFINE(trace_encoder, "APP_MAIN", ESP_LOG_DEBUG, "Encoder count: %ld (delta %ld)");
+EVENT_TRACE_DEFINE(trace_encoder_reset, "APP_MAIN", ESP_LOG_INFO, "Rotary switch pressed, resetting count.");
+EVENT_TRACE_DEFINE(trace_button_pressed, "APP_MAIN", ESP_LOG_INFO, "Button %c pressed.");
+EVENT_TRACE_DEFINE(trace_button_released, "APP_MAIN", ESP_LOG_INFO, "Button %c released.");
+
+// --- Helpers ---
+
+// Local time for a UTC time read from the RTC, as fields and as seconds since 1970-01-01
+static int64_t to_local(const rtc_time_t* utc, rtc_time_t* local) {
+    int64_t seconds = time_core_utc_to_local(g_zone, time_core_from_rtc(utc), NULL);
+    time_core_to_rtc(seconds, local);
+    return seconds;
+}
+
+// Logs the share of time spent in light sleep between two samples
+static void log_sleep_stats(const power_manager_stats_t* from, const power_manager_stats_t* to) {
+    int64_t span_us = to->uptime_us - from->uptime_us;
+    if (span_us <= 0) {
+        return;
+    }
+    int64_t permille = (to->asleep_us - from->asleep_us) * 1000 / span_us;
+    ESP_LOGI(TAG, "Asleep %lld.%lld%% of the last %lld s (%lu sleeps)", permille / 10, permille % 10,
+             span_us / 1000000, (unsigned long)(to->sleeps - from->sleeps));
+}
+
+// Logs the input-to-pixel latency histogram kept by the display server
+static void log_display_latency(void) {
+    display_server_stats_t stats;
+    if (display_server_get_stats(&stats) != ESP_OK || stats.input_frames == 0) {
+        return;
+    }
+    ESP_LOGI(TAG, "%lu frames, %lu after input: mean %llu us, worst %lu us", (unsigned long)stats.frames,
+             (unsigned long)stats.input_frames, stats.total_latency_us / stats.input_frames,
+             (unsigned long)stats.max_latency_us);
+    for (int i = 0; i < DISPLAY_SERVER_LATENCY_BUCKETS; i++) {
+        if (stats.latency_buckets[i] == 0) {
+            continue;
+        }
+        uint32_t low_ms = i == 0 ? 0 : 1u << (i - 1);
+        if (i == DISPLAY_SERVER_LATENCY_BUCKETS - 1) {
+            ESP_LOGI(TAG, "  >= %lu ms: %lu", (unsigned long)low_ms, (unsigned long)stats.latency_buckets[i]);
+        } else {
+            ESP_LOGI(TAG, "  %lu-%lu ms: %lu", (unsigned long)low_ms, (unsigned long)(1u << i),
+                     (unsigned long)stats.latency_buckets[i]);
+        }
+    }
+}
+
+// Logs how far the system clock drifts from the RTC and the last correction
+static void log_time_sync(void) {
+    time_sync_stats_t stats;
+    if (time_sync_get_stats(&stats) != ESP_OK || !stats.synced) {
+        return;
+    }
+    ESP_LOGI(TAG, "System clock %+.2f ppm against RTC; last offset %lld us, correction %lld us (%lu steps)",
+             stats.drift_ppm, (long long)stats.last_offset_us, (long long)stats.last_correction_us,
+             (unsigned long)stats.steps);
+}
+
+static int64_t local_now(void) {
+    rtc_time_t now, local;
+    rtc_clock_get_time(&now);
+    return to_local(&now, &local);
+}
+
+// Keeps the RTC chip's alarm on the head of the alarm heap, so it could wake
+// the clock task even with the ticks off. Called with g_alarm_mutex held.
+static void arm_rtc_alarm(void) {
+    int64_t when;
+    int id;
+    if (!g_rtc_alarm_offload) {
+        return;
+    }
+    if (!alarm_scheduler_peek(g_scheduler, &when, &id)) {
+        when = -1;
+    }
+    if (when == g_rtc_alarm_armed) {
+        return;
+    }
+
+    esp_err_t err;
+    if (when < 0) {
+        err = rtc_clock_cancel_alarm();
+    } else {
+        rtc_time_t utc;
+        time_core_to_rtc(time_core_local_to_utc(g_zone, when), &utc);
+        err = rtc_clock_set_alarm(&utc);
+    }
+    if (err == ESP_ERR_NOT_SUPPORTED) {
+        ESP_LOGI(TAG, "RTC has no alarm, checking alarms on every tick.");
+        g_rtc_alarm_offload = false;
+    } else if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to arm RTC alarm: %s", esp_err_to_name(err)); // retried on the next tick
+    } else {
+        g_rtc_alarm_armed = when;
+    }
+}
+
+// Lines 1-2: HH:MM in big digits with the seconds beside them, line 3: date.
+// The display server only sends the cells that actually changed, and the
+// glyph cache only reprograms CGRAM when a new digit shape appears.
+static void put_clock_lines(const rtc_time_t* time) {
+    char line[TIME_CORE_DATE_LEN];
+    big_digits_draw_time(0, 0, time->hours, time->minutes);
+    display_server_put_text(0, BIG_DIGITS_TIME_COLS, "   ");
+    line[0] = ' ';
+    *time_core_put_two_digits(&line[1], time->seconds) = '\0';
+    display_server_put_text(1, BIG_DIGITS_TIME_COLS, line);
+    display_server_put_line(2, time_core_format_date(time, line));
+}
+
+// Runs on the display server task. Samples at most once per interval so that
+// redraws from the encoder do not add to the cost.
+static void render_diagnostics(void) {
+    static int64_t last_sample_us;
+    static bool dump_due = false;
+    int64_t now = esp_timer_get_time();
+    if (g_diag_opened) {
+        // The page may have been closed for longer than the 32-bit run-time
+        // counters last, so start from a fresh baseline and log the first
+        // full interval after it
+        g_diag_opened = false;
+        diagnostics_sample(I2C_MASTER_NUM, &g_diag_snapshot);
+        last_sample_us = now;
+        dump_due = true;
+    } else if (now - last_sample_us >= DIAG_SAMPLE_INTERVAL_US) {
+        diagnostics_sample(I2C_MASTER_NUM, &g_diag_snapshot);
+        last_sample_us = now;
+        if (dump_due) {
+            dump_due = false;
+            diagnostics_log_report(&g_diag_snapshot);
+        }
+    }
+
+    // The encoder scrolls through the lines, wrapping around at the end
+    int32_t count = (int32_t)diagnostics_line_count(&g_diag_snapshot);
+    int32_t first = ((g_diag_scroll % count) + count) % count;
+    char line[LCD_COLS + 1];
+    for (uint8_t row = 0; row < LCD_ROWS; row++) {
+        line[0] = '\0';
+        if (row < count) {
+            diagnostics_format_line(&g_diag_snapshot, (first + row) % count, line, sizeof(line));
+        }
+        lcd_i2c_fb_write_line(row, line);
+    }
+}
 
 // --- Tasks and Callbacks ---
 
+// Input callbacks redraw through here so the display server can time input-to-pixel
+static void request_input_redraw(void) {
+    display_server_note_input(input_dispatcher_event_time());
+    display_server_request_redraw();
+}
+
+
 void on_rotation_event(rotary_encoder_handle_t handle, const rotary_encoder_event_t* event, void* user_data) {
-    if (*event == ROTARY_ENCODER_EVENT_CLOCKWISE) {
-        encoder_count++;
-    } else {
-        encoder_count--;
+    power_manager_keep_awake(ENCODER_AWAKE_MS);
+    if (g_diag_page) {
+        g_diag_scroll += event->delta;
+        request_input_redraw();
+        return;
     }
-    ESP_LOGI(TAG, "Encoder count: %ld", encoder_count);
+
+    // Spinning the knob hard scrolls faster
+    float speed = event->velocity < 0 ? -event->velocity : event->velocity;
+    int32_t scale = speed > ENCODER_FAST_STEPS_PER_S ? ENCODER_FAST_MULTIPLIER : 1;
+    encoder_count += event->delta * scale;
+    event_trace_write(&trace_encoder, encoder_count, event->delta);
+    request_input_redraw();
 }
 
 void on_sw_button_event(button_handle_t handle, button_event_t event, void* user_data) {
     if (event == BUTTON_EVENT_PRESS) {
-        ESP_LOGI(TAG, "Rotary switch pressed, resetting count.");
+        event_trace_write(&trace_encoder_reset, 0, 0);
         encoder_count = 0;
+        request_input_redraw();
+    }
+}
+
+// Button A snoozes and button B dismisses a ringing alarm
+static bool handle_alarm_button(char button_label) {
+    int ringing = g_ringing_alarm;
+    if (ringing < 0 || (button_label != 'A' && button_label != 'B')) {
+        return false;
     }
+
+    xSemaphoreTake(g_alarm_mutex, portMAX_DELAY);
+    if (button_label == 'A' && alarm_scheduler_snooze(g_scheduler, ringing, local_now())) {
+        ESP_LOGI(TAG, "Alarm %d snoozed.", ringing);
+    } else {
+        alarm_scheduler_dismiss(g_scheduler, ringing, local_now());
+        ESP_LOGI(TAG, "Alarm %d dismissed.", ringing);
+    }
+    g_ringing_alarm = -1;
+    arm_rtc_alarm();
+    xSemaphoreGive(g_alarm_mutex);
+    display_server_clear_marquee(3);
+    return true;
 }
 
 void on_general_button_event(button_handle_t handle, button_event_t event, void* user_data) {
     char button_label = *(char*)user_data;
     if (event == BUTTON_EVENT_PRESS) {
-        ESP_LOGI(TAG, "Button %c pressed.", button_label);
+        event_trace_write(&trace_button_pressed, button_label, 0);
+        handle_alarm_button(button_label);
         g_current_button_pressed = button_label;
     } else if (event == BUTTON_EVENT_RELEASE) {
-        ESP_LOGI(TAG, "Button %c released.", button_label);
+        event_trace_write(&trace_button_released, button_label, 0);
         if (g_current_button_pressed == button_label) {
             g_current_button_pressed = ' '; // Clear if this was the last button pressed
         }
     }
+    request_input_redraw();
 }
 
-void read_time_task(void *pvParameters) {
-    char time_str[16];
-    char date_str[16];
-    char button_str[16];
-    char encoder_str[16];
-
-    static char prev_date_str[16] = {0};
-    static char prev_button_str[16] = {0};
-    static char prev_encoder_str[16] = {0};
-
-    while (1) {
-        if (xSemaphoreTake(lcd_mutex, portMAX_DELAY) == pdTRUE) {
-            // Display Time on Line 1 (always update as seconds change frequently)
-            rtc_time_t time;
-            if (ds1307_get_time(&time) == ESP_OK) {
-                sprintf(time_str, "%02d:%02d:%02d", time.hours, time.minutes, time.seconds);
-                lcd_i2c_set_cursor(0, 0);
-                lcd_i2c_send_string("                "); // Clear line
-                lcd_i2c_set_cursor(0, 0);
-                lcd_i2c_send_string(time_str);
-
-                // Display Date on Line 2 (update only if changed)
-                sprintf(date_str, "%02d/%02d/%04d", time.date, time.month, time.year + 2000);
-                if (strcmp(date_str, prev_date_str) != 0) {
-                    lcd_i2c_set_cursor(1, 0);
-                    lcd_i2c_send_string("                "); // Clear line
-                    lcd_i2c_set_cursor(1, 0);
-                    lcd_i2c_send_string(date_str);
-                    strcpy(prev_date_str, date_str);
-                }
-            }
-
-            // Display Button Status on Line 3 (update only if changed)
-            char current_button_display[16];
-            if (g_current_button_pressed != ' ') {
-                sprintf(current_button_display, "Button: %c", g_current_button_pressed);
-            } else {
-                sprintf(current_button_display, "Button: None");
-            }
-            if (strcmp(current_button_display, prev_button_str) != 0) {
-                lcd_i2c_set_cursor(2, 0);
-                lcd_i2c_send_string("                "); // Clear line
-                lcd_i2c_set_cursor(2, 0);
-                lcd_i2c_send_string(current_button_display);
-                strcpy(prev_button_str, current_button_display);
-            }
-
-            // Display Encoder Count on Line 4 (update only if changed)
-            sprintf(encoder_str, "Encoder: %ld", encoder_count);
-            if (strcmp(encoder_str, prev_encoder_str) != 0) {
-                lcd_i2c_set_cursor(3, 0);
-                lcd_i2c_send_string("                "); // Clear line
-                lcd_i2c_set_cursor(3, 0);
-                lcd_i2c_send_string(encoder_str);
-                strcpy(prev_encoder_str, encoder_str);
-            }
-
-            xSemaphoreGive(lcd_mutex);
+void on_diag_chord(button_chord_handle_t chord, void* user_data) {
+    if (g_ringing_alarm >= 0) {
+        return; // B is busy dismissing the alarm
+    }
+    if (g_diag_page) {
+        ESP_LOGI(TAG, "Diagnostics page closed.");
+        g_diag_page = false;
+        rtc_time_t now, local;
+        rtc_clock_get_time(&now);
+        to_local(&now, &local);
+        put_clock_lines(&local);
+    } else {
+        ESP_LOGI(TAG, "Diagnostics page opened.");
+        power_manager_stats_t boot = {0}, now;
+        if (power_manager_get_stats(&now) == ESP_OK) {
+            log_sleep_stats(&boot, &now);
         }
-        vTaskDelay(500 / portTICK_PERIOD_MS); // Update display twice a second
+        log_display_latency();
+        log_time_sync();
+        g_diag_scroll = 0;
+        g_diag_opened = true; // the first full sample also goes to the log
+        g_diag_page = true;
     }
+    request_input_redraw();
+}
+
+// Runs on the display server task: redraws the input status line from the
+// model. Lines 1-3 are left alone: the clock queues all of them again every
+// second, which also repairs any of its draws dropped by a full queue.
+void render_status(void* user_data) {
+    if (g_diag_page) {
+        render_diagnostics();
+        return;
+    }
+
+    char line[LCD_COLS + 1];
+
+    // Line 4: button status and encoder count; a ringing alarm's marquee owns the line
+    if (g_ringing_alarm >= 0) {
+        return;
+    }
+    char button = g_current_button_pressed != ' ' ? g_current_button_pressed : '-';
+    snprintf(line, sizeof(line), "Btn %c  Enc %ld", button, encoder_count);
+    lcd_i2c_fb_write_line(3, line);
+}
+
+// Called from alarm_scheduler_poll() with g_alarm_mutex held
+void on_alarm_fired(int id, int64_t when, void* user_data) {
+    ESP_LOGI(TAG, "Alarm %d fired.", id);
+    g_ringing_alarm = id;
+    g_diag_page = false; // a ringing alarm takes over the screen
+    char message[DISPLAY_SERVER_MAX_MARQUEE_TEXT];
+    snprintf(message, sizeof(message), "Alarm %d ringing - A: snooze, B: dismiss", id + 1);
+    display_server_set_marquee(3, message);
+
+    // One-shot alarms disable themselves when they fire; persist that
+    alarm_def_t def;
+    if (alarm_scheduler_get(g_scheduler, id, &def) && !def.enabled && g_alarms[id].enabled) {
+        g_alarms[id].enabled = false;
+        alarm_store_save(id, &g_alarms[id]);
+    }
+    display_server_request_redraw();
+}
+
+// Called by rtc_clock once per second, in phase with the RTC
+void on_clock_tick(const rtc_time_t* utc, void* user_data) {
+    rtc_time_t local;
+    int64_t now = to_local(utc, &local);
+
+    // Only the head of the alarm heap is compared against the current time
+    xSemaphoreTake(g_alarm_mutex, portMAX_DELAY);
+    alarm_scheduler_poll(g_scheduler, now, on_alarm_fired, NULL);
+    arm_rtc_alarm();
+    xSemaphoreGive(g_alarm_mutex);
+
+    // Hourly report of the time spent asleep
+    if (local.minutes == 0 && local.seconds == 0) {
+        static power_manager_stats_t last_hour;
+        power_manager_stats_t now;
+        if (power_manager_get_stats(&now) == ESP_OK) {
+            log_sleep_stats(&last_hour, &now);
+            last_hour = now;
+        }
+    }
+
+    // The diagnostics page owns the whole screen and refreshes with the clock
+    if (g_diag_page) {
+        display_server_request_redraw();
+        return;
+    }
+    put_clock_lines(&local);
+}
+
+// Called by rtc_clock when the chip's alarm pulls its pin; with ticks every
+// second on_clock_tick() gets there first and this finds nothing due
+void on_rtc_alarm(void* user_data) {
+    int64_t now = local_now();
+    xSemaphoreTake(g_alarm_mutex, portMAX_DELAY);
+    alarm_scheduler_poll(g_scheduler, now, on_alarm_fired, NULL);
+    arm_rtc_alarm();
+    xSemaphoreGive(g_alarm_mutex);
 }
 
 void app_main(void)
 {
     ESP_LOGI(TAG, "Initializing application...");
 
-    lcd_mutex = xSemaphoreCreateMutex();
+    // Start tracing first so every driver below can use it
+    event_trace_config_t trace_conf = {
+        .records_per_core = TRACE_RECORDS_PER_CORE,
+        .drain_interval_ms = TRACE_DRAIN_INTERVAL_MS,
+        .task_priority = 1,
+    };
+    esp_err_t err = event_trace_start(&trace_conf);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to start event trace: %s", esp_err_to_name(err));
+    }
 
-    // 1. Configure and initialize I2C bus for RTC
-    ds1307_config_t ds1307_conf = {
+    // 1. Configure and initialize the shared I2C bus and the RTC on it
+    i2c_bus_config_t bus_conf = {
         .i2c_port = I2C_MASTER_NUM,
         .sda_pin = I2C_MASTER_SDA_IO,
         .scl_pin = I2C_MASTER_SCL_IO,
+        .clk_speed = I2C_MASTER_FREQ_HZ,
+    };
+    err = i2c_bus_init(&bus_conf);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize I2C bus: %s", esp_err_to_name(err));
+        return;
+    }
+
+    ds1307_config_t ds1307_conf = {
+        .i2c_port = I2C_MASTER_NUM,
     };
-    esp_err_t err = ds1307_init(&ds1307_conf);
+    err = ds1307_init(&ds1307_conf);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize DS1307: %s", esp_err_to_name(err));
         return;
     }
 
+    // Alarms live in the RTC's battery-backed NVRAM: one burst read at boot
+    err = alarm_store_load(g_alarms);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to load alarms: %s", esp_err_to_name(err));
+    }
+
     // 2. Configure and initialize LCD
     lcd_i2c_config_t lcd_conf = {
         .i2c_port = I2C_MASTER_NUM,
         .i2c_address = LCD_I2C_DEFAULT_ADDRESS,
         .cols = LCD_COLS,
         .rows = LCD_ROWS,
+        .read_busy_flag = true, // the backpack drives RW from P1
     };
     err = lcd_i2c_init(&lcd_conf);
     if (err != ESP_OK) {
@@ -161,11 +471,47 @@ void app_main(void)
         return;
     }
 
+    // From here on the display server is the only owner of the LCD
+    display_server_config_t display_conf = {
+        .queue_size = 16,
+        .task_priority = 5,
+        .render_cb = render_status,
+        .user_data = NULL,
+        .frame_budget_ms = DISPLAY_FRAME_BUDGET_MS,
+        .marquee_step_ms = DISPLAY_MARQUEE_STEP_MS,
+    };
+    err = display_server_start(&display_conf);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start display server: %s", esp_err_to_name(err));
+        return;
+    }
+    err = big_digits_init();
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to load the big-digit font: %s", esp_err_to_name(err));
+    }
+
+    // All input callbacks below run in order on the dispatcher task
+    input_dispatcher_config_t input_conf = {
+        .queue_size = 16,
+        .task_priority = 5,
+    };
+    err = input_dispatcher_start(&input_conf);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start input dispatcher: %s", esp_err_to_name(err));
+        return;
+    }
+
     // 3. Initialize Rotary Encoder
+    // An enabled PCNT unit holds an APB frequency lock, which rules out light
+    // sleep; with power management on, the GPIO edges are decoded instead.
     rotary_encoder_config_t rotary_conf = {
         .clk_pin = ROTARY_CLK_GPIO,
         .dt_pin = ROTARY_DT_GPIO,
-        .queue_size = 8,
+#if CONFIG_PM_ENABLE
+        .backend = ROTARY_ENCODER_BACKEND_GPIO,
+#else
+        .backend = ROTARY_ENCODER_BACKEND_PCNT,
+#endif
     };
     rotary_encoder_handle_t rotary_handle = rotary_encoder_create(&rotary_conf);
     rotary_encoder_register_callback(rotary_handle, on_rotation_event, NULL);
@@ -175,6 +521,7 @@ void app_main(void)
         .gpio_num = ROTARY_SW_GPIO,
         .active_level = 0, // Assuming pull-up, active low
         .long_press_ms = 0,
+        .mode = BUTTON_MODE_INTERRUPT,
         .user_data = NULL
     };
     button_handle_t sw_btn = button_create(&sw_btn_conf);
@@ -186,6 +533,7 @@ void app_main(void)
         .gpio_num = BUTTON_A_GPIO,
         .active_level = 0,
         .long_press_ms = 0,
+        .mode = BUTTON_MODE_INTERRUPT,
         .user_data = &btn_a_label
     };
     button_handle_t btn_a = button_create(&btn_a_conf);
@@ -197,6 +545,7 @@ void app_main(void)
         .gpio_num = BUTTON_B_GPIO,
         .active_level = 0,
         .long_press_ms = 0,
+        .mode = BUTTON_MODE_INTERRUPT,
         .user_data = &btn_b_label
     };
     button_handle_t btn_b = button_create(&btn_b_conf);
@@ -208,17 +557,100 @@ void app_main(void)
         .gpio_num = BUTTON_C_GPIO,
         .active_level = 0,
         .long_press_ms = 0,
+        .mode = BUTTON_MODE_INTERRUPT,
         .user_data = &btn_c_label
     };
     button_handle_t btn_c = button_create(&btn_c_conf);
     button_register_callback(btn_c, on_general_button_event);
 
-    ESP_LOGI(TAG, "All components initialized. Starting display task.");
-    if (xSemaphoreTake(lcd_mutex, portMAX_DELAY) == pdTRUE) {
-        lcd_i2c_clear();
-        lcd_i2c_set_cursor(0, 2);
-        lcd_i2c_send_string("Clock Ready");
-        xSemaphoreGive(lcd_mutex);
+    // 8. Hidden diagnostics page: hold B and C
+    button_chord_config_t diag_chord_conf = {
+        .buttons = { btn_b, btn_c },
+        .num_buttons = 2,
+        .hold_ms = DIAG_CHORD_HOLD_MS,
+        .callback = on_diag_chord,
+        .user_data = NULL,
+    };
+    if (button_chord_create(&diag_chord_conf) == NULL) {
+        ESP_LOGW(TAG, "Failed to create diagnostics chord.");
+    }
+
+    ESP_LOGI(TAG, "All components initialized. Starting clock.");
+    display_server_put_text(0, 2, "Clock Ready");
+    display_server_request_redraw();
+
+    g_zone = time_core_find_zone(TIME_ZONE);
+    if (g_zone == NULL) {
+        ESP_LOGW(TAG, "Unknown time zone %s, showing UTC.", TIME_ZONE);
+    }
+    g_alarm_mutex = xSemaphoreCreateMutex();
+    g_scheduler = alarm_scheduler_create(ALARM_STORE_MAX_ALARMS);
+
+    // The face shows seconds, so the RTC ticks every second
+    rtc_clock_config_t clock_conf = {
+        .device = &ds1307_rtc_device,
+        .sqw_pin = RTC_SQW_GPIO,
+        .tick = RTC_TICK_SECOND,
+        .resync_interval_s = RTC_RESYNC_INTERVAL_S,
+        .task_priority = 5,
+        .tick_cb = on_clock_tick,
+        .alarm_cb = on_rtc_alarm,
+        .user_data = NULL,
+    };
+    xSemaphoreTake(g_alarm_mutex, portMAX_DELAY);
+    err = rtc_clock_start(&clock_conf);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start clock: %s", esp_err_to_name(err));
+    }
+
+    // gettimeofday() then follows the RTC with no bus traffic
+    time_sync_config_t sync_conf = {
+        .interval_s = TIME_SYNC_INTERVAL_S,
+        .max_slew_ms = TIME_SYNC_MAX_SLEW_MS,
+        .task_priority = 4,
+    };
+    err = time_sync_start(&sync_conf);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start time sync: %s", esp_err_to_name(err));
+    }
+
+    // Schedule the stored alarms relative to the time just read from the RTC
+    int64_t now = local_now();
+    for (int i = 0; i < ALARM_STORE_MAX_ALARMS; i++) {
+        alarm_def_t def = {
+            .hour = g_alarms[i].hour,
+            .minute = g_alarms[i].minute,
+            .weekdays = g_alarms[i].weekdays,
+            .enabled = g_alarms[i].enabled,
+            .snooze_minutes = g_alarms[i].snooze_minutes,
+            .snooze_limit = g_alarms[i].snooze_limit,
+        };
+        alarm_scheduler_add(g_scheduler, &def, now);
+    }
+    arm_rtc_alarm();
+    xSemaphoreGive(g_alarm_mutex);
+
+#if CONFIG_PM_ENABLE
+    // Every input that must wake the chip, with the interrupt its driver uses
+    static const power_manager_wake_pin_t wake_pins[] = {
+        { BUTTON_A_GPIO, GPIO_INTR_ANYEDGE },
+        { BUTTON_B_GPIO, GPIO_INTR_ANYEDGE },
+        { BUTTON_C_GPIO, GPIO_INTR_ANYEDGE },
+        { ROTARY_SW_GPIO, GPIO_INTR_ANYEDGE },
+        { ROTARY_CLK_GPIO, GPIO_INTR_ANYEDGE },
+        { ROTARY_DT_GPIO, GPIO_INTR_ANYEDGE },
+        { RTC_SQW_GPIO, GPIO_INTR_NEGEDGE },
+    };
+    power_manager_config_t pm_conf = {
+        .max_freq_mhz = PM_MAX_FREQ_MHZ,
+        .min_freq_mhz = PM_MIN_FREQ_MHZ,
+        .light_sleep = true,
+        .wake_pins = wake_pins,
+        .num_wake_pins = sizeof(wake_pins) / sizeof(wake_pins[0]),
+    };
+    err = power_manager_start(&pm_conf);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Running without power management: %s", esp_err_to_name(err));
     }
-    xTaskCreate(read_time_task, "read_time_task", 2048, NULL, 5, NULL);
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,11 @@
+#ifndef SIM_ESP_ROM_SYS_H
+#define SIM_ESP_ROM_SYS_H
+
+#include <stdint.h>
+
+/**
+ * @brief Busy-waits: simulated time moves on without letting other tasks run.
+ */
+void esp_rom_delay_us(uint32_t us);
+
+#endif // SIM_ESP_ROM_SYS_H
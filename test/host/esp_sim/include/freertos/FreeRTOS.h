@@ -0,0 +1,69 @@
+#ifndef SIM_FREERTOS_H
+#define SIM_FREERTOS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "esp_err.h"
+#include "esp_attr.h"
+
+// Tasks run as coroutines on a single simulated core; see sim.h
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint8_t StackType_t;
+
+#define pdFALSE         ((BaseType_t)0)
+#define pdTRUE          ((BaseType_t)1)
+#define pdFAIL          pdFALSE
+#define pdPASS          pdTRUE
+#define errQUEUE_FULL   ((BaseType_t)0)
+#define errQUEUE_EMPTY  ((BaseType_t)0)
+
+// Same tick rate as sdkconfig.esp32dev
+#define configTICK_RATE_HZ      100
+#define configMAX_PRIORITIES    25
+#define tskIDLE_PRIORITY        0
+#define tskNO_AFFINITY          0x7FFFFFFF
+#define portNUM_PROCESSORS      1
+#define portMAX_DELAY           ((TickType_t)0xFFFFFFFFUL)
+#define portTICK_PERIOD_MS      ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((TickType_t)(ms) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000U))
+#define pdTICKS_TO_MS(ticks)    ((TickType_t)((uint64_t)(ticks) * 1000 / configTICK_RATE_HZ))
+
+// With one core and no time slicing a critical section only has to hold
+// back preemption by tasks woken inside it
+typedef struct {
+    int owner;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED { .owner = 0 }
+#define portMUX_INIT(mux) ((mux)->owner = 0)
+
+void sim_critical_enter(portMUX_TYPE* mux);
+void sim_critical_exit(portMUX_TYPE* mux);
+
+#define taskENTER_CRITICAL(mux)     sim_critical_enter(mux)
+#define taskEXIT_CRITICAL(mux)      sim_critical_exit(mux)
+#define taskENTER_CRITICAL_ISR(mux) sim_critical_enter(mux)
+#define taskEXIT_CRITICAL_ISR(mux)  sim_critical_exit(mux)
+#define portENTER_CRITICAL          taskENTER_CRITICAL
+#define portEXIT_CRITICAL           taskEXIT_CRITICAL
+#define portENTER_CRITICAL_ISR      taskENTER_CRITICAL_ISR
+#define portEXIT_CRITICAL_ISR       taskEXIT_CRITICAL_ISR
+
+// A higher-priority task woken from an ISR runs as soon as the ISR returns
+#define portYIELD_FROM_ISR(woken)   ((void)(woken))
+
+typedef struct {
+    void* opaque[12];
+} StaticSemaphore_t;
+
+typedef StaticSemaphore_t StaticQueue_t;
+
+BaseType_t xPortInIsrContext(void);
+BaseType_t xPortGetCoreID(void);
+
+#endif // SIM_FREERTOS_H
@@ -0,0 +1,231 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/**
+ * Host simulation of the parts of ESP-IDF this project uses.
+ *
+ * FreeRTOS tasks run as coroutines on one simulated core. Time is virtual: it
+ * only moves when every task is blocked (or during esp_rom_delay_us() and I2C
+ * transfers), so a run is deterministic and independent of the host's speed.
+ * Code executes in zero simulated time; bus and delay costs are what the
+ * benchmarks measure.
+ *
+ * The test program itself is not a task. It drives the simulation with
+ * sim_run_for() / sim_run_until(), and may call blocking driver functions
+ * directly, in which case the scheduler runs until the call can return.
+ * Functions that stand in for hardware (GPIO levels, encoder steps) behave
+ * like interrupts when called from the test program.
+ */
+
+// --- Scheduler ---
+
+/**
+ * @brief Returns the simulated time in microseconds since start.
+ */
+int64_t sim_now_us(void);
+
+/**
+ * @brief Runs all tasks, timers and device models for duration_us of simulated time.
+ */
+void sim_run_for(int64_t duration_us);
+
+/**
+ * @brief Runs until done(arg) returns true or timeout_us of simulated time passes.
+ *
+ * The predicate is checked after every task switch and time step.
+ *
+ * @return true if the predicate became true, false on timeout.
+ */
+bool sim_run_until(bool (*done)(void* arg), void* arg, int64_t timeout_us);
+
+/**
+ * @brief Schedules fn(arg) to run in interrupt context at the given simulated time.
+ *
+ * Used by device models for their own clocks (e.g. the DS1307 SQW output).
+ *
+ * @return An id for sim_cancel(), or 0 if the event table is full.
+ */
+uint32_t sim_schedule(int64_t at_us, void (*fn)(void* arg), void* arg);
+
+/**
+ * @brief Cancels an event from sim_schedule() that has not run yet.
+ */
+void sim_cancel(uint32_t id);
+
+// --- GPIO ---
+
+/**
+ * @brief Drives an input pin from outside, like a switch or another chip would.
+ *
+ * Runs the pin's ISR immediately if its interrupt is enabled and the edge matches.
+ */
+void sim_gpio_set_level(int gpio_num, int level);
+
+/**
+ * @brief Stops driving a pin; it falls back to its pull-up or pull-down.
+ */
+void sim_gpio_release(int gpio_num);
+
+// --- Power Management ---
+
+/**
+ * @brief True while the chip is in light sleep.
+ *
+ * With light sleep enabled through esp_pm_configure() the chip sleeps
+ * whenever nothing is due for at least three ticks and no
+ * ESP_PM_NO_LIGHT_SLEEP lock is held. Pin interrupts raised meanwhile wait
+ * for the wakeup; a pin armed with gpio_wakeup_enable() causes one, about
+ * 1 ms later.
+ */
+bool sim_pm_asleep(void);
+
+// --- I2C ---
+
+/**
+ * @brief Callbacks of an I2C device model.
+ *
+ * at_us is the simulated time at which the byte's ACK bit is on the wire.
+ */
+typedef struct {
+    void (*start)(void* ctx, bool read);                /*!< Addressed after a START or repeated START. */
+    bool (*write)(void* ctx, uint8_t data, int64_t at_us); /*!< Returns false to NACK the byte. */
+    uint8_t (*read)(void* ctx, int64_t at_us);
+    void (*stop)(void* ctx);
+} sim_i2c_device_ops_t;
+
+/**
+ * @brief Traffic counters for a port, or for one address on it.
+ */
+typedef struct {
+    uint32_t transactions;      /*!< Calls to i2c_master_cmd_begin(). */
+    uint32_t bytes;             /*!< Bytes on the wire, address bytes included. */
+    uint32_t nacks;             /*!< Transactions aborted by a NACK. */
+    int64_t bus_time_us;        /*!< Time SCL was running, START to STOP. */
+} sim_i2c_stats_t;
+
+/**
+ * @brief Attaches a device model at a 7-bit address.
+ */
+esp_err_t sim_i2c_attach(int port, uint8_t address, const sim_i2c_device_ops_t* ops, void* ctx);
+
+/**
+ * @brief Copies the counters for a port. address 0xFF selects the whole port.
+ */
+void sim_i2c_get_stats(int port, uint8_t address, sim_i2c_stats_t* stats);
+
+// --- HD44780 behind a PCF8574 backpack ---
+
+/**
+ * @brief Counters kept by the LCD model.
+ */
+typedef struct {
+    uint32_t instructions;      /*!< Instructions executed (RS = 0). */
+    uint32_t data_writes;       /*!< Bytes written to DDRAM or CGRAM. */
+    uint32_t cgram_writes;      /*!< The part of data_writes that went to CGRAM. */
+    uint32_t busy_violations;   /*!< Bytes latched while the controller was still busy. */
+    uint32_t clears;            /*!< Clear display instructions, i.e. controller re-inits. */
+} sim_lcd_stats_t;
+
+/**
+ * @brief Attaches the LCD model. Rows use the 0x00/0x40/0x14/0x54 DDRAM layout.
+ */
+esp_err_t sim_lcd_attach(int port, uint8_t address, uint8_t cols, uint8_t rows);
+
+/**
+ * @brief Copies the visible text of a row into buf (cols + 1 bytes, NUL terminated).
+ */
+void sim_lcd_get_row(uint8_t row, char* buf);
+
+/**
+ * @brief Returns when the character now shown at row/col was written, or -1 if never.
+ */
+int64_t sim_lcd_cell_written_us(uint8_t row, uint8_t col);
+
+/**
+ * @brief Copies one CGRAM glyph (8 rows of 5 bits).
+ */
+void sim_lcd_get_glyph(uint8_t slot, uint8_t bitmap[8]);
+
+void sim_lcd_get_stats(sim_lcd_stats_t* stats);
+
+/**
+ * @brief Models a lost E pulse: the controller's 4-bit phase slips by one nibble.
+ */
+void sim_lcd_drop_nibble(void);
+
+/**
+ * @brief NACKs the next count bytes written to the PCF8574, which leave the port unchanged.
+ */
+void sim_lcd_fail_writes(uint32_t count);
+
+/**
+ * @brief NACKs the strobes of the next count status reads (E raised with RW high, RS low).
+ */
+void sim_lcd_fail_status_reads(uint32_t count);
+
+// --- DS1307 ---
+
+/**
+ * @brief Attaches the RTC model. Its clock runs in simulated time.
+ *
+ * @param sqw_gpio GPIO wired to SQW/OUT (open drain), or -1 if not connected.
+ */
+esp_err_t sim_ds1307_attach(int port, uint8_t address, int sqw_gpio);
+
+/**
+ * @brief Direct access to the 64-byte register file, bypassing the bus.
+ */
+uint8_t sim_ds1307_peek(uint8_t reg);
+void sim_ds1307_poke(uint8_t reg, uint8_t value);
+
+/**
+ * @brief Makes the RTC's crystal run fast (positive) or slow against simulated time.
+ */
+void sim_ds1307_set_drift_ppm(double ppm);
+
+// --- DS3231 ---
+
+/**
+ * @brief Attaches the DS3231 model. Its clock and alarms run in simulated time.
+ *
+ * @param int_gpio GPIO wired to INT/SQW (open drain), or -1 if not connected.
+ */
+esp_err_t sim_ds3231_attach(int port, uint8_t address, int int_gpio);
+
+/**
+ * @brief Direct access to registers 0x00-0x12, bypassing the bus; pokes may also set status flags.
+ */
+uint8_t sim_ds3231_peek(uint8_t reg);
+void sim_ds3231_poke(uint8_t reg, uint8_t value);
+
+/**
+ * @brief Crystal error before the aging offset trims it, positive for fast.
+ */
+void sim_ds3231_set_drift_ppm(double ppm);
+
+// --- System Clock ---
+// gettimeofday(), settimeofday() and adjtime() run in simulated time. As in
+// ESP-IDF, adjtime() slews the clock by 1/64 of the elapsed time until the
+// delta is used up. Requires linking with
+// -Wl,--wrap=gettimeofday,--wrap=settimeofday,--wrap=adjtime.
+
+// --- Heap ---
+
+/**
+ * @brief Heap counters. Requires linking with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free.
+ */
+typedef struct {
+    uint64_t allocations;       /*!< Successful malloc/calloc/realloc calls. */
+    uint64_t frees;             /*!< free() calls with a non-NULL pointer. */
+    size_t bytes_in_use;
+    size_t peak_bytes_in_use;
+} sim_heap_stats_t;
+
+void sim_heap_get_stats(sim_heap_stats_t* stats);
+
+#endif // SIM_H
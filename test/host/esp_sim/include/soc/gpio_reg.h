@@ -0,0 +1,8 @@
+#ifndef SIM_SOC_GPIO_REG_H
+#define SIM_SOC_GPIO_REG_H
+
+#define GPIO_IN_REG     0x3FF4403C
+#define GPIO_IN1_REG    0x3FF44040
+#define GPIO_IN1_DATA   0x000000FF
+
+#endif // SIM_SOC_GPIO_REG_H
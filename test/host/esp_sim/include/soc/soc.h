@@ -0,0 +1,11 @@
+#ifndef SIM_SOC_H
+#define SIM_SOC_H
+
+#include <stdint.h>
+
+// Register reads go to the simulated peripherals instead of memory
+uint32_t sim_reg_read(uint32_t addr);
+
+#define REG_READ(addr) sim_reg_read((uint32_t)(addr))
+
+#endif // SIM_SOC_H
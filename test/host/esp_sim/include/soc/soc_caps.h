@@ -0,0 +1,6 @@
+#ifndef SIM_SOC_CAPS_H
+#define SIM_SOC_CAPS_H
+
+#define SOC_GPIO_PIN_COUNT 40
+
+#endif // SIM_SOC_CAPS_H
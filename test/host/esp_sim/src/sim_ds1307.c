@@ -0,0 +1,145 @@
+#include "sim.h"
+#include "sim_internal.h"
+#include <string.h>
+
+#define REG_SECONDS 0x00
+#define REG_CONTROL 0x07
+#define REG_COUNT 64
+
+#define SECONDS_CH 0x80             // clock halt
+#define CONTROL_OUT 0x80
+#define CONTROL_SQWE 0x10
+#define CONTROL_RS_MASK 0x03
+
+#define HALF_PERIOD_US 500000
+
+/**
+ * @brief A DS1307: 64-byte register file with a 1 Hz timekeeping chain.
+ *
+ * Only the 24-hour mode is modelled, and SQW/OUT only toggles at the 1 Hz
+ * rate; at the faster rates it is left released.
+ */
+typedef struct {
+    uint8_t regs[REG_COUNT];
+    uint8_t pointer;
+    bool pointer_pending;           // the next written byte is the register pointer
+    int sqw_gpio;
+    bool sqw_high;                  // phase of the 1 Hz countdown chain
+    uint32_t tick_event;
+    double half_period_us;          // shorter than HALF_PERIOD_US when the crystal runs fast
+    double next_half_us;            // exact time of the next half period, before rounding
+} rtc_model_t;
+
+// --- Private Module State ---
+static rtc_model_t rtc;
+
+static void update_sqw(void) {
+    if (rtc.sqw_gpio < 0) {
+        return;
+    }
+    uint8_t control = rtc.regs[REG_CONTROL];
+    bool high;
+    if (control & CONTROL_SQWE) {
+        bool one_hz = (control & CONTROL_RS_MASK) == 0;
+        high = one_hz ? rtc.sqw_high : true;
+    } else {
+        high = control & CONTROL_OUT;
+    }
+    // Open drain: it can only pull the line low
+    if (high) {
+        sim_gpio_release(rtc.sqw_gpio);
+    } else {
+        sim_gpio_set_level(rtc.sqw_gpio, 0);
+    }
+}
+
+// Every half second; the seconds register moves on the falling edge of SQW
+static void on_half_period(void* arg) {
+    rtc.next_half_us += rtc.half_period_us;
+    rtc.tick_event = sim_schedule((int64_t)(rtc.next_half_us + 0.5), on_half_period, NULL);
+    if (rtc.regs[REG_SECONDS] & SECONDS_CH) {
+        return; // oscillator stopped
+    }
+    rtc.sqw_high = !rtc.sqw_high;
+    if (!rtc.sqw_high) {
+        sim_rtc_advance_second(rtc.regs);
+    }
+    update_sqw();
+}
+
+// Writing the seconds register resets the countdown chain
+static void restart_chain(void) {
+    sim_cancel(rtc.tick_event);
+    rtc.sqw_high = false;
+    rtc.next_half_us = sim_now_us() + rtc.half_period_us;
+    rtc.tick_event = sim_schedule((int64_t)(rtc.next_half_us + 0.5), on_half_period, NULL);
+}
+
+// --- I2C Device Callbacks ---
+
+static void rtc_start(void* ctx, bool read) {
+    rtc.pointer_pending = !read;
+}
+
+static bool rtc_write(void* ctx, uint8_t data, int64_t at_us) {
+    if (rtc.pointer_pending) {
+        rtc.pointer = data & (REG_COUNT - 1);
+        rtc.pointer_pending = false;
+        return true;
+    }
+    rtc.regs[rtc.pointer] = data;
+    if (rtc.pointer == REG_SECONDS) {
+        restart_chain();
+    }
+    if (rtc.pointer == REG_CONTROL) {
+        update_sqw();
+    }
+    rtc.pointer = (rtc.pointer + 1) & (REG_COUNT - 1);
+    return true;
+}
+
+static uint8_t rtc_read(void* ctx, int64_t at_us) {
+    uint8_t value = rtc.regs[rtc.pointer];
+    rtc.pointer = (rtc.pointer + 1) & (REG_COUNT - 1);
+    return value;
+}
+
+static const sim_i2c_device_ops_t ds1307_ops = {
+    .start = rtc_start,
+    .write = rtc_write,
+    .read = rtc_read,
+};
+
+// --- Simulation Control ---
+
+esp_err_t sim_ds1307_attach(int port, uint8_t address, int sqw_gpio) {
+    // Out of the box: 2000-01-01 00:00:00, running, SQW/OUT driven low
+    memset(&rtc, 0, sizeof(rtc));
+    rtc.regs[3] = 0x01;
+    rtc.regs[4] = 0x01;
+    rtc.regs[5] = 0x01;
+    rtc.sqw_gpio = sqw_gpio;
+    rtc.half_period_us = HALF_PERIOD_US;
+    restart_chain();
+    update_sqw();
+    return sim_i2c_attach(port, address, &ds1307_ops, NULL);
+}
+
+uint8_t sim_ds1307_peek(uint8_t reg) {
+    return rtc.regs[reg & (REG_COUNT - 1)];
+}
+
+void sim_ds1307_poke(uint8_t reg, uint8_t value) {
+    reg &= REG_COUNT - 1;
+    rtc.regs[reg] = value;
+    if (reg == REG_SECONDS) {
+        restart_chain();
+    }
+    if (reg == REG_CONTROL) {
+        update_sqw();
+    }
+}
+
+void sim_ds1307_set_drift_ppm(double ppm) {
+    rtc.half_period_us = HALF_PERIOD_US / (1.0 + ppm / 1e6);
+}
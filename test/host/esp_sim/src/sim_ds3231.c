@@ -0,0 +1,217 @@
+#include "sim.h"
+#include "sim_internal.h"
+#include <string.h>
+
+#define REG_SECONDS 0x00
+#define REG_ALARM_1 0x07
+#define REG_ALARM_2 0x0B
+#define REG_CONTROL 0x0E
+#define REG_STATUS 0x0F
+#define REG_AGING 0x10
+#define REG_TEMP_MSB 0x11
+#define REG_COUNT 0x13
+
+#define CONTROL_RS_MASK 0x18
+#define CONTROL_INTCN 0x04
+#define CONTROL_A2IE 0x02
+#define CONTROL_A1IE 0x01
+
+#define STATUS_OSF 0x80
+#define STATUS_A2F 0x02
+#define STATUS_A1F 0x01
+#define STATUS_CLEAR_ONLY (STATUS_OSF | STATUS_A2F | STATUS_A1F)
+#define STATUS_WRITABLE 0x08        // EN32kHz
+
+#define ALARM_MASK 0x80
+#define ALARM_DY 0x40
+
+#define HALF_PERIOD_US 500000
+#define AGING_STEP_PPM 0.1
+
+/**
+ * @brief A DS3231: timekeeping, both alarms and INT/SQW.
+ *
+ * Only the 24-hour mode is modelled. INT/SQW only toggles at the 1 Hz rate,
+ * the temperature stays at 25 C and the aging offset takes effect at once
+ * rather than at the next conversion.
+ */
+typedef struct {
+    uint8_t regs[REG_COUNT];
+    uint8_t pointer;
+    bool pointer_pending;           // the next written byte is the register pointer
+    int int_gpio;
+    bool sqw_high;                  // phase of the 1 Hz countdown chain
+    uint32_t tick_event;
+    double drift_ppm;               // crystal error before the aging trim
+    double half_period_us;
+    double next_half_us;            // exact time of the next half period, before rounding
+} rtc_model_t;
+
+// --- Private Module State ---
+static rtc_model_t rtc;
+
+static void update_pin(void) {
+    if (rtc.int_gpio < 0) {
+        return;
+    }
+    uint8_t control = rtc.regs[REG_CONTROL];
+    uint8_t status = rtc.regs[REG_STATUS];
+    bool high;
+    if (control & CONTROL_INTCN) {
+        bool pending = ((control & CONTROL_A1IE) && (status & STATUS_A1F)) ||
+                       ((control & CONTROL_A2IE) && (status & STATUS_A2F));
+        high = !pending;
+    } else {
+        bool one_hz = (control & CONTROL_RS_MASK) == 0;
+        high = one_hz ? rtc.sqw_high : true;
+    }
+    // Open drain: it can only pull the line low
+    if (high) {
+        sim_gpio_release(rtc.int_gpio);
+    } else {
+        sim_gpio_set_level(rtc.int_gpio, 0);
+    }
+}
+
+static void update_period(void) {
+    double ppm = rtc.drift_ppm - (int8_t)rtc.regs[REG_AGING] * AGING_STEP_PPM;
+    rtc.half_period_us = HALF_PERIOD_US / (1.0 + ppm / 1e6);
+}
+
+// Compares the unmasked fields; the day field holds the date or, with DY, the weekday
+static bool alarm_matches(const uint8_t* alarm, const uint8_t* time, int fields) {
+    for (int i = 0; i < fields; i++) {
+        if (alarm[i] & ALARM_MASK) {
+            continue;
+        }
+        bool weekday = i == 3 && (alarm[i] & ALARM_DY);
+        uint8_t want = alarm[i] & (i == 3 ? 0x3F : 0x7F);
+        uint8_t have = time[weekday ? 3 : (i == 3 ? 4 : i)];
+        if (want != have) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void check_alarms(void) {
+    uint8_t* r = rtc.regs;
+    if (alarm_matches(&r[REG_ALARM_1], r, 4)) {
+        r[REG_STATUS] |= STATUS_A1F;
+    }
+    // Alarm 2 has no seconds field and fires as they wrap to 00
+    uint8_t alarm_2[4] = { ALARM_MASK, r[REG_ALARM_2], r[REG_ALARM_2 + 1], r[REG_ALARM_2 + 2] };
+    if (r[0] == 0 && alarm_matches(alarm_2, r, 4)) {
+        r[REG_STATUS] |= STATUS_A2F;
+    }
+}
+
+// Every half second; the seconds register moves on the falling edge of SQW
+static void on_half_period(void* arg) {
+    rtc.next_half_us += rtc.half_period_us;
+    rtc.tick_event = sim_schedule((int64_t)(rtc.next_half_us + 0.5), on_half_period, NULL);
+    rtc.sqw_high = !rtc.sqw_high;
+    if (!rtc.sqw_high) {
+        sim_rtc_advance_second(rtc.regs);
+        check_alarms();
+    }
+    update_pin();
+}
+
+// Writing the seconds register resets the countdown chain
+static void restart_chain(void) {
+    sim_cancel(rtc.tick_event);
+    rtc.sqw_high = false;
+    rtc.next_half_us = sim_now_us() + rtc.half_period_us;
+    rtc.tick_event = sim_schedule((int64_t)(rtc.next_half_us + 0.5), on_half_period, NULL);
+}
+
+static void set_reg(uint8_t reg, uint8_t value) {
+    rtc.regs[reg] = value;
+    if (reg == REG_SECONDS) {
+        restart_chain();
+    }
+    if (reg == REG_AGING) {
+        update_period();
+    }
+    if (reg == REG_CONTROL || reg == REG_STATUS) {
+        update_pin();
+    }
+}
+
+// A write over the bus, where the status flags can only be cleared
+static void write_reg(uint8_t reg, uint8_t value) {
+    if (reg == REG_STATUS) {
+        uint8_t old = rtc.regs[REG_STATUS];
+        value = (old & value & STATUS_CLEAR_ONLY) | (value & STATUS_WRITABLE);
+    }
+    if (reg == REG_TEMP_MSB || reg == REG_TEMP_MSB + 1) {
+        return; // read-only
+    }
+    set_reg(reg, value);
+}
+
+// --- I2C Device Callbacks ---
+
+static void rtc_start(void* ctx, bool read) {
+    rtc.pointer_pending = !read;
+}
+
+static bool rtc_write(void* ctx, uint8_t data, int64_t at_us) {
+    if (rtc.pointer_pending) {
+        if (data >= REG_COUNT) {
+            return false;
+        }
+        rtc.pointer = data;
+        rtc.pointer_pending = false;
+        return true;
+    }
+    write_reg(rtc.pointer, data);
+    rtc.pointer = (rtc.pointer + 1) % REG_COUNT;
+    return true;
+}
+
+static uint8_t rtc_read(void* ctx, int64_t at_us) {
+    uint8_t value = rtc.regs[rtc.pointer];
+    rtc.pointer = (rtc.pointer + 1) % REG_COUNT;
+    return value;
+}
+
+static const sim_i2c_device_ops_t ds3231_ops = {
+    .start = rtc_start,
+    .write = rtc_write,
+    .read = rtc_read,
+};
+
+// --- Simulation Control ---
+
+esp_err_t sim_ds3231_attach(int port, uint8_t address, int int_gpio) {
+    // At power-on: 2000-01-01 00:00:00, oscillator stop flagged, alarm interrupts off
+    memset(&rtc, 0, sizeof(rtc));
+    rtc.regs[3] = 0x01;
+    rtc.regs[4] = 0x01;
+    rtc.regs[5] = 0x01;
+    rtc.regs[REG_CONTROL] = 0x1C;
+    rtc.regs[REG_STATUS] = 0x88;
+    rtc.regs[REG_TEMP_MSB] = 25;
+    rtc.int_gpio = int_gpio;
+    update_period();
+    restart_chain();
+    update_pin();
+    return sim_i2c_attach(port, address, &ds3231_ops, NULL);
+}
+
+uint8_t sim_ds3231_peek(uint8_t reg) {
+    return reg < REG_COUNT ? rtc.regs[reg] : 0;
+}
+
+void sim_ds3231_poke(uint8_t reg, uint8_t value) {
+    if (reg < REG_COUNT) {
+        set_reg(reg, value);
+    }
+}
+
+void sim_ds3231_set_drift_ppm(double ppm) {
+    rtc.drift_ppm = ppm;
+    update_period();
+}
@@ -0,0 +1,137 @@
+#include "sim.h"
+#include "sim_internal.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Same priority as the esp_timer task in ESP-IDF
+#define ESP_TIMER_TASK_PRIORITY 22
+#define ESP_TIMER_TASK_STACK_SIZE 3584
+
+/**
+ * @brief A software timer. Callbacks run on the esp_timer task whatever the dispatch method.
+ */
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void* arg;
+    const char* name;
+    bool active;
+    int64_t due_us;
+    uint64_t period_us;             // 0 for one-shot
+    struct esp_timer* next;
+};
+
+// --- Private Module State ---
+static struct esp_timer* timers = NULL;
+static TaskHandle_t timer_task_handle = NULL;
+
+static struct esp_timer* earliest_timer(void) {
+    struct esp_timer* earliest = NULL;
+    for (struct esp_timer* t = timers; t; t = t->next) {
+        if (t->active && (earliest == NULL || t->due_us < earliest->due_us)) {
+            earliest = t;
+        }
+    }
+    return earliest;
+}
+
+static void timer_task(void* arg) {
+    while (1) {
+        struct esp_timer* due = earliest_timer();
+        if (due == NULL || due->due_us > sim_now_us()) {
+            sim_block(&timers, due ? due->due_us : INT64_MAX);
+            continue;
+        }
+        if (due->period_us) {
+            due->due_us += due->period_us;
+        } else {
+            due->active = false;
+        }
+        due->callback(due->arg);
+    }
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* create_args, esp_timer_handle_t* out_handle) {
+    if (create_args == NULL || create_args->callback == NULL || out_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer_task_handle == NULL &&
+        xTaskCreate(timer_task, "esp_timer", ESP_TIMER_TASK_STACK_SIZE, NULL, ESP_TIMER_TASK_PRIORITY,
+                    &timer_task_handle) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    struct esp_timer* timer = calloc(1, sizeof(struct esp_timer));
+    if (timer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    timer->callback = create_args->callback;
+    timer->arg = create_args->arg;
+    timer->name = create_args->name;
+    timer->next = timers;
+    timers = timer;
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+static esp_err_t start_timer(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period_us) {
+    if (timer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = true;
+    timer->due_us = sim_now_us() + (int64_t)timeout_us;
+    timer->period_us = period_us;
+    sim_wake(&timers);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    return start_timer(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period) {
+    if (period == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return start_timer(timer, period, period);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (timer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = false;
+    sim_wake(&timers);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (timer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    struct esp_timer** pos = &timers;
+    while (*pos && *pos != timer) {
+        pos = &(*pos)->next;
+    }
+    if (*pos) {
+        *pos = timer->next;
+    }
+    free(timer);
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    return timer && timer->active;
+}
+
+int64_t esp_timer_get_time(void) {
+    return sim_now_us();
+}
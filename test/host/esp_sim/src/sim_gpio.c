@@ -0,0 +1,253 @@
+#include "sim.h"
+#include "sim_internal.h"
+#include "driver/gpio.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+
+/**
+ * @brief State of one pin.
+ */
+typedef struct {
+    int level;
+    bool driven;                    // held by sim_gpio_set_level() or gpio_set_level()
+    bool pull_up;
+    bool pull_down;
+    gpio_int_type_t intr_type;
+    bool intr_enabled;
+    gpio_isr_t isr;
+    void* isr_arg;
+    bool wakeup;                    // armed by gpio_wakeup_enable()
+    bool pending;                   // interrupt raised during light sleep
+} sim_pin_t;
+
+// --- Private Module State ---
+static sim_pin_t pins[SOC_GPIO_PIN_COUNT];
+static bool isr_service_installed = false;
+
+static bool valid_pin(gpio_num_t gpio_num) {
+    return gpio_num >= 0 && gpio_num < SOC_GPIO_PIN_COUNT;
+}
+
+static bool edge_matches(gpio_int_type_t type, int old_level, int new_level) {
+    switch (type) {
+    case GPIO_INTR_POSEDGE: return !old_level && new_level;
+    case GPIO_INTR_NEGEDGE: return old_level && !new_level;
+    case GPIO_INTR_ANYEDGE: return old_level != new_level;
+    case GPIO_INTR_LOW_LEVEL: return !new_level;
+    case GPIO_INTR_HIGH_LEVEL: return new_level;
+    default: return false;
+    }
+}
+
+static void apply_level(gpio_num_t gpio_num, int level) {
+    sim_pin_t* pin = &pins[gpio_num];
+    int old_level = pin->level;
+    pin->level = level ? 1 : 0;
+    if (sim_pm_asleep()) {
+        // The interrupt status is latched; the handler runs once awake
+        if (pin->wakeup && edge_matches(pin->intr_type, old_level, pin->level)) {
+            pin->pending = true;
+            sim_pm_gpio_wake();
+        } else if (pin->intr_enabled && pin->isr && edge_matches(pin->intr_type, old_level, pin->level)) {
+            pin->pending = true;
+        }
+        return;
+    }
+    if (pin->intr_enabled && pin->isr && edge_matches(pin->intr_type, old_level, pin->level)) {
+        sim_isr_enter();
+        pin->isr(pin->isr_arg);
+        sim_isr_exit();
+    }
+}
+
+// Level of an undriven pin
+static int floating_level(const sim_pin_t* pin) {
+    return pin->pull_up && !pin->pull_down;
+}
+
+// --- Simulation Control ---
+
+void sim_gpio_set_level(int gpio_num, int level) {
+    if (!valid_pin(gpio_num)) {
+        return;
+    }
+    pins[gpio_num].driven = true;
+    apply_level(gpio_num, level);
+}
+
+void sim_gpio_release(int gpio_num) {
+    if (!valid_pin(gpio_num)) {
+        return;
+    }
+    pins[gpio_num].driven = false;
+    apply_level(gpio_num, floating_level(&pins[gpio_num]));
+}
+
+void sim_gpio_deliver_pending(void) {
+    for (int i = 0; i < SOC_GPIO_PIN_COUNT; i++) {
+        sim_pin_t* pin = &pins[i];
+        if (!pin->pending) {
+            continue;
+        }
+        pin->pending = false;
+        if (pin->intr_enabled && pin->isr) {
+            sim_isr_enter();
+            pin->isr(pin->isr_arg);
+            sim_isr_exit();
+        }
+    }
+}
+
+uint32_t sim_reg_read(uint32_t addr) {
+    uint32_t value = 0;
+    int first = addr == GPIO_IN_REG ? 0 : addr == GPIO_IN1_REG ? 32 : -1;
+    if (first < 0) {
+        return 0;
+    }
+    for (int i = 0; i < 32 && first + i < SOC_GPIO_PIN_COUNT; i++) {
+        value |= (uint32_t)pins[first + i].level << i;
+    }
+    return value;
+}
+
+// --- Driver API ---
+
+esp_err_t gpio_config(const gpio_config_t* config) {
+    if (config == NULL || config->pin_bit_mask == 0 || (config->pin_bit_mask >> SOC_GPIO_PIN_COUNT)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < SOC_GPIO_PIN_COUNT; i++) {
+        if (!(config->pin_bit_mask & (1ULL << i))) {
+            continue;
+        }
+        sim_pin_t* pin = &pins[i];
+        pin->pull_up = config->pull_up_en == GPIO_PULLUP_ENABLE;
+        pin->pull_down = config->pull_down_en == GPIO_PULLDOWN_ENABLE;
+        pin->intr_type = config->intr_type;
+        pin->intr_enabled = config->intr_type != GPIO_INTR_DISABLE;
+        if (!pin->driven) {
+            pin->level = floating_level(pin);
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num) {
+    if (!valid_pin(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_pin_t* pin = &pins[gpio_num];
+    pin->pull_up = true;
+    pin->pull_down = false;
+    pin->intr_type = GPIO_INTR_DISABLE;
+    pin->intr_enabled = false;
+    if (!pin->driven) {
+        pin->level = floating_level(pin);
+    }
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num) {
+    return valid_pin(gpio_num) ? pins[gpio_num].level : 0;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    if (!valid_pin(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_gpio_set_level(gpio_num, (int)level);
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type) {
+    if (!valid_pin(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pins[gpio_num].intr_type = intr_type;
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio_num) {
+    if (!valid_pin(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pins[gpio_num].intr_enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio_num) {
+    if (!valid_pin(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pins[gpio_num].intr_enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t gpio_pullup_en(gpio_num_t gpio_num) {
+    if (!valid_pin(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pins[gpio_num].pull_up = true;
+    if (!pins[gpio_num].driven) {
+        apply_level(gpio_num, floating_level(&pins[gpio_num]));
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_pulldown_en(gpio_num_t gpio_num) {
+    if (!valid_pin(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pins[gpio_num].pull_down = true;
+    if (!pins[gpio_num].driven) {
+        apply_level(gpio_num, floating_level(&pins[gpio_num]));
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags) {
+    if (isr_service_installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    isr_service_installed = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void* args) {
+    if (!valid_pin(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!isr_service_installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    pins[gpio_num].isr = isr_handler;
+    pins[gpio_num].isr_arg = args;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num) {
+    if (!valid_pin(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pins[gpio_num].isr = NULL;
+    pins[gpio_num].isr_arg = NULL;
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio_num, gpio_int_type_t intr_type) {
+    if (!valid_pin(gpio_num) || (intr_type != GPIO_INTR_LOW_LEVEL && intr_type != GPIO_INTR_HIGH_LEVEL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // Shares the interrupt type field with the pin's edge interrupt, as on the ESP32
+    pins[gpio_num].intr_type = intr_type;
+    pins[gpio_num].wakeup = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio_num) {
+    if (!valid_pin(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pins[gpio_num].wakeup = false;
+    return ESP_OK;
+}
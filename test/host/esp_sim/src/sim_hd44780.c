@@ -0,0 +1,270 @@
+#include "sim.h"
+#include <string.h>
+
+// PCF8574 pin mapping used by the common backpacks (and lcd_i2c.c)
+#define PIN_RS (1 << 0)
+#define PIN_RW (1 << 1)
+#define PIN_E  (1 << 2)
+
+// Execution times from the HD44780 datasheet (fosc = 270 kHz)
+#define EXEC_US 37
+#define EXEC_DATA_US 41
+#define EXEC_CLEAR_US 1520
+
+#define DDRAM_SIZE 0x80
+#define LINE_LEN 40
+
+static const uint8_t row_offsets[] = {0x00, 0x40, 0x14, 0x54};
+
+/**
+ * @brief An HD44780 controller behind a PCF8574 I/O expander.
+ */
+typedef struct {
+    uint8_t cols;
+    uint8_t rows;
+    uint8_t port;                   // PCF8574 output latch
+
+    // Controller state
+    bool four_bit;
+    bool two_line;
+    bool nibble_pending;            // 4-bit mode: the high nibble has been latched
+    uint8_t high_nibble;
+    uint8_t ac;                     // address counter
+    bool ac_in_cgram;
+    bool increment;
+    bool shift_on_write;
+    bool display_on;
+    int shift;                      // display shift, in cells to the left
+    int64_t busy_until_us;
+
+    uint8_t ddram[DDRAM_SIZE];
+    uint8_t cgram[64];
+    int64_t written_us[DDRAM_SIZE];
+    sim_lcd_stats_t stats;
+    uint32_t failing_writes;        // bytes the PCF8574 still NACKs
+    uint32_t failing_status_reads;  // status read strobes the PCF8574 still NACKs
+} lcd_model_t;
+
+// --- Private Module State ---
+static lcd_model_t lcd;
+
+static bool ddram_valid(uint8_t addr) {
+    if (!lcd.two_line) {
+        return addr < 2 * LINE_LEN;
+    }
+    return (addr & 0x3F) < LINE_LEN;
+}
+
+// Moves the address counter the way the controller does, wrapping between lines
+static uint8_t ddram_step(uint8_t addr, bool forward) {
+    if (!lcd.two_line) {
+        return forward ? (addr + 1) % (2 * LINE_LEN) : (addr + 2 * LINE_LEN - 1) % (2 * LINE_LEN);
+    }
+    if (forward) {
+        return addr == LINE_LEN - 1 ? 0x40 : addr == 0x40 + LINE_LEN - 1 ? 0x00 : addr + 1;
+    }
+    return addr == 0x00 ? 0x40 + LINE_LEN - 1 : addr == 0x40 ? LINE_LEN - 1 : addr - 1;
+}
+
+static void execute(uint8_t value, bool rs, int64_t at_us) {
+    if (at_us < lcd.busy_until_us) {
+        lcd.stats.busy_violations++;
+    }
+
+    if (rs) {
+        lcd.stats.data_writes++;
+        if (lcd.ac_in_cgram) {
+            lcd.stats.cgram_writes++;
+            lcd.cgram[lcd.ac & 0x3F] = value;
+            lcd.ac = (lcd.ac + (lcd.increment ? 1 : 63)) & 0x3F;
+        } else {
+            if (ddram_valid(lcd.ac)) {
+                lcd.ddram[lcd.ac] = value;
+                lcd.written_us[lcd.ac] = at_us;
+            }
+            lcd.ac = ddram_step(lcd.ac, lcd.increment);
+            if (lcd.shift_on_write) {
+                lcd.shift += lcd.increment ? 1 : -1;
+            }
+        }
+        lcd.busy_until_us = at_us + EXEC_DATA_US;
+        return;
+    }
+
+    lcd.stats.instructions++;
+    int64_t exec_us = EXEC_US;
+    if (value & 0x80) {
+        lcd.ac = value & 0x7F;
+        lcd.ac_in_cgram = false;
+    } else if (value & 0x40) {
+        lcd.ac = value & 0x3F;
+        lcd.ac_in_cgram = true;
+    } else if (value & 0x20) {
+        lcd.four_bit = !(value & 0x10);
+        lcd.two_line = value & 0x08;
+        if (!lcd.four_bit) {
+            lcd.nibble_pending = false;
+        }
+    } else if (value & 0x10) {
+        bool right = value & 0x04;
+        if (value & 0x08) {
+            lcd.shift += right ? -1 : 1;
+        } else if (!lcd.ac_in_cgram) {
+            lcd.ac = ddram_step(lcd.ac, right);
+        }
+    } else if (value & 0x08) {
+        lcd.display_on = value & 0x04;
+    } else if (value & 0x04) {
+        lcd.increment = value & 0x02;
+        lcd.shift_on_write = value & 0x01;
+    } else if (value & 0x02) {
+        lcd.ac = 0;
+        lcd.ac_in_cgram = false;
+        lcd.shift = 0;
+        exec_us = EXEC_CLEAR_US;
+    } else if (value & 0x01) {
+        lcd.stats.clears++;
+        memset(lcd.ddram, ' ', sizeof(lcd.ddram));
+        for (int i = 0; i < DDRAM_SIZE; i++) {
+            lcd.written_us[i] = at_us;
+        }
+        lcd.ac = 0;
+        lcd.ac_in_cgram = false;
+        lcd.increment = true;
+        lcd.shift = 0;
+        exec_us = EXEC_CLEAR_US;
+    }
+    lcd.busy_until_us = at_us + exec_us;
+}
+
+// E fell: the controller latches D7-D4 and RS
+static void latch(uint8_t pins, int64_t at_us) {
+    uint8_t nibble = pins >> 4;
+    bool rs = pins & PIN_RS;
+
+    if (pins & PIN_RW) {
+        // A read cycle only moves the nibble phase
+        if (lcd.four_bit) {
+            lcd.nibble_pending = !lcd.nibble_pending;
+        }
+        return;
+    }
+    if (!lcd.four_bit) {
+        // D3-D0 are not wired on the backpack and read as 0
+        execute(nibble << 4, rs, at_us);
+        return;
+    }
+    if (!lcd.nibble_pending) {
+        lcd.high_nibble = nibble;
+        lcd.nibble_pending = true;
+    } else {
+        lcd.nibble_pending = false;
+        execute((lcd.high_nibble << 4) | nibble, rs, at_us);
+    }
+}
+
+// --- I2C Device Callbacks ---
+
+static bool pcf_write(void* ctx, uint8_t data, int64_t at_us) {
+    if (lcd.failing_writes > 0) {
+        lcd.failing_writes--;
+        return false;
+    }
+    if (lcd.failing_status_reads > 0 && (data & PIN_E) && (data & PIN_RW) && !(data & PIN_RS)) {
+        lcd.failing_status_reads--;
+        return false;
+    }
+    uint8_t old = lcd.port;
+    lcd.port = data;
+    if ((old & PIN_E) && !(data & PIN_E)) {
+        latch(old, at_us);
+    }
+    return true;
+}
+
+// Quasi-bidirectional port: pins written high read back what the controller drives
+static uint8_t pcf_read(void* ctx, int64_t at_us) {
+    uint8_t value = lcd.port;
+    if ((lcd.port & PIN_E) && (lcd.port & PIN_RW)) {
+        uint8_t out;
+        if (lcd.port & PIN_RS) {
+            out = lcd.ac_in_cgram ? lcd.cgram[lcd.ac & 0x3F] : lcd.ddram[lcd.ac & 0x7F];
+        } else {
+            out = (at_us < lcd.busy_until_us ? 0x80 : 0x00) | (lcd.ac & 0x7F);
+        }
+        uint8_t nibble = (lcd.four_bit && lcd.nibble_pending) ? (out & 0x0F) : (out >> 4);
+        value = (lcd.port & 0x0F) | ((nibble << 4) & lcd.port & 0xF0);
+    }
+    return value;
+}
+
+static const sim_i2c_device_ops_t pcf8574_ops = {
+    .write = pcf_write,
+    .read = pcf_read,
+};
+
+// --- Simulation Control ---
+
+esp_err_t sim_lcd_attach(int port, uint8_t address, uint8_t cols, uint8_t rows) {
+    if (cols == 0 || cols > LINE_LEN || rows == 0 || rows > sizeof(row_offsets)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // Power-on state: 8-bit interface, one line, display off, DDRAM full of spaces
+    memset(&lcd, 0, sizeof(lcd));
+    lcd.cols = cols;
+    lcd.rows = rows;
+    lcd.port = 0xFF;
+    lcd.increment = true;
+    memset(lcd.ddram, ' ', sizeof(lcd.ddram));
+    for (int i = 0; i < DDRAM_SIZE; i++) {
+        lcd.written_us[i] = -1;
+    }
+    return sim_i2c_attach(port, address, &pcf8574_ops, NULL);
+}
+
+static uint8_t visible_addr(uint8_t row, uint8_t col) {
+    uint8_t base = row_offsets[row];
+    int offset = ((base & 0x3F) + col + lcd.shift) % LINE_LEN;
+    if (offset < 0) {
+        offset += LINE_LEN;
+    }
+    return (base & 0x40) | offset;
+}
+
+void sim_lcd_get_row(uint8_t row, char* buf) {
+    for (uint8_t col = 0; col < lcd.cols; col++) {
+        buf[col] = row < lcd.rows ? (char)lcd.ddram[visible_addr(row, col)] : ' ';
+    }
+    buf[lcd.cols] = '\0';
+}
+
+int64_t sim_lcd_cell_written_us(uint8_t row, uint8_t col) {
+    if (row >= lcd.rows || col >= lcd.cols) {
+        return -1;
+    }
+    return lcd.written_us[visible_addr(row, col)];
+}
+
+void sim_lcd_get_glyph(uint8_t slot, uint8_t bitmap[8]) {
+    for (int i = 0; i < 8; i++) {
+        bitmap[i] = lcd.cgram[(slot & 0x07) * 8 + i] & 0x1F;
+    }
+}
+
+void sim_lcd_get_stats(sim_lcd_stats_t* stats) {
+    *stats = lcd.stats;
+}
+
+void sim_lcd_drop_nibble(void) {
+    if (lcd.four_bit) {
+        lcd.nibble_pending = !lcd.nibble_pending;
+    }
+}
+
+void sim_lcd_fail_writes(uint32_t count) {
+    lcd.failing_writes = count;
+}
+
+void sim_lcd_fail_status_reads(uint32_t count) {
+    lcd.failing_status_reads = count;
+}
@@ -0,0 +1,75 @@
+#include "sim.h"
+#include <string.h>
+
+// The linker routes every malloc/calloc/realloc/free in the program through
+// these wrappers (-Wl,--wrap=...). A small header in front of each block
+// remembers its size.
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+typedef union {
+    size_t size;
+    max_align_t align;
+} block_header_t;
+
+static sim_heap_stats_t heap_stats;
+
+static void* track(block_header_t* block, size_t size) {
+    if (block == NULL) {
+        return NULL;
+    }
+    block->size = size;
+    heap_stats.allocations++;
+    heap_stats.bytes_in_use += size;
+    if (heap_stats.bytes_in_use > heap_stats.peak_bytes_in_use) {
+        heap_stats.peak_bytes_in_use = heap_stats.bytes_in_use;
+    }
+    return block + 1;
+}
+
+void* __wrap_malloc(size_t size) {
+    return track(__real_malloc(sizeof(block_header_t) + size), size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    if (size && count > (SIZE_MAX - sizeof(block_header_t)) / size) {
+        return NULL;
+    }
+    return track(__real_calloc(1, sizeof(block_header_t) + count * size), count * size);
+}
+
+void __wrap_free(void* ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    block_header_t* block = (block_header_t*)ptr - 1;
+    heap_stats.frees++;
+    heap_stats.bytes_in_use -= block->size;
+    __real_free(block);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    if (ptr == NULL) {
+        return __wrap_malloc(size);
+    }
+    if (size == 0) {
+        __wrap_free(ptr);
+        return NULL;
+    }
+    block_header_t* old = (block_header_t*)ptr - 1;
+    size_t old_size = old->size;
+    block_header_t* block = __real_realloc(old, sizeof(block_header_t) + size);
+    if (block == NULL) {
+        return NULL;
+    }
+    heap_stats.frees++;
+    heap_stats.bytes_in_use -= old_size;
+    return track(block, size);
+}
+
+void sim_heap_get_stats(sim_heap_stats_t* stats) {
+    *stats = heap_stats;
+}
@@ -0,0 +1,277 @@
+#include "sim.h"
+#include "sim_internal.h"
+#include "driver/i2c.h"
+#include <string.h>
+
+#define MAX_DEVICES 8
+#define ALL_ADDRESSES 0xFF
+
+typedef enum {
+    OP_START,
+    OP_WRITE,
+    OP_READ,
+    OP_STOP,
+} op_type_t;
+
+/**
+ * @brief One recorded command. Data is referenced, not copied, as in ESP-IDF.
+ */
+typedef struct {
+    uint8_t type;
+    bool ack_check;
+    uint8_t byte;                   // single-byte writes and reads land here
+    const uint8_t* wdata;
+    uint8_t* rdata;
+    size_t len;
+} op_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t capacity;
+    op_t ops[];
+} link_t;
+
+_Static_assert(sizeof(op_t) <= I2C_SIM_LINK_OP_SIZE, "I2C_SIM_LINK_OP_SIZE too small");
+_Static_assert(sizeof(link_t) <= I2C_SIM_LINK_HEADER_SIZE, "I2C_SIM_LINK_HEADER_SIZE too small");
+
+typedef struct {
+    uint8_t address;
+    const sim_i2c_device_ops_t* ops;
+    void* ctx;
+    sim_i2c_stats_t stats;
+} device_t;
+
+typedef struct {
+    bool configured;
+    bool installed;
+    uint32_t clk_speed;
+    device_t devices[MAX_DEVICES];
+    uint32_t num_devices;
+    sim_i2c_stats_t stats;
+} port_t;
+
+// --- Private Module State ---
+static port_t ports[I2C_NUM_MAX];
+
+static device_t* find_device(port_t* port, uint8_t address) {
+    for (uint32_t i = 0; i < port->num_devices; i++) {
+        if (port->devices[i].address == address) {
+            return &port->devices[i];
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t add_op(i2c_cmd_handle_t cmd_handle, op_t op) {
+    link_t* link = cmd_handle;
+    if (link == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (link->count >= link->capacity) {
+        return ESP_ERR_NO_MEM;
+    }
+    link->ops[link->count++] = op;
+    return ESP_OK;
+}
+
+// --- Simulation Control ---
+
+esp_err_t sim_i2c_attach(int port_num, uint8_t address, const sim_i2c_device_ops_t* ops, void* ctx) {
+    if (port_num < 0 || port_num >= I2C_NUM_MAX || ops == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    port_t* port = &ports[port_num];
+    if (port->num_devices >= MAX_DEVICES || find_device(port, address)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    port->devices[port->num_devices++] = (device_t){ .address = address, .ops = ops, .ctx = ctx };
+    return ESP_OK;
+}
+
+void sim_i2c_get_stats(int port_num, uint8_t address, sim_i2c_stats_t* stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (port_num < 0 || port_num >= I2C_NUM_MAX) {
+        return;
+    }
+    if (address == ALL_ADDRESSES) {
+        *stats = ports[port_num].stats;
+        return;
+    }
+    device_t* dev = find_device(&ports[port_num], address);
+    if (dev) {
+        *stats = dev->stats;
+    }
+}
+
+// --- Driver API ---
+
+esp_err_t i2c_param_config(i2c_port_t i2c_num, const i2c_config_t* i2c_conf) {
+    if (i2c_num < 0 || i2c_num >= I2C_NUM_MAX || i2c_conf == NULL || i2c_conf->mode != I2C_MODE_MASTER ||
+        i2c_conf->master.clk_speed == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ports[i2c_num].clk_speed = i2c_conf->master.clk_speed;
+    ports[i2c_num].configured = true;
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_install(i2c_port_t i2c_num, i2c_mode_t mode, size_t slv_rx_buf_len,
+                             size_t slv_tx_buf_len, int intr_alloc_flags) {
+    if (i2c_num < 0 || i2c_num >= I2C_NUM_MAX || mode != I2C_MODE_MASTER) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (ports[i2c_num].installed || !ports[i2c_num].configured) {
+        return ESP_FAIL;
+    }
+    ports[i2c_num].installed = true;
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_delete(i2c_port_t i2c_num) {
+    if (i2c_num < 0 || i2c_num >= I2C_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ports[i2c_num].installed = false;
+    return ESP_OK;
+}
+
+i2c_cmd_handle_t i2c_cmd_link_create_static(uint8_t* buffer, uint32_t size) {
+    uintptr_t aligned = ((uintptr_t)buffer + _Alignof(link_t) - 1) & ~(uintptr_t)(_Alignof(link_t) - 1);
+    uint32_t padding = (uint32_t)(aligned - (uintptr_t)buffer);
+    if (buffer == NULL || size < padding + sizeof(link_t) + sizeof(op_t)) {
+        return NULL;
+    }
+    link_t* link = (link_t*)aligned;
+    link->count = 0;
+    link->capacity = (size - padding - sizeof(link_t)) / sizeof(op_t);
+    return link;
+}
+
+void i2c_cmd_link_delete_static(i2c_cmd_handle_t cmd_handle) {
+    (void)cmd_handle;
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd_handle) {
+    return add_op(cmd_handle, (op_t){ .type = OP_START });
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd_handle, uint8_t data, bool ack_en) {
+    return add_op(cmd_handle, (op_t){ .type = OP_WRITE, .byte = data, .len = 1, .ack_check = ack_en });
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd_handle, const uint8_t* data, size_t data_len, bool ack_en) {
+    if (data == NULL || data_len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return add_op(cmd_handle, (op_t){ .type = OP_WRITE, .wdata = data, .len = data_len, .ack_check = ack_en });
+}
+
+esp_err_t i2c_master_read_byte(i2c_cmd_handle_t cmd_handle, uint8_t* data, i2c_ack_type_t ack) {
+    return i2c_master_read(cmd_handle, data, 1, ack);
+}
+
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd_handle, uint8_t* data, size_t data_len, i2c_ack_type_t ack) {
+    if (data == NULL || data_len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return add_op(cmd_handle, (op_t){ .type = OP_READ, .rdata = data, .len = data_len });
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd_handle) {
+    return add_op(cmd_handle, (op_t){ .type = OP_STOP });
+}
+
+esp_err_t i2c_master_cmd_begin(i2c_port_t i2c_num, i2c_cmd_handle_t cmd_handle, TickType_t ticks_to_wait) {
+    if (i2c_num < 0 || i2c_num >= I2C_NUM_MAX || cmd_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    port_t* port = &ports[i2c_num];
+    if (!port->installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    link_t* link = cmd_handle;
+
+    // Walk the commands bit by bit: START/STOP take one SCL period, a byte nine
+    int64_t start_us = sim_now_us();
+    int64_t elapsed_ns = 0;
+    int64_t bit_ns = 1000000000LL / port->clk_speed;
+    device_t* dev = NULL;
+    device_t* last_dev = NULL;
+    bool expect_address = false;
+    uint32_t wire_bytes = 0;
+    esp_err_t err = ESP_OK;
+
+    for (uint32_t i = 0; i < link->count && err == ESP_OK; i++) {
+        op_t* op = &link->ops[i];
+        switch (op->type) {
+        case OP_START:
+            elapsed_ns += bit_ns;
+            expect_address = true;
+            break;
+        case OP_WRITE:
+            for (size_t n = 0; n < op->len; n++) {
+                uint8_t byte = op->wdata ? op->wdata[n] : op->byte;
+                elapsed_ns += 9 * bit_ns;
+                wire_bytes++;
+                int64_t at_us = start_us + elapsed_ns / 1000;
+                bool acked;
+                if (expect_address) {
+                    expect_address = false;
+                    dev = find_device(port, byte >> 1);
+                    acked = dev != NULL;
+                    if (dev) {
+                        last_dev = dev;
+                        if (dev->ops->start) {
+                            dev->ops->start(dev->ctx, byte & 1);
+                        }
+                    }
+                } else {
+                    acked = dev && dev->ops->write && dev->ops->write(dev->ctx, byte, at_us);
+                }
+                if (!acked && op->ack_check) {
+                    err = ESP_FAIL;
+                    break;
+                }
+            }
+            break;
+        case OP_READ:
+            for (size_t n = 0; n < op->len; n++) {
+                elapsed_ns += 9 * bit_ns;
+                wire_bytes++;
+                int64_t at_us = start_us + elapsed_ns / 1000;
+                op->rdata[n] = (dev && dev->ops->read) ? dev->ops->read(dev->ctx, at_us) : 0xFF;
+            }
+            break;
+        case OP_STOP:
+            elapsed_ns += bit_ns;
+            break;
+        default:
+            break;
+        }
+    }
+
+    // A NACK ends the transaction with a STOP
+    if (err != ESP_OK) {
+        elapsed_ns += bit_ns;
+    }
+    if (last_dev && last_dev->ops->stop) {
+        last_dev->ops->stop(last_dev->ctx);
+    }
+
+    int64_t bus_time_us = (elapsed_ns + 999) / 1000;
+    sim_i2c_stats_t* counters[] = { &port->stats, last_dev ? &last_dev->stats : NULL };
+    for (int i = 0; i < 2; i++) {
+        if (counters[i] == NULL) {
+            continue;
+        }
+        counters[i]->transactions++;
+        counters[i]->bytes += wire_bytes;
+        counters[i]->bus_time_us += bus_time_us;
+        if (err != ESP_OK) {
+            counters[i]->nacks++;
+        }
+    }
+
+    sim_sleep_until(start_us + bus_time_us);
+    return err;
+}
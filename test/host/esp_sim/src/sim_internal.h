@@ -0,0 +1,65 @@
+#ifndef SIM_INTERNAL_H
+#define SIM_INTERNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Shared between the simulator's own modules
+
+/**
+ * @brief Blocks the caller until sim_wake(obj) or until deadline_us.
+ *
+ * Works from a task and from the test program, which keeps the scheduler
+ * running while it waits.
+ *
+ * @return false if the deadline passed first.
+ */
+bool sim_block(const void* obj, int64_t deadline_us);
+
+/**
+ * @brief Makes everything blocked on obj runnable again.
+ */
+void sim_wake(const void* obj);
+
+/**
+ * @brief Converts a FreeRTOS timeout in ticks to an absolute deadline.
+ *
+ * Timeouts expire on tick boundaries, as with the real tick interrupt;
+ * portMAX_DELAY gives INT64_MAX.
+ */
+int64_t sim_ticks_to_deadline(uint32_t ticks);
+
+/**
+ * @brief Blocks the caller until the given simulated time.
+ */
+void sim_sleep_until(int64_t at_us);
+
+/**
+ * @brief Brackets code that stands in for an interrupt handler.
+ */
+void sim_isr_enter(void);
+void sim_isr_exit(void);
+
+/**
+ * @brief Light sleep, driven by the scheduler.
+ *
+ * sim_pm_idle() is called when nothing is ready until next_deadline_us and
+ * enters light sleep if it is enabled and allowed. sim_pm_wake() leaves it
+ * when a timeout or device event is due. sim_pm_gpio_wake() is called for a
+ * wake pin's level during sleep and wakes the chip after the wakeup latency.
+ */
+void sim_pm_idle(int64_t next_deadline_us);
+void sim_pm_wake(void);
+void sim_pm_gpio_wake(void);
+
+/**
+ * @brief Runs the ISRs of pins whose interrupt was raised during light sleep.
+ */
+void sim_gpio_deliver_pending(void);
+
+/**
+ * @brief Advances seven BCD timekeeping registers (seconds to year, 24-hour mode) by one second.
+ */
+void sim_rtc_advance_second(uint8_t regs[7]);
+
+#endif // SIM_INTERNAL_H
@@ -0,0 +1,143 @@
+#include "sim.h"
+#include "sim_internal.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "freertos/FreeRTOS.h"
+#include <stdlib.h>
+
+// Tickless idle only sleeps when the next deadline is at least this far off
+// (CONFIG_FREERTOS_IDLE_TIME_BEFORE_SLEEP, 3 ticks by default)
+#define MIN_SLEEP_US (3 * 1000000 / configTICK_RATE_HZ)
+
+// From a GPIO wakeup until code runs again: clocks, flash and the interrupt
+// matrix come back first. Timed wakeups are started early to hide it.
+#define GPIO_WAKE_LATENCY_US 1000
+
+/**
+ * @brief An esp_pm lock. Only ESP_PM_NO_LIGHT_SLEEP affects the model.
+ */
+struct esp_pm_lock {
+    esp_pm_lock_type_t type;
+    uint32_t count;
+};
+
+// --- Private Module State ---
+static bool light_sleep_enabled = false;
+static bool gpio_wakeup_enabled = false;
+static uint32_t no_sleep_locks = 0;         // acquisitions of ESP_PM_NO_LIGHT_SLEEP locks
+static esp_pm_sleep_cbs_register_config_t sleep_cbs;
+static bool asleep = false;
+static int64_t asleep_since_us = 0;
+static uint32_t wake_event = 0;
+
+static void on_gpio_wake(void* arg) {
+    wake_event = 0;
+    sim_pm_wake();
+}
+
+// --- Simulation Control ---
+
+bool sim_pm_asleep(void) {
+    return asleep;
+}
+
+void sim_pm_idle(int64_t next_deadline_us) {
+    int64_t now = sim_now_us();
+    if (asleep || !light_sleep_enabled || no_sleep_locks > 0 || next_deadline_us - now < MIN_SLEEP_US) {
+        return;
+    }
+    if (sleep_cbs.enter_cb) {
+        sleep_cbs.enter_cb(next_deadline_us - now, sleep_cbs.enter_cb_user_arg);
+    }
+    asleep = true;
+    asleep_since_us = now;
+}
+
+void sim_pm_wake(void) {
+    if (!asleep) {
+        return;
+    }
+    asleep = false;
+    sim_cancel(wake_event);
+    wake_event = 0;
+    if (sleep_cbs.exit_cb) {
+        sleep_cbs.exit_cb(sim_now_us() - asleep_since_us, sleep_cbs.exit_cb_user_arg);
+    }
+    sim_gpio_deliver_pending();
+}
+
+void sim_pm_gpio_wake(void) {
+    if (asleep && gpio_wakeup_enabled && wake_event == 0) {
+        wake_event = sim_schedule(sim_now_us() + GPIO_WAKE_LATENCY_US, on_gpio_wake, NULL);
+    }
+}
+
+// --- Driver API ---
+
+esp_err_t esp_pm_configure(const void* config) {
+    if (config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const esp_pm_config_t* pm_config = config;
+    light_sleep_enabled = pm_config->light_sleep_enable;
+    if (!light_sleep_enabled) {
+        sim_pm_wake();
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_create(esp_pm_lock_type_t lock_type, int arg, const char* name, esp_pm_lock_handle_t* out_handle) {
+    if (out_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_pm_lock_handle_t lock = calloc(1, sizeof(struct esp_pm_lock));
+    if (lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    lock->type = lock_type;
+    *out_handle = lock;
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_acquire(esp_pm_lock_handle_t handle) {
+    if (handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    handle->count++;
+    if (handle->type == ESP_PM_NO_LIGHT_SLEEP) {
+        no_sleep_locks++;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_release(esp_pm_lock_handle_t handle) {
+    if (handle == NULL || handle->count == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    handle->count--;
+    if (handle->type == ESP_PM_NO_LIGHT_SLEEP) {
+        no_sleep_locks--;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_delete(esp_pm_lock_handle_t handle) {
+    if (handle == NULL || handle->count > 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    free(handle);
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_light_sleep_register_cbs(const esp_pm_sleep_cbs_register_config_t* cbs_conf) {
+    if (cbs_conf == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sleep_cbs = *cbs_conf;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup(void) {
+    gpio_wakeup_enabled = true;
+    return ESP_OK;
+}
@@ -0,0 +1,155 @@
+#include "sim.h"
+#include "sim_internal.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+/**
+ * @brief A queue. Semaphores use item_size 0 and only move count.
+ *
+ * Mutexes are binary semaphores that start full; there is no priority
+ * inheritance.
+ */
+struct sim_queue {
+    uint8_t* storage;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    bool is_static;
+};
+
+_Static_assert(sizeof(struct sim_queue) <= sizeof(StaticSemaphore_t), "StaticSemaphore_t too small");
+
+static bool try_send(QueueHandle_t queue, const void* item) {
+    if (queue->count >= queue->length) {
+        return false;
+    }
+    if (queue->item_size) {
+        UBaseType_t tail = (queue->head + queue->count) % queue->length;
+        memcpy(queue->storage + tail * queue->item_size, item, queue->item_size);
+    }
+    queue->count++;
+    sim_wake(queue);
+    return true;
+}
+
+static bool try_receive(QueueHandle_t queue, void* buffer) {
+    if (queue->count == 0) {
+        return false;
+    }
+    if (queue->item_size) {
+        memcpy(buffer, queue->storage + queue->head * queue->item_size, queue->item_size);
+        queue->head = (queue->head + 1) % queue->length;
+    }
+    queue->count--;
+    sim_wake(queue);
+    return true;
+}
+
+// --- Queues ---
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    if (length == 0) {
+        return NULL;
+    }
+    QueueHandle_t queue = calloc(1, sizeof(struct sim_queue));
+    if (queue == NULL) {
+        return NULL;
+    }
+    if (item_size) {
+        queue->storage = malloc((size_t)length * item_size);
+        if (queue->storage == NULL) {
+            free(queue);
+            return NULL;
+        }
+    }
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    if (queue == NULL || queue->is_static) {
+        return;
+    }
+    free(queue->storage);
+    free(queue);
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait) {
+    int64_t deadline_us = sim_ticks_to_deadline(ticks_to_wait);
+    while (!try_send(queue, item)) {
+        if (ticks_to_wait == 0 || !sim_block(queue, deadline_us)) {
+            return try_send(queue, item) ? pdTRUE : errQUEUE_FULL;
+        }
+    }
+    return pdTRUE;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higher_priority_task_woken) {
+    if (!try_send(queue, item)) {
+        return errQUEUE_FULL;
+    }
+    if (higher_priority_task_woken) {
+        *higher_priority_task_woken = pdTRUE;
+    }
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* buffer, TickType_t ticks_to_wait) {
+    int64_t deadline_us = sim_ticks_to_deadline(ticks_to_wait);
+    while (!try_receive(queue, buffer)) {
+        if (ticks_to_wait == 0 || !sim_block(queue, deadline_us)) {
+            return try_receive(queue, buffer) ? pdTRUE : errQUEUE_EMPTY;
+        }
+    }
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    return queue->count;
+}
+
+// --- Semaphores ---
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return xQueueCreate(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    SemaphoreHandle_t mutex = xQueueCreate(1, 0);
+    if (mutex) {
+        mutex->count = 1;
+    }
+    return mutex;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* buffer) {
+    SemaphoreHandle_t semaphore = (SemaphoreHandle_t)buffer;
+    memset(semaphore, 0, sizeof(*semaphore));
+    semaphore->length = 1;
+    semaphore->is_static = true;
+    return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count) {
+    SemaphoreHandle_t semaphore = xQueueCreate(max_count, 0);
+    if (semaphore) {
+        semaphore->count = initial_count;
+    }
+    return semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait) {
+    return xQueueReceive(semaphore, NULL, ticks_to_wait);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    return try_send(semaphore, NULL) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* higher_priority_task_woken) {
+    return xQueueSendFromISR(semaphore, NULL, higher_priority_task_woken);
+}
@@ -0,0 +1,43 @@
+#include "sim_internal.h"
+
+// Timekeeping chain shared by the DS1307 and DS3231 models
+
+static uint8_t bcd_inc(uint8_t bcd) {
+    return (bcd & 0x0F) == 9 ? (bcd & 0xF0) + 0x10 : bcd + 1;
+}
+
+static uint8_t bcd_to_bin(uint8_t bcd) {
+    return (bcd >> 4) * 10 + (bcd & 0x0F);
+}
+
+static uint8_t days_in_month(uint8_t month, uint8_t year) {
+    static const uint8_t days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month == 2 && year % 4 == 0) {
+        return 29; // both chips treat every year divisible by 4 as leap, through 2100
+    }
+    return (month >= 1 && month <= 12) ? days[month - 1] : 31;
+}
+
+void sim_rtc_advance_second(uint8_t r[7]) {
+    r[0] = bcd_inc(r[0] & 0x7F);
+    if (r[0] < 0x60) return;
+    r[0] = 0;
+    r[1] = bcd_inc(r[1]);
+    if (r[1] < 0x60) return;
+    r[1] = 0;
+    r[2] = bcd_inc(r[2] & 0x3F);
+    if (r[2] < 0x24) return;
+    r[2] = 0;
+    r[3] = r[3] >= 7 ? 1 : r[3] + 1;
+    if (bcd_to_bin(r[4]) < days_in_month(bcd_to_bin(r[5]), bcd_to_bin(r[6]))) {
+        r[4] = bcd_inc(r[4]);
+        return;
+    }
+    r[4] = 1;
+    if (r[5] < 0x12) {
+        r[5] = bcd_inc(r[5]);
+        return;
+    }
+    r[5] = 1;
+    r[6] = r[6] == 0x99 ? 0 : bcd_inc(r[6]);
+}
@@ -0,0 +1,488 @@
+#define _GNU_SOURCE
+#include "sim.h"
+#include "sim_internal.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include <stdio.h>
+#include <string.h>
+#include <ucontext.h>
+
+static const char *TAG = "SIM";
+
+#define TICK_US (1000000 / configTICK_RATE_HZ)
+
+// Host code (printf, libc) needs far more stack than the firmware budgets
+#define MIN_HOST_STACK_SIZE (64 * 1024)
+
+#define MAX_EVENTS 32
+
+typedef enum {
+    TASK_READY,
+    TASK_BLOCKED,
+    TASK_DELETED,
+} task_state_t;
+
+/**
+ * @brief A FreeRTOS task, run as a coroutine.
+ */
+struct sim_task {
+    ucontext_t context;
+    void* stack;
+    TaskFunction_t code;
+    void* arg;
+    char name[16];
+    UBaseType_t priority;
+    task_state_t state;
+    const void* wait_obj;           // what sim_wake() must be called with
+    int64_t wake_us;                // timeout, INT64_MAX for none
+    bool timed_out;
+    uint32_t notify_value;
+    uint64_t last_run;              // round robin among equal priorities
+    struct sim_task* next;
+};
+
+/**
+ * @brief A device-model event in interrupt context.
+ */
+typedef struct {
+    uint32_t id;                    // 0 when the slot is free
+    int64_t at_us;
+    void (*fn)(void* arg);
+    void* arg;
+} sim_event_t;
+
+// --- Private Module State ---
+static int64_t now_us = 0;
+static struct sim_task* tasks = NULL;
+static struct sim_task* current = NULL;     // NULL while the test program or an ISR runs
+static ucontext_t scheduler_context;
+static uint64_t dispatch_count = 0;
+static int isr_depth = 0;
+static int critical_depth = 0;
+static bool yield_pending = false;
+
+// The test program blocked inside a driver call
+static const void* main_wait_obj = NULL;
+static bool main_woken = false;
+
+static sim_event_t events[MAX_EVENTS];
+static uint32_t next_event_id = 1;
+
+// Nothing ever wakes this address; plain sleeps wait on it
+static const char sleep_obj;
+
+// --- Forward Declarations ---
+static struct sim_task* pick_ready(void);
+static void run_task(struct sim_task* task);
+static void advance_time(int64_t limit_us);
+static void step(int64_t limit_us);
+static void yield_current(void);
+static void maybe_preempt(UBaseType_t woken_priority);
+
+// --- Simulation Control ---
+
+int64_t sim_now_us(void) {
+    return now_us;
+}
+
+void sim_run_for(int64_t duration_us) {
+    int64_t end_us = now_us + duration_us;
+    while (1) {
+        struct sim_task* task = pick_ready();
+        if (task) {
+            run_task(task);
+        } else if (now_us >= end_us) {
+            return;
+        } else {
+            advance_time(end_us);
+        }
+    }
+}
+
+bool sim_run_until(bool (*done)(void* arg), void* arg, int64_t timeout_us) {
+    int64_t end_us = now_us + timeout_us;
+    while (!done(arg)) {
+        struct sim_task* task = pick_ready();
+        if (task) {
+            run_task(task);
+        } else if (now_us >= end_us) {
+            return false;
+        } else {
+            advance_time(end_us);
+        }
+    }
+    return true;
+}
+
+uint32_t sim_schedule(int64_t at_us, void (*fn)(void* arg), void* arg) {
+    for (int i = 0; i < MAX_EVENTS; i++) {
+        if (events[i].id == 0) {
+            events[i] = (sim_event_t){ .id = next_event_id++, .at_us = at_us, .fn = fn, .arg = arg };
+            return events[i].id;
+        }
+    }
+    ESP_LOGE(TAG, "Event table full");
+    return 0;
+}
+
+void sim_cancel(uint32_t id) {
+    for (int i = 0; i < MAX_EVENTS; i++) {
+        if (id != 0 && events[i].id == id) {
+            events[i].id = 0;
+        }
+    }
+}
+
+// --- Blocking Primitives ---
+
+bool sim_block(const void* obj, int64_t deadline_us) {
+    if (isr_depth > 0) {
+        fprintf(stderr, "sim: blocking call from interrupt context\n");
+        abort();
+    }
+
+    if (current) {
+        struct sim_task* self = current;
+        self->state = TASK_BLOCKED;
+        self->wait_obj = obj;
+        self->wake_us = deadline_us;
+        self->timed_out = false;
+        swapcontext(&self->context, &scheduler_context);
+        return !self->timed_out;
+    }
+
+    // The test program: keep the system running until it is woken
+    const void* saved_obj = main_wait_obj;
+    bool saved_woken = main_woken;
+    main_wait_obj = obj;
+    main_woken = false;
+    while (!main_woken && now_us < deadline_us) {
+        step(deadline_us);
+    }
+    bool woken = main_woken;
+    main_wait_obj = saved_obj;
+    main_woken = saved_woken;
+    return woken;
+}
+
+void sim_wake(const void* obj) {
+    UBaseType_t best = 0;
+    bool any = false;
+    for (struct sim_task* t = tasks; t; t = t->next) {
+        if (t->state == TASK_BLOCKED && t->wait_obj == obj) {
+            t->state = TASK_READY;
+            t->wait_obj = NULL;
+            if (!any || t->priority > best) {
+                best = t->priority;
+            }
+            any = true;
+        }
+    }
+    if (main_wait_obj == obj) {
+        main_woken = true;
+    }
+    if (any) {
+        maybe_preempt(best);
+    }
+}
+
+int64_t sim_ticks_to_deadline(uint32_t ticks) {
+    if (ticks == portMAX_DELAY) {
+        return INT64_MAX;
+    }
+    return (now_us / TICK_US + (int64_t)ticks) * TICK_US;
+}
+
+void sim_sleep_until(int64_t at_us) {
+    while (now_us < at_us) {
+        sim_block(&sleep_obj, at_us);
+    }
+}
+
+void sim_isr_enter(void) {
+    isr_depth++;
+}
+
+void sim_isr_exit(void) {
+    isr_depth--;
+}
+
+void sim_critical_enter(portMUX_TYPE* mux) {
+    (void)mux;
+    critical_depth++;
+}
+
+void sim_critical_exit(portMUX_TYPE* mux) {
+    (void)mux;
+    if (--critical_depth == 0 && yield_pending) {
+        yield_pending = false;
+        yield_current();
+    }
+}
+
+BaseType_t xPortInIsrContext(void) {
+    return isr_depth > 0 ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xPortGetCoreID(void) {
+    return 0;
+}
+
+void esp_rom_delay_us(uint32_t us) {
+    // Busy wait: nothing else runs meanwhile
+    now_us += us;
+}
+
+// --- Tasks ---
+
+static void task_entry(void) {
+    current->code(current->arg);
+    ESP_LOGE(TAG, "Task '%s' returned from its function", current->name);
+    vTaskDelete(NULL);
+}
+
+BaseType_t xTaskCreate(TaskFunction_t task_code, const char* name, uint32_t stack_depth, void* parameters,
+                       UBaseType_t priority, TaskHandle_t* created_task) {
+    struct sim_task* task = calloc(1, sizeof(struct sim_task));
+    if (task == NULL) {
+        return pdFAIL;
+    }
+    size_t stack_size = stack_depth > MIN_HOST_STACK_SIZE ? stack_depth : MIN_HOST_STACK_SIZE;
+    task->stack = malloc(stack_size);
+    if (task->stack == NULL) {
+        free(task);
+        return pdFAIL;
+    }
+    task->code = task_code;
+    task->arg = parameters;
+    task->priority = priority;
+    task->state = TASK_READY;
+    task->wake_us = INT64_MAX;
+    snprintf(task->name, sizeof(task->name), "%s", name ? name : "");
+
+    getcontext(&task->context);
+    task->context.uc_stack.ss_sp = task->stack;
+    task->context.uc_stack.ss_size = stack_size;
+    task->context.uc_link = NULL;
+    makecontext(&task->context, task_entry, 0);
+
+    // Append, so equal priorities start in creation order
+    struct sim_task** pos = &tasks;
+    while (*pos) {
+        pos = &(*pos)->next;
+    }
+    *pos = task;
+
+    if (created_task) {
+        *created_task = task;
+    }
+    maybe_preempt(priority);
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task_code, const char* name, uint32_t stack_depth,
+                                   void* parameters, UBaseType_t priority, TaskHandle_t* created_task,
+                                   BaseType_t core_id) {
+    (void)core_id;
+    return xTaskCreate(task_code, name, stack_depth, parameters, priority, created_task);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task == NULL) {
+        task = current;
+    }
+    if (task == NULL) {
+        return;
+    }
+    task->state = TASK_DELETED;
+    if (task == current) {
+        // run_task() frees it once we are off its stack
+        swapcontext(&task->context, &scheduler_context);
+        abort(); // never resumed
+    }
+    struct sim_task** pos = &tasks;
+    while (*pos && *pos != task) {
+        pos = &(*pos)->next;
+    }
+    if (*pos) {
+        *pos = task->next;
+    }
+    free(task->stack);
+    free(task);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    if (ticks == 0) {
+        taskYIELD();
+        return;
+    }
+    sim_sleep_until(sim_ticks_to_deadline(ticks));
+}
+
+void taskYIELD(void) {
+    if (current) {
+        yield_current();
+    }
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(now_us / TICK_US);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return current;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks(void) {
+    UBaseType_t count = 0;
+    for (struct sim_task* t = tasks; t; t = t->next) {
+        count++;
+    }
+    return count;
+}
+
+// --- Task Notifications ---
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    task->notify_value++;
+    sim_wake(task);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higher_priority_task_woken) {
+    task->notify_value++;
+    sim_wake(task);
+    if (higher_priority_task_woken) {
+        *higher_priority_task_woken = pdTRUE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait) {
+    struct sim_task* self = current;
+    if (self == NULL) {
+        return 0; // the test program has no notification value
+    }
+    int64_t deadline_us = sim_ticks_to_deadline(ticks_to_wait);
+    while (self->notify_value == 0 && ticks_to_wait != 0) {
+        if (!sim_block(self, deadline_us)) {
+            break;
+        }
+    }
+    uint32_t value = self->notify_value;
+    if (value != 0) {
+        self->notify_value = clear_on_exit ? 0 : value - 1;
+    }
+    return value;
+}
+
+// --- Private Functions ---
+
+static struct sim_task* pick_ready(void) {
+    struct sim_task* best = NULL;
+    for (struct sim_task* t = tasks; t; t = t->next) {
+        if (t->state != TASK_READY) {
+            continue;
+        }
+        if (best == NULL || t->priority > best->priority ||
+            (t->priority == best->priority && t->last_run < best->last_run)) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+static void run_task(struct sim_task* task) {
+    current = task;
+    task->last_run = ++dispatch_count;
+    swapcontext(&scheduler_context, &task->context);
+    current = NULL;
+
+    if (task->state == TASK_DELETED) {
+        vTaskDelete(task);
+    }
+}
+
+static void yield_current(void) {
+    struct sim_task* self = current;
+    self->state = TASK_READY;
+    swapcontext(&self->context, &scheduler_context);
+}
+
+// Called when a task of the given priority became ready
+static void maybe_preempt(UBaseType_t woken_priority) {
+    if (current == NULL || isr_depth > 0 || woken_priority <= current->priority) {
+        return;
+    }
+    if (critical_depth > 0) {
+        yield_pending = true;
+        return;
+    }
+    yield_current();
+}
+
+static void run_due_events(void) {
+    while (1) {
+        sim_event_t* due = NULL;
+        for (int i = 0; i < MAX_EVENTS; i++) {
+            if (events[i].id != 0 && events[i].at_us <= now_us && (due == NULL || events[i].at_us < due->at_us)) {
+                due = &events[i];
+            }
+        }
+        if (due == NULL) {
+            return;
+        }
+        sim_event_t event = *due;
+        due->id = 0;
+        sim_isr_enter();
+        event.fn(event.arg);
+        sim_isr_exit();
+    }
+}
+
+// Nothing is ready: jump to the next timeout or device event, but not past
+// limit_us. With light sleep enabled the chip may sleep through the gap.
+static void advance_time(int64_t limit_us) {
+    int64_t deadline_us = INT64_MAX;
+    for (struct sim_task* t = tasks; t; t = t->next) {
+        if (t->state == TASK_BLOCKED && t->wake_us < deadline_us) {
+            deadline_us = t->wake_us;
+        }
+    }
+    for (int i = 0; i < MAX_EVENTS; i++) {
+        if (events[i].id != 0 && events[i].at_us < deadline_us) {
+            deadline_us = events[i].at_us;
+        }
+    }
+    int64_t next_us = deadline_us < limit_us ? deadline_us : limit_us;
+    if (next_us == INT64_MAX) {
+        fprintf(stderr, "sim: deadlock, every task is blocked forever\n");
+        abort();
+    }
+    sim_pm_idle(deadline_us);
+    if (next_us > now_us) {
+        now_us = next_us;
+    }
+
+    if (deadline_us <= now_us) {
+        sim_pm_wake();
+    }
+    for (struct sim_task* t = tasks; t; t = t->next) {
+        if (t->state == TASK_BLOCKED && t->wake_us <= now_us) {
+            t->state = TASK_READY;
+            t->wait_obj = NULL;
+            t->timed_out = true;
+        }
+    }
+    run_due_events();
+}
+
+static void step(int64_t limit_us) {
+    struct sim_task* task = pick_ready();
+    if (task) {
+        run_task(task);
+    } else {
+        advance_time(limit_us);
+    }
+}
@@ -0,0 +1,70 @@
+#include "sim.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+// The linker routes gettimeofday/settimeofday/adjtime through these wrappers
+// (-Wl,--wrap=...), so the system clock never reads or sets the host's.
+
+#define ADJTIME_SHIFT 6             // slew rate 1/64, as ESP-IDF's ADJTIME_CORRECTION_FACTOR
+#define ADJTIME_MAX_S ((INT_MAX / 1000000L) - 1L)
+
+// --- Private Module State ---
+static int64_t offset_us;           // system time minus simulated time
+static int64_t adjust_remaining_us;
+static int64_t adjust_from_us;      // simulated time the remaining delta was last applied up to
+
+// Moves the pending adjtime() delta into the offset at the slew rate
+static void apply_adjustment(void) {
+    int64_t now = sim_now_us();
+    if (adjust_remaining_us == 0) {
+        adjust_from_us = now;
+        return;
+    }
+    int64_t step = (now - adjust_from_us) >> ADJTIME_SHIFT;
+    if (step > llabs(adjust_remaining_us)) {
+        step = llabs(adjust_remaining_us);
+    }
+    if (adjust_remaining_us < 0) {
+        step = -step;
+    }
+    offset_us += step;
+    adjust_remaining_us -= step;
+    adjust_from_us = adjust_remaining_us == 0 ? now : adjust_from_us + (llabs(step) << ADJTIME_SHIFT);
+}
+
+int __wrap_gettimeofday(struct timeval* tv, void* tz) {
+    apply_adjustment();
+    if (tv) {
+        int64_t now = sim_now_us() + offset_us;
+        tv->tv_sec = now / 1000000;
+        tv->tv_usec = now % 1000000;
+    }
+    return 0;
+}
+
+int __wrap_settimeofday(const struct timeval* tv, const void* tz) {
+    if (tv) {
+        offset_us = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec - sim_now_us();
+        adjust_remaining_us = 0; // as in ESP-IDF, setting the time cancels a slew
+    }
+    return 0;
+}
+
+int __wrap_adjtime(const struct timeval* delta, struct timeval* olddelta) {
+    apply_adjustment();
+    if (delta && llabs(delta->tv_sec) > ADJTIME_MAX_S) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (olddelta) {
+        olddelta->tv_sec = adjust_remaining_us / 1000000;
+        olddelta->tv_usec = adjust_remaining_us % 1000000;
+    }
+    if (delta) {
+        adjust_remaining_us = (int64_t)delta->tv_sec * 1000000 + delta->tv_usec;
+        adjust_from_us = sim_now_us();
+    }
+    return 0;
+}
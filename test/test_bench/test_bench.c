@@ -0,0 +1,1600 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unity.h>
+#include "sim.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "i2c_bus.h"
+#include "lcd_i2c.h"
+#include "ds1307.h"
+#include "ds3231.h"
+#include "display_server.h"
+#include "input_dispatcher.h"
+#include "button_reader.h"
+#include "rotary_encoder.h"
+#include "rotary_encoder_hal.h"
+#include "rtc_clock.h"
+#include "glyph_cache.h"
+#include "big_digits.h"
+#include "time_core.h"
+#include "time_sync.h"
+#include "alarm_scheduler.h"
+#include "alarm_store.h"
+#include "power_manager.h"
+#include "esp_pm.h"
+
+// --- Hardware Configuration (as in src/main.c) ---
+#define I2C_PORT        I2C_NUM_0
+#define I2C_FREQ_HZ     100000
+#define LCD_COLS        16
+#define LCD_ROWS        4
+#define BUTTON_GPIO     GPIO_NUM_25
+#define SPARE_GPIO      GPIO_NUM_26
+#define ROTARY_CLK_GPIO GPIO_NUM_19
+#define ROTARY_DT_GPIO  GPIO_NUM_18
+#define RTC_SQW_GPIO    GPIO_NUM_4
+
+// The DS3231 answers at the DS1307's address, so it gets a bus of its own
+#define DS3231_I2C_PORT I2C_NUM_1
+#define DS3231_INT_GPIO GPIO_NUM_5
+
+// --- Regression Thresholds ---
+// Every benchmark prints what it measured next to its limit. The limits sit
+// a little above the current figures, so a change that makes the display
+// path slower or chattier fails here. Lower them when an optimization lands.
+
+// All 64 cells change: 4 cursor moves + 64 characters, 4 PCF8574 bytes each
+#define FULL_REFRESH_MAX_TRANSACTIONS   3
+#define FULL_REFRESH_MAX_BYTES          280
+#define FULL_REFRESH_MAX_BUS_US         25500
+
+// One cell changes: 1 cursor move + 1 character
+#define ONE_CELL_MAX_TRANSACTIONS       1
+#define ONE_CELL_MAX_BYTES              9
+#define ONE_CELL_MAX_BUS_US             850
+
+// A redraw that changes nothing must not touch the bus
+#define NO_CHANGE_MAX_TRANSACTIONS      0
+
+// Interrupt-mode button, bouncing for 2.4 ms: the pin is confirmed 3 ms after
+// the first edge, then the change goes through the dispatcher, display server
+// and bus; the debounce window drops the rest of the bounce
+#define BUTTON_TO_PIXEL_MAX_US          5000
+#define BUTTON_BOUNCE_EDGES             6
+#define BUTTON_BOUNCE_INTERVAL_US       400
+
+// A single spike on the pin, shorter than the confirming read, is no press
+#define BUTTON_GLITCH_US                20
+#define BUTTON_GLITCH_MAX_EVENTS        0
+
+// Scan-mode buttons bouncing like the one above, each starting 1 ms after the
+// previous one: every pin reports exactly one press and one release. The host
+// time per 10 ms poll tick, simulator included, is the same for 3 and 30
+// buttons, since they are all sampled with one register read.
+#define SCAN_FEW_BUTTONS                3
+#define SCAN_MANY_BUTTONS               30
+#define SCAN_TICK_MAX_NS                2000.0
+
+// The same from light sleep: the press wakes the chip, about 1 ms, first
+#define BUTTON_WAKE_TO_PIXEL_MAX_US     6000
+
+// PCNT watch point to pixels: only the task hops and the flush
+#define ENCODER_TO_PIXEL_MAX_US         1500
+
+// 4000 steps/s for half a second; one event per watch point at most
+#define SPIN_STEPS                      2000
+#define SPIN_STEP_INTERVAL_US           250
+#define SPIN_MAX_EVENTS                 (SPIN_STEPS / 4)
+
+// The same spin drawn under a 30 ms frame budget: one flush per budget,
+// and no input waits much longer than one budget for its pixels
+#define FRAME_BUDGET_MS                 30
+#define SPIN_MAX_FRAMES                 20
+#define SPIN_INPUT_TO_PIXEL_MAX_US      35000
+
+// Steady state: the clock ticks, the time line changes every second
+#define CLOCK_FRAME_MAX_TRANSACTIONS    2
+#define CLOCK_FRAME_MAX_BUS_US          2000
+
+// Big-digit clock: redrawing the same digit shapes never reprograms CGRAM
+#define BIG_CLOCK_MAX_CGRAM_WRITES_PER_S 0.0
+
+// Marquee: a step over blank rows is a display shift plus the cell scrolling
+// in; with a static row on screen each step rewrites the marquee row instead
+#define MARQUEE_SHIFT_MAX_BYTES_PER_STEP   20
+#define MARQUEE_REWRITE_MAX_BYTES_PER_STEP 75
+
+// A panel that lost a nibble is noticed by the periodic cursor check and redrawn
+#define LCD_RECOVERY_MAX_US             11000000
+
+// A frame lost to a failed write is sent again by the next flush, here the next clock tick
+#define LCD_WRITE_FAILURE_MAX_US        1100000
+
+// A status read lost on the bus says nothing about the panel: no re-init, and
+// the cursor check is simply retried
+#define LCD_STATUS_NACK_MAX_REINITS     0
+
+// No byte may reach the controller while it is still busy, over the whole run
+#define LCD_MAX_BUSY_VIOLATIONS         0
+
+// Nothing on the steady-state paths may allocate
+#define STEADY_STATE_MAX_ALLOCS_PER_S   0.0
+
+// System clock against an RTC crystal 25 ppm fast, compared every 30 s: the
+// estimate settles within a fraction of a ppm and the clocks stay within
+// half the drift of one interval
+#define TIME_SYNC_RTC_DRIFT_PPM         25.0
+#define TIME_SYNC_INTERVAL_S            30
+#define TIME_SYNC_MAX_DRIFT_ERROR_PPM   0.5
+#define TIME_SYNC_MAX_OFFSET_US         500
+
+// DS3231 holding the next alarm with its ticks off: the bus stays quiet until
+// INT/SQW falls at the alarm second, which is acknowledged in three transfers.
+// Minute ticks cost the acknowledgement and one time read per minute.
+#define RTC_OFFLOAD_IDLE_MAX_TRANSACTIONS 0
+#define RTC_OFFLOAD_MAX_LATENCY_US        400
+#define RTC_MINUTE_TICK_MAX_TRANSACTIONS  4
+
+// Limits in host time depend on the machine. Shared CI runners (CI is set)
+// are slower and noisier, so there they only catch gross regressions.
+#define HOST_TIME_CI_SLACK              20.0
+
+// Host time for one RTC fields -> epoch -> fields round trip, every day of 2000-2099
+#define TIME_CORE_MAX_NS_PER_ROUND_TRIP 200.0
+
+// Host time for one alarm_scheduler_poll() over a full table of mixed
+// one-shot, daily and weekday alarms, stepping up to 4 h at a time, so a
+// poll fires about 20 of them
+#define ALARM_SCHEDULER_ALARMS          300
+#define ALARM_SCHEDULER_POLLS           5000
+#define ALARM_SCHEDULER_MAX_NS_PER_POLL 6000.0
+
+// Saving an alarm writes its older copy only: address, register, 5 bytes.
+// Loading is one burst read of the whole region.
+#define ALARM_STORE_SAVE_MAX_BYTES      7
+#define ALARM_STORE_LOAD_MAX_TRANSACTIONS 1
+
+// --- Application Model (mirrors render_status() in src/main.c) ---
+static volatile char g_button = ' ';
+static uint32_t g_button_events = 0;
+static volatile int32_t g_encoder = 0;
+static uint32_t g_encoder_events = 0;
+static volatile bool g_big_clock = false;
+static volatile bool g_screen_paused = false; // leaves the screen to the marquee bench
+
+static void render(void* user_data) {
+    char line[32]; // lcd_i2c_fb_write_line() cuts it to LCD_COLS
+    if (g_screen_paused) {
+        return;
+    }
+    if (g_button != ' ') {
+        snprintf(line, sizeof(line), "Button: %c", g_button);
+    } else {
+        snprintf(line, sizeof(line), "Button: None");
+    }
+    lcd_i2c_fb_write_line(2, line);
+    snprintf(line, sizeof(line), "Encoder: %ld", (long)g_encoder);
+    lcd_i2c_fb_write_line(3, line);
+}
+
+static void on_button(button_handle_t handle, button_event_t event, void* user_data) {
+    g_button_events++;
+    if (event == BUTTON_EVENT_PRESS) {
+        g_button = 'A';
+    } else if (event == BUTTON_EVENT_RELEASE) {
+        g_button = ' ';
+    }
+    display_server_note_input(input_dispatcher_event_time());
+    display_server_request_redraw();
+}
+
+static void on_rotation(rotary_encoder_handle_t handle, const rotary_encoder_event_t* event, void* user_data) {
+    g_encoder += event->delta;
+    g_encoder_events++;
+    display_server_note_input(input_dispatcher_event_time());
+    display_server_request_redraw();
+}
+
+static void on_clock_tick(const rtc_time_t* time, void* user_data) {
+    char line[32];
+    if (g_screen_paused) {
+        return;
+    }
+    if (g_big_clock) {
+        big_digits_draw_time(0, 0, time->hours, time->minutes);
+        line[0] = ' ';
+        *time_core_put_two_digits(&line[1], time->seconds) = '\0';
+        display_server_put_text(1, BIG_DIGITS_TIME_COLS, line);
+        return;
+    }
+    display_server_put_line(0, time_core_format_time(time, line));
+    display_server_put_line(1, time_core_format_date(time, line));
+}
+
+// --- Helpers ---
+
+static void report(const char* name, double value, const char* unit, double limit) {
+    char message[128];
+    snprintf(message, sizeof(message), "%-28s %10.1f %-8s (limit %.1f)", name, value, unit, limit);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE_MESSAGE(value <= limit, message);
+}
+
+static double host_time_limit(double limit) {
+    return getenv("CI") != NULL ? limit * HOST_TIME_CI_SLACK : limit;
+}
+
+static int64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static sim_i2c_stats_t lcd_stats(void) {
+    sim_i2c_stats_t stats;
+    sim_i2c_get_stats(I2C_PORT, LCD_I2C_DEFAULT_ADDRESS, &stats);
+    return stats;
+}
+
+static sim_i2c_stats_t stats_since(sim_i2c_stats_t before) {
+    sim_i2c_stats_t after = lcd_stats();
+    after.transactions -= before.transactions;
+    after.bytes -= before.bytes;
+    after.nacks -= before.nacks;
+    after.bus_time_us -= before.bus_time_us;
+    return after;
+}
+
+typedef struct {
+    uint8_t row;
+    const char* text;
+} row_match_t;
+
+// True once the row starts with the given text
+static bool row_shows(void* arg) {
+    const row_match_t* match = arg;
+    char row[LCD_COLS + 1];
+    sim_lcd_get_row(match->row, row);
+    return strncmp(row, match->text, strlen(match->text)) == 0;
+}
+
+// Time from start_us until the last cell of the match was written
+static int64_t wait_for_row(uint8_t row, const char* text, int64_t start_us) {
+    row_match_t match = { .row = row, .text = text };
+    TEST_ASSERT_TRUE_MESSAGE(sim_run_until(row_shows, &match, 1000000), text);
+    int64_t latest = 0;
+    for (uint8_t col = 0; col < strlen(text); col++) {
+        int64_t written = sim_lcd_cell_written_us(row, col);
+        if (written > latest) {
+            latest = written;
+        }
+    }
+    return latest - start_us;
+}
+
+static void bring_up(void) {
+    esp_log_level_set("*", ESP_LOG_WARN);
+    sim_lcd_attach(I2C_PORT, LCD_I2C_DEFAULT_ADDRESS, LCD_COLS, LCD_ROWS);
+    sim_ds1307_attach(I2C_PORT, DS1307_I2C_ADDRESS, RTC_SQW_GPIO);
+
+    i2c_bus_config_t bus_conf = {
+        .i2c_port = I2C_PORT,
+        .sda_pin = 21,
+        .scl_pin = 22,
+        .clk_speed = I2C_FREQ_HZ,
+    };
+    ESP_ERROR_CHECK(i2c_bus_init(&bus_conf));
+    ds1307_config_t ds1307_conf = { .i2c_port = I2C_PORT };
+    ESP_ERROR_CHECK(ds1307_init(&ds1307_conf));
+    lcd_i2c_config_t lcd_conf = {
+        .i2c_port = I2C_PORT,
+        .i2c_address = LCD_I2C_DEFAULT_ADDRESS,
+        .cols = LCD_COLS,
+        .rows = LCD_ROWS,
+        .read_busy_flag = true,
+    };
+    ESP_ERROR_CHECK(lcd_i2c_init(&lcd_conf));
+
+    display_server_config_t display_conf = {
+        .queue_size = 16,
+        .task_priority = 5,
+        .render_cb = render,
+        .frame_budget_ms = FRAME_BUDGET_MS,
+    };
+    ESP_ERROR_CHECK(display_server_start(&display_conf));
+    input_dispatcher_config_t input_conf = {
+        .queue_size = 16,
+        .task_priority = 5,
+    };
+    ESP_ERROR_CHECK(input_dispatcher_start(&input_conf));
+
+    rotary_encoder_config_t rotary_conf = {
+        .clk_pin = ROTARY_CLK_GPIO,
+        .dt_pin = ROTARY_DT_GPIO,
+        .backend = ROTARY_ENCODER_BACKEND_PCNT,
+    };
+    rotary_encoder_handle_t encoder = rotary_encoder_create(&rotary_conf);
+    rotary_encoder_register_callback(encoder, on_rotation, NULL);
+
+    sim_gpio_set_level(BUTTON_GPIO, 1); // released, active low
+    button_config_t button_conf = {
+        .gpio_num = BUTTON_GPIO,
+        .active_level = 0,
+        .mode = BUTTON_MODE_INTERRUPT,
+    };
+    button_handle_t button = button_create(&button_conf);
+    button_register_callback(button, on_button);
+
+    display_server_request_redraw();
+    sim_run_for(100000);
+}
+
+// --- Benchmarks ---
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void bench_full_refresh(void) {
+    static const char* lines[] = {"0123456789abcdef", "ghijklmnopqrstuv", "wxyzABCDEFGHIJKL", "MNOPQRSTUVWXYZ#%"};
+    sim_i2c_stats_t before = lcd_stats();
+    for (uint8_t row = 0; row < LCD_ROWS; row++) {
+        display_server_put_line(row, lines[row]);
+    }
+    sim_run_for(100000);
+    sim_i2c_stats_t cost = stats_since(before);
+
+    char row[LCD_COLS + 1];
+    for (uint8_t r = 0; r < LCD_ROWS; r++) {
+        sim_lcd_get_row(r, row);
+        TEST_ASSERT_EQUAL_STRING(lines[r], row);
+    }
+    report("full refresh transactions", cost.transactions, "", FULL_REFRESH_MAX_TRANSACTIONS);
+    report("full refresh bytes", cost.bytes, "bytes", FULL_REFRESH_MAX_BYTES);
+    report("full refresh bus time", cost.bus_time_us, "us", FULL_REFRESH_MAX_BUS_US);
+}
+
+static void bench_one_cell_update(void) {
+    sim_i2c_stats_t before = lcd_stats();
+    display_server_put_text(1, 7, "*");
+    sim_run_for(100000);
+    sim_i2c_stats_t cost = stats_since(before);
+
+    row_match_t match = { .row = 1, .text = "ghijklm*" };
+    TEST_ASSERT_TRUE(row_shows(&match));
+    report("one cell transactions", cost.transactions, "", ONE_CELL_MAX_TRANSACTIONS);
+    report("one cell bytes", cost.bytes, "bytes", ONE_CELL_MAX_BYTES);
+    report("one cell bus time", cost.bus_time_us, "us", ONE_CELL_MAX_BUS_US);
+}
+
+static void bench_unchanged_redraw(void) {
+    display_server_request_redraw();
+    sim_run_for(100000); // the first redraw restores rows 2 and 3
+    sim_i2c_stats_t before = lcd_stats();
+    display_server_request_redraw();
+    sim_run_for(100000);
+    report("no-change redraw transactions", stats_since(before).transactions, "", NO_CHANGE_MAX_TRANSACTIONS);
+}
+
+static void bench_button_to_pixel(void) {
+    // Press at different phases of the tick and of the bus schedule
+    static const int64_t phases_us[] = {0, 1700, 4300, 7900, 9999};
+    const size_t presses = sizeof(phases_us) / sizeof(phases_us[0]);
+    int64_t worst = 0;
+    int64_t total = 0;
+    for (size_t i = 0; i < presses; i++) {
+        sim_run_for(phases_us[i]);
+        uint32_t events = g_button_events;
+        int64_t pressed_at = sim_now_us();
+        sim_gpio_set_level(BUTTON_GPIO, 0);
+        for (int edge = 1; edge <= BUTTON_BOUNCE_EDGES; edge++) {
+            sim_run_for(BUTTON_BOUNCE_INTERVAL_US);
+            sim_gpio_set_level(BUTTON_GPIO, edge % 2);
+        }
+        int64_t latency = wait_for_row(2, "Button: A", pressed_at);
+        worst = latency > worst ? latency : worst;
+        total += latency;
+
+        sim_run_for(200000);
+        sim_gpio_set_level(BUTTON_GPIO, 1);
+        for (int edge = 1; edge <= BUTTON_BOUNCE_EDGES; edge++) {
+            sim_run_for(BUTTON_BOUNCE_INTERVAL_US);
+            sim_gpio_set_level(BUTTON_GPIO, (edge + 1) % 2);
+        }
+        wait_for_row(2, "Button: None", sim_now_us());
+        sim_run_for(200000);
+        TEST_ASSERT_EQUAL_UINT32(events + 2, g_button_events); // one press, one release
+    }
+    report("button-to-pixel mean", (double)total / presses, "us", BUTTON_TO_PIXEL_MAX_US);
+    report("button-to-pixel worst", worst, "us", BUTTON_TO_PIXEL_MAX_US);
+}
+
+static void bench_button_glitch(void) {
+    uint32_t events = g_button_events;
+    sim_gpio_set_level(BUTTON_GPIO, 0);
+    sim_run_for(BUTTON_GLITCH_US);
+    sim_gpio_set_level(BUTTON_GPIO, 1);
+    sim_run_for(200000);
+
+    // The next real press still goes through
+    sim_gpio_set_level(BUTTON_GPIO, 0);
+    sim_run_for(200000);
+    sim_gpio_set_level(BUTTON_GPIO, 1);
+    sim_run_for(200000);
+    TEST_ASSERT_EQUAL_UINT32(events + 2, g_button_events);
+    report("button glitch events", g_button_events - events - 2, "", BUTTON_GLITCH_MAX_EVENTS);
+}
+
+static void bench_button_delete(void) {
+    // Delete an interrupt-mode button between its edge and the confirming
+    // read: nothing may be reported and the handle and its timer are freed
+    sim_heap_stats_t before;
+    sim_heap_get_stats(&before);
+    sim_gpio_set_level(SPARE_GPIO, 1);
+    button_config_t conf = {
+        .gpio_num = SPARE_GPIO,
+        .active_level = 0,
+        .mode = BUTTON_MODE_INTERRUPT,
+    };
+    button_handle_t spare = button_create(&conf);
+    button_register_callback(spare, on_button);
+    uint32_t events = g_button_events;
+    sim_gpio_set_level(SPARE_GPIO, 0);
+    sim_run_for(1000);
+    TEST_ASSERT_EQUAL_INT(ESP_OK, button_delete(spare));
+    sim_run_for(100000);
+    sim_gpio_set_level(SPARE_GPIO, 1);
+    sim_run_for(100000);
+
+    sim_heap_stats_t after;
+    sim_heap_get_stats(&after);
+    TEST_ASSERT_EQUAL_UINT32(before.bytes_in_use, after.bytes_in_use);
+    report("deleted button events", g_button_events - events, "", BUTTON_GLITCH_MAX_EVENTS);
+}
+
+// Pins not wired to anything else in the bench
+static const gpio_num_t scan_pins[SCAN_MANY_BUTTONS] = {
+    0, 1, 2, 3, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16,
+    17, 20, 23, 24, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37,
+};
+static uint32_t scan_presses[SCAN_MANY_BUTTONS];
+static uint32_t scan_releases[SCAN_MANY_BUTTONS];
+
+static void on_scan_button(button_handle_t handle, button_event_t event, void* user_data) {
+    const gpio_num_t* pin = user_data;
+    if (event == BUTTON_EVENT_PRESS) {
+        scan_presses[pin - scan_pins]++;
+    } else if (event == BUTTON_EVENT_RELEASE) {
+        scan_releases[pin - scan_pins]++;
+    }
+}
+
+// Active at time t (us) into the run: held for 200 ms, bouncing for
+// BUTTON_BOUNCE_EDGES edges at either end, each pin starting 1 ms later
+static bool scan_pin_active(size_t index, int64_t t) {
+    const int64_t bounce_us = BUTTON_BOUNCE_EDGES * BUTTON_BOUNCE_INTERVAL_US;
+    t -= (int64_t)index * 1000;
+    if (t < 0 || t >= 200000 + bounce_us) {
+        return false;
+    }
+    if (t < bounce_us) {
+        return (t / BUTTON_BOUNCE_INTERVAL_US) % 2 == 0;
+    }
+    if (t >= 200000) {
+        return (t - 200000) / BUTTON_BOUNCE_INTERVAL_US % 2 == 1;
+    }
+    return true;
+}
+
+// Returns the host time per poll tick with the buttons idle
+static double scan_buttons(size_t count) {
+    button_handle_t buttons[SCAN_MANY_BUTTONS];
+    for (size_t i = 0; i < count; i++) {
+        sim_gpio_set_level(scan_pins[i], 1); // released, active low
+        button_config_t conf = {
+            .gpio_num = scan_pins[i],
+            .active_level = 0,
+            .mode = BUTTON_MODE_SCAN,
+            .user_data = (void*)&scan_pins[i],
+        };
+        buttons[i] = button_create(&conf);
+        TEST_ASSERT_TRUE(buttons[i] != NULL);
+        button_register_callback(buttons[i], on_scan_button);
+        scan_presses[i] = 0;
+        scan_releases[i] = 0;
+    }
+    sim_run_for(100000);
+
+    const int ticks = 500;
+    int64_t start_ns = monotonic_ns();
+    sim_run_for(ticks * 10000LL);
+    double tick_ns = (double)(monotonic_ns() - start_ns) / ticks;
+
+    const int64_t step_us = 100;
+    for (int64_t t = 0; t < 300000; t += step_us) {
+        for (size_t i = 0; i < count; i++) {
+            if (scan_pin_active(i, t) != scan_pin_active(i, t - step_us)) {
+                sim_gpio_set_level(scan_pins[i], !scan_pin_active(i, t));
+            }
+        }
+        sim_run_for(step_us);
+    }
+    sim_run_for(100000);
+
+    for (size_t i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_UINT32(1, scan_presses[i]);
+        TEST_ASSERT_EQUAL_UINT32(1, scan_releases[i]);
+        TEST_ASSERT_EQUAL_INT(ESP_OK, button_delete(buttons[i]));
+    }
+    sim_run_for(100000);
+    return tick_ns;
+}
+
+static void bench_scan_buttons(void) {
+    double few_ns = scan_buttons(SCAN_FEW_BUTTONS);
+    double many_ns = scan_buttons(SCAN_MANY_BUTTONS);
+    report("scan tick, 3 buttons", few_ns, "ns", host_time_limit(SCAN_TICK_MAX_NS));
+    report("scan tick, 30 buttons", many_ns, "ns", host_time_limit(SCAN_TICK_MAX_NS));
+}
+
+// --- Gestures ---
+
+#define GESTURE_CHORD 0xFF // logged in place of a button event
+
+typedef struct {
+    size_t button;                  // index into scan_pins
+    int event;                      // button_event_t or GESTURE_CHORD
+    uint32_t count;                 // click or repeat count read through the getters
+} gesture_t;
+
+typedef struct {
+    gesture_t gesture;
+    int64_t at_us;                  // event time
+} gesture_entry_t;
+
+static gesture_entry_t gesture_log[64];
+static size_t gesture_entries;
+
+static void log_gesture(size_t button, int event, uint32_t count) {
+    TEST_ASSERT_TRUE(gesture_entries < sizeof(gesture_log) / sizeof(gesture_log[0]));
+    gesture_log[gesture_entries++] = (gesture_entry_t){ { button, event, count }, input_dispatcher_event_time() };
+}
+
+static void on_gesture(button_handle_t handle, button_event_t event, void* user_data) {
+    uint32_t count = 0;
+    if (event == BUTTON_EVENT_CLICK) {
+        count = button_get_click_count(handle);
+    } else if (event == BUTTON_EVENT_REPEAT) {
+        count = button_get_repeat_count(handle);
+    }
+    log_gesture((const gpio_num_t*)user_data - scan_pins, event, count);
+}
+
+static void on_gesture_chord(button_chord_handle_t chord, void* user_data) {
+    log_gesture(0, GESTURE_CHORD, 0);
+}
+
+static button_handle_t gesture_button(size_t index, const button_config_t* gestures) {
+    button_config_t conf = *gestures;
+    conf.gpio_num = scan_pins[index];
+    conf.active_level = 0;
+    conf.mode = BUTTON_MODE_INTERRUPT;
+    conf.user_data = (void*)&scan_pins[index];
+    sim_gpio_set_level(scan_pins[index], 1);
+    button_handle_t button = button_create(&conf);
+    TEST_ASSERT_TRUE(button != NULL);
+    button_register_callback(button, on_gesture);
+    return button;
+}
+
+// Holds button index down for hold_us, then lets go and waits gap_us
+static void gesture_press(size_t index, int64_t hold_us, int64_t gap_us) {
+    sim_gpio_set_level(scan_pins[index], 0);
+    sim_run_for(hold_us);
+    sim_gpio_set_level(scan_pins[index], 1);
+    sim_run_for(gap_us);
+}
+
+// Checks the logged events against button/event/count triples and clears the log
+static void expect_gestures(const gesture_t* expected, size_t count) {
+    TEST_ASSERT_EQUAL_UINT32(count, gesture_entries);
+    for (size_t i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_UINT32(expected[i].button, gesture_log[i].gesture.button);
+        TEST_ASSERT_EQUAL_INT(expected[i].event, gesture_log[i].gesture.event);
+        TEST_ASSERT_EQUAL_UINT32(expected[i].count, gesture_log[i].gesture.count);
+    }
+    gesture_entries = 0;
+}
+
+static void bench_button_gestures(void) {
+    gesture_entries = 0;
+
+    // Multi-click: a double click ends after the gap, a triple click at once
+    button_config_t clicks = { .max_clicks = 3 };
+    button_handle_t a = gesture_button(0, &clicks);
+    sim_run_for(100000);
+    gesture_press(0, 50000, 100000);
+    gesture_press(0, 50000, 400000);
+    static const gesture_t double_click[] = {
+        { 0, BUTTON_EVENT_PRESS, 0 }, { 0, BUTTON_EVENT_RELEASE, 0 },
+        { 0, BUTTON_EVENT_PRESS, 0 }, { 0, BUTTON_EVENT_RELEASE, 0 },
+        { 0, BUTTON_EVENT_CLICK, 2 },
+    };
+    expect_gestures(double_click, sizeof(double_click) / sizeof(double_click[0]));
+    for (int i = 0; i < 3; i++) {
+        gesture_press(0, 50000, 100000);
+    }
+    TEST_ASSERT_TRUE(gesture_log[5].at_us == gesture_log[6].at_us); // with the last release
+    static const gesture_t triple_click[] = {
+        { 0, BUTTON_EVENT_PRESS, 0 }, { 0, BUTTON_EVENT_RELEASE, 0 },
+        { 0, BUTTON_EVENT_PRESS, 0 }, { 0, BUTTON_EVENT_RELEASE, 0 },
+        { 0, BUTTON_EVENT_PRESS, 0 }, { 0, BUTTON_EVENT_RELEASE, 0 },
+        { 0, BUTTON_EVENT_CLICK, 3 },
+    };
+    expect_gestures(triple_click, sizeof(triple_click) / sizeof(triple_click[0]));
+    TEST_ASSERT_EQUAL_INT(ESP_OK, button_delete(a));
+
+    // Long press: the hold is not also a click; a short press still is
+    button_config_t long_press = { .long_press_ms = 500, .max_clicks = 1 };
+    a = gesture_button(0, &long_press);
+    sim_run_for(100000);
+    gesture_press(0, 800000, 100000);
+    gesture_press(0, 50000, 100000);
+    static const gesture_t held[] = {
+        { 0, BUTTON_EVENT_PRESS, 0 }, { 0, BUTTON_EVENT_LONG_PRESS, 0 }, { 0, BUTTON_EVENT_RELEASE, 0 },
+        { 0, BUTTON_EVENT_PRESS, 0 }, { 0, BUTTON_EVENT_RELEASE, 0 }, { 0, BUTTON_EVENT_CLICK, 1 },
+    };
+    expect_gestures(held, sizeof(held) / sizeof(held[0]));
+    TEST_ASSERT_EQUAL_INT(ESP_OK, button_delete(a));
+
+    // Repeat: the interval shrinks by 20% per repeat down to its floor
+    button_config_t repeat = {
+        .max_clicks = 1,
+        .repeat_delay_ms = 300,
+        .repeat_interval_ms = 100,
+        .repeat_accel_pct = 20,
+        .repeat_min_interval_ms = 50,
+    };
+    static const int64_t repeat_gaps_ms[] = { 300, 100, 80, 64, 52, 50, 50, 50, 50, 50 };
+    const size_t repeats = sizeof(repeat_gaps_ms) / sizeof(repeat_gaps_ms[0]);
+    a = gesture_button(0, &repeat);
+    sim_run_for(100000);
+    gesture_press(0, 870000, 100000); // let go between the 10th and 11th repeats, 846 and 896 ms in
+    TEST_ASSERT_EQUAL_UINT32(repeats + 2, gesture_entries);
+    TEST_ASSERT_EQUAL_INT(BUTTON_EVENT_PRESS, gesture_log[0].gesture.event);
+    for (size_t i = 1; i <= repeats; i++) {
+        TEST_ASSERT_EQUAL_INT(BUTTON_EVENT_REPEAT, gesture_log[i].gesture.event);
+        TEST_ASSERT_EQUAL_UINT32(i, gesture_log[i].gesture.count);
+        TEST_ASSERT_EQUAL_UINT32(repeat_gaps_ms[i - 1] * 1000, gesture_log[i].at_us - gesture_log[i - 1].at_us);
+    }
+    TEST_ASSERT_EQUAL_INT(BUTTON_EVENT_RELEASE, gesture_log[repeats + 1].gesture.event); // and no click
+    gesture_entries = 0;
+    TEST_ASSERT_EQUAL_INT(ESP_OK, button_delete(a));
+
+    // Chord: its members' presses and releases still arrive, their clicks do not
+    button_config_t member = { .max_clicks = 1 };
+    a = gesture_button(0, &member);
+    button_handle_t b = gesture_button(1, &member);
+    button_chord_config_t chord_conf = {
+        .buttons = { a, b },
+        .num_buttons = 2,
+        .hold_ms = 100,
+        .callback = on_gesture_chord,
+    };
+    button_chord_handle_t chord = button_chord_create(&chord_conf);
+    TEST_ASSERT_TRUE(chord != NULL);
+    sim_run_for(100000);
+    sim_gpio_set_level(scan_pins[0], 0);
+    sim_run_for(20000);
+    gesture_press(1, 200000, 0);
+    gesture_press(0, 0, 400000);
+    static const gesture_t chorded[] = {
+        { 0, BUTTON_EVENT_PRESS, 0 }, { 1, BUTTON_EVENT_PRESS, 0 }, { 0, GESTURE_CHORD, 0 },
+        { 1, BUTTON_EVENT_RELEASE, 0 }, { 0, BUTTON_EVENT_RELEASE, 0 },
+    };
+    expect_gestures(chorded, sizeof(chorded) / sizeof(chorded[0]));
+    TEST_ASSERT_EQUAL_INT(ESP_OK, button_chord_delete(chord));
+    TEST_ASSERT_EQUAL_INT(ESP_OK, button_delete(a));
+    TEST_ASSERT_EQUAL_INT(ESP_OK, button_delete(b));
+    sim_run_for(100000);
+}
+
+static void bench_button_wake_to_pixel(void) {
+    static const power_manager_wake_pin_t wake_pins[] = {
+        { BUTTON_GPIO, GPIO_INTR_ANYEDGE },
+    };
+    power_manager_config_t pm_conf = {
+        .max_freq_mhz = 240,
+        .min_freq_mhz = 40,
+        .light_sleep = true,
+        .wake_pins = wake_pins,
+        .num_wake_pins = sizeof(wake_pins) / sizeof(wake_pins[0]),
+    };
+    TEST_ASSERT_TRUE(power_manager_start(&pm_conf) == ESP_OK);
+    sim_run_for(500000);
+    TEST_ASSERT_TRUE(sim_pm_asleep());
+
+    int64_t pressed_at = sim_now_us();
+    sim_gpio_set_level(BUTTON_GPIO, 0);
+    int64_t latency = wait_for_row(2, "Button: A", pressed_at);
+    sim_run_for(200000);
+    sim_gpio_set_level(BUTTON_GPIO, 1);
+    wait_for_row(2, "Button: None", sim_now_us());
+    sim_run_for(200000);
+    power_manager_stats_t stats;
+    power_manager_get_stats(&stats);
+    TEST_ASSERT_TRUE(stats.sleeps > 0);
+
+    // The other benches run awake
+    esp_pm_config_t awake = { .max_freq_mhz = 240, .min_freq_mhz = 240, .light_sleep_enable = false };
+    esp_pm_configure(&awake);
+    report("button-to-pixel from sleep", latency, "us", BUTTON_WAKE_TO_PIXEL_MAX_US);
+}
+
+static void bench_encoder_to_pixel(void) {
+    char expected[32];
+    snprintf(expected, sizeof(expected), "Encoder: %ld", (long)g_encoder + 4);
+    int64_t turned_at = sim_now_us();
+    rotary_encoder_counter_sim_rotate(4);
+    report("encoder-to-pixel", wait_for_row(3, expected, turned_at), "us", ENCODER_TO_PIXEL_MAX_US);
+}
+
+static void bench_encoder_fast_spin(void) {
+    int32_t start = g_encoder;
+    uint32_t events_before = g_encoder_events;
+    uint32_t dropped_before = input_dispatcher_dropped();
+    for (int i = 0; i < SPIN_STEPS; i++) {
+        rotary_encoder_counter_sim_rotate(1);
+        sim_run_for(SPIN_STEP_INTERVAL_US);
+    }
+    sim_run_for(100000);
+
+    // Whole watch steps only: the residual stays in the counter until the next event
+    TEST_ASSERT_EQUAL_INT32(start + SPIN_STEPS, g_encoder);
+    TEST_ASSERT_EQUAL_UINT32(dropped_before, input_dispatcher_dropped());
+    report("fast spin events", g_encoder_events - events_before, "events", SPIN_MAX_EVENTS);
+}
+
+static void ignore_event(const input_event_t* event) {}
+
+static void bench_encoder_full_queue(void) {
+    // Fill the dispatcher queue before the knob moves: the motion event is
+    // refused, and the steps must still arrive once the queue drains
+    int32_t start = g_encoder;
+    uint32_t dropped_before = input_dispatcher_dropped();
+    input_event_t filler = { .deliver = ignore_event };
+    while (input_dispatcher_post(&filler, 0) == ESP_OK) {
+    }
+    rotary_encoder_counter_sim_rotate(4);
+    TEST_ASSERT_TRUE(input_dispatcher_dropped() > dropped_before);
+    sim_run_for(100000);
+    TEST_ASSERT_EQUAL_INT32(start + 4, g_encoder);
+}
+
+static void bench_frame_budget(void) {
+    display_server_reset_stats();
+    int32_t start = g_encoder;
+    for (int i = 0; i < SPIN_STEPS; i++) {
+        rotary_encoder_counter_sim_rotate(1);
+        sim_run_for(SPIN_STEP_INTERVAL_US);
+    }
+    sim_run_for(100000);
+
+    char expected[32];
+    snprintf(expected, sizeof(expected), "Encoder: %ld", (long)(start + SPIN_STEPS));
+    row_match_t match = { .row = 3, .text = expected };
+    TEST_ASSERT_TRUE(row_shows(&match));
+
+    display_server_stats_t stats;
+    display_server_get_stats(&stats);
+    TEST_ASSERT_TRUE(stats.input_frames > 0);
+    report("spin frames", stats.frames, "frames", SPIN_MAX_FRAMES);
+    report("spin input-to-pixel mean", (double)stats.total_latency_us / stats.input_frames, "us",
+           SPIN_INPUT_TO_PIXEL_MAX_US);
+    report("spin input-to-pixel worst", stats.max_latency_us, "us", SPIN_INPUT_TO_PIXEL_MAX_US);
+}
+
+static void bench_clock_frames(void) {
+    rtc_time_t time = { .seconds = 55, .minutes = 59, .hours = 23, .day = 1, .date = 31, .month = 12, .year = 24 };
+    ESP_ERROR_CHECK(ds1307_set_time(&time));
+    rtc_clock_config_t clock_conf = {
+        .device = &ds1307_rtc_device,
+        .sqw_pin = RTC_SQW_GPIO,
+        .resync_interval_s = 3600,
+        .task_priority = 5,
+        .tick_cb = on_clock_tick,
+    };
+    ESP_ERROR_CHECK(rtc_clock_start(&clock_conf));
+    sim_run_for(2500000);
+
+    const int seconds = 10;
+    sim_i2c_stats_t before = lcd_stats();
+    sim_run_for(seconds * 1000000LL);
+    sim_i2c_stats_t cost = stats_since(before);
+
+    row_match_t match = { .row = 1, .text = "01/01/2025" };
+    TEST_ASSERT_TRUE(row_shows(&match));
+    report("clock frame transactions", (double)cost.transactions / seconds, "", CLOCK_FRAME_MAX_TRANSACTIONS);
+    report("clock frame bus time", (double)cost.bus_time_us / seconds, "us", CLOCK_FRAME_MAX_BUS_US);
+}
+
+static sim_lcd_stats_t lcd_model_stats(void) {
+    sim_lcd_stats_t stats;
+    sim_lcd_get_stats(&stats);
+    return stats;
+}
+
+static void bench_big_clock_cgram(void) {
+    ESP_ERROR_CHECK(big_digits_init());
+    g_big_clock = true;
+    sim_run_for(2000000);
+
+    // The clock runs from 00:00:10 on; the digits keep their shapes in this window
+    const int seconds = 10;
+    sim_lcd_stats_t before = lcd_model_stats();
+    glyph_cache_stats_t cache_before;
+    glyph_cache_get_stats(&cache_before);
+    sim_run_for(seconds * 1000000LL);
+    sim_lcd_stats_t after = lcd_model_stats();
+    glyph_cache_stats_t cache_after;
+    glyph_cache_get_stats(&cache_after);
+
+    // Every digit cell shows a glyph whose CGRAM slot holds the right shape
+    char row[LCD_COLS + 1];
+    sim_lcd_get_row(0, row);
+    uint8_t glyph[8];
+    sim_lcd_get_glyph(row[0] & 0x07, glyph);
+    static const uint8_t top_left[8] = {0x07, 0x0F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F};
+    TEST_ASSERT_EQUAL_MEMORY(top_left, glyph, 8); // "0" starts with the rounded corner
+    TEST_ASSERT_EQUAL_UINT32(0, cache_after.misses);
+    TEST_ASSERT_EQUAL_UINT32(cache_before.loads, cache_after.loads);
+
+    report("big clock CGRAM writes", (double)(after.cgram_writes - before.cgram_writes) / seconds, "per s",
+           BIG_CLOCK_MAX_CGRAM_WRITES_PER_S);
+}
+
+// True if the row shows 16 consecutive cells of the marquee's text-plus-gap loop
+static bool row_in_marquee(uint8_t row, const char* text) {
+    char loop[2 * (DISPLAY_SERVER_MAX_MARQUEE_TEXT + 4) + 1];
+    snprintf(loop, sizeof(loop), "%s    %s    ", text, text);
+    char shown[LCD_COLS + 1];
+    sim_lcd_get_row(row, shown);
+    return strstr(loop, shown) != NULL;
+}
+
+static double marquee_bytes_per_step(int steps) {
+    sim_i2c_stats_t before = lcd_stats();
+    sim_run_for(steps * 300000LL);
+    sim_i2c_stats_t cost = stats_since(before);
+    return (double)cost.bytes / steps;
+}
+
+static void bench_marquee(void) {
+    static const char* text = "Alarm 1: wake up and take the bins out before eight";
+    g_screen_paused = true;
+    for (uint8_t row = 0; row < LCD_ROWS; row++) {
+        display_server_put_line(row, "");
+    }
+    ESP_ERROR_CHECK(display_server_set_marquee(0, text));
+    sim_run_for(1000000);
+
+    // Blank rows elsewhere: the panel scrolls through the DDRAM past column 16
+    double shift_bytes = marquee_bytes_per_step(20);
+    TEST_ASSERT_TRUE(row_in_marquee(0, text));
+    char row[LCD_COLS + 1];
+    sim_lcd_get_row(2, row);
+    TEST_ASSERT_EQUAL_STRING("                ", row);
+
+    // A static row would move with a shift, so the marquee row is rewritten
+    display_server_put_line(3, "Static row");
+    sim_run_for(100000);
+    double rewrite_bytes = marquee_bytes_per_step(20);
+    TEST_ASSERT_TRUE(row_in_marquee(0, text));
+    sim_lcd_get_row(3, row);
+    TEST_ASSERT_EQUAL_STRING("Static row      ", row);
+
+    display_server_clear_marquee(0);
+    g_screen_paused = false;
+    display_server_request_redraw();
+    sim_run_for(1000000);
+
+    report("marquee step, shifted", shift_bytes, "bytes", MARQUEE_SHIFT_MAX_BYTES_PER_STEP);
+    report("marquee step, rewritten", rewrite_bytes, "bytes", MARQUEE_REWRITE_MAX_BYTES_PER_STEP);
+}
+
+// True while the panel shows the current seconds and the status rows
+static bool screen_current(void* arg) {
+    rtc_time_t now;
+    rtc_clock_get_time(&now);
+    char seconds[4];
+    snprintf(seconds, sizeof(seconds), "%02d", now.seconds);
+    char row[LCD_COLS + 1];
+    sim_lcd_get_row(1, row);
+    char expected[32];
+    snprintf(expected, sizeof(expected), "Encoder: %ld", (long)g_encoder);
+    row_match_t button = { .row = 2, .text = "Button: None" };
+    row_match_t encoder = { .row = 3, .text = expected };
+    return strcmp(row + LCD_COLS - 2, seconds) == 0 && row_shows(&button) && row_shows(&encoder);
+}
+
+static void bench_lcd_recovery(void) {
+    sim_run_for(1000000);
+    TEST_ASSERT_TRUE(sim_run_until(screen_current, NULL, 100000));
+
+    // Every byte after the slip is misframed, so the clock stops moving on screen
+    int64_t start = sim_now_us();
+    sim_lcd_drop_nibble();
+    sim_run_for(2500000);
+    TEST_ASSERT_TRUE(!screen_current(NULL));
+    TEST_ASSERT_TRUE(sim_run_until(screen_current, NULL, LCD_RECOVERY_MAX_US));
+    int64_t recovered = sim_now_us() - start;
+
+    // The glyphs came back with the screen
+    char row[LCD_COLS + 1];
+    sim_lcd_get_row(0, row);
+    uint8_t glyph[8];
+    sim_lcd_get_glyph(row[0] & 0x07, glyph);
+    static const uint8_t top_left[8] = {0x07, 0x0F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F};
+    TEST_ASSERT_EQUAL_MEMORY(top_left, glyph, 8);
+    report("LCD glitch recovery", recovered, "us", LCD_RECOVERY_MAX_US);
+}
+
+static void bench_lcd_write_failure(void) {
+    TEST_ASSERT_TRUE(sim_run_until(screen_current, NULL, 1000000));
+
+    // The press is drawn into the shadow but never reaches the panel
+    sim_lcd_fail_writes(UINT32_MAX);
+    sim_gpio_set_level(BUTTON_GPIO, 0);
+    sim_run_for(200000);
+    sim_lcd_fail_writes(0);
+    int64_t start = sim_now_us();
+    row_match_t pressed = { .row = 2, .text = "Button: A" };
+    TEST_ASSERT_TRUE(!row_shows(&pressed));
+
+    TEST_ASSERT_TRUE(sim_run_until(row_shows, &pressed, LCD_WRITE_FAILURE_MAX_US));
+    int64_t resent = sim_now_us() - start;
+    sim_gpio_set_level(BUTTON_GPIO, 1);
+    TEST_ASSERT_TRUE(sim_run_until(screen_current, NULL, 1000000));
+    report("LCD write failure recovery", resent, "us", LCD_WRITE_FAILURE_MAX_US);
+}
+
+// True once the panel shows the current encoder count
+static bool encoder_current(void* arg) {
+    char expected[32];
+    snprintf(expected, sizeof(expected), "Encoder: %ld", (long)g_encoder);
+    row_match_t encoder = { .row = 3, .text = expected };
+    return row_shows(&encoder);
+}
+
+static void bench_lcd_status_nack(void) {
+    // The clock ticks stopped with bench_rtc_alarm_offload, so the encoder
+    // keeps frames flowing; one of them runs the cursor check
+    sim_lcd_stats_t before;
+    sim_lcd_get_stats(&before);
+    sim_lcd_fail_status_reads(1);
+    for (int s = 0; s < 12; s++) {
+        rotary_encoder_counter_sim_rotate(1);
+        sim_run_for(1000000);
+    }
+    sim_lcd_fail_status_reads(0);
+    sim_lcd_stats_t after;
+    sim_lcd_get_stats(&after);
+    TEST_ASSERT_TRUE(sim_run_until(encoder_current, NULL, 100000));
+    report("LCD re-inits after a status NACK", after.clears - before.clears, "", LCD_STATUS_NACK_MAX_REINITS);
+}
+
+static void bench_steady_state_heap(void) {
+    const int seconds = 10;
+    sim_heap_stats_t before;
+    sim_heap_get_stats(&before);
+    for (int s = 0; s < seconds; s++) {
+        sim_gpio_set_level(BUTTON_GPIO, 0);
+        sim_run_for(300000);
+        sim_gpio_set_level(BUTTON_GPIO, 1);
+        for (int i = 0; i < 40; i++) {
+            rotary_encoder_counter_sim_rotate(i < 20 ? 1 : -1);
+            sim_run_for(5000);
+        }
+        sim_run_for(500000);
+    }
+    sim_heap_stats_t after;
+    sim_heap_get_stats(&after);
+    report("steady-state allocations", (double)(after.allocations - before.allocations) / seconds, "per s",
+           STEADY_STATE_MAX_ALLOCS_PER_S);
+}
+
+static void bench_lcd_busy(void) {
+    sim_lcd_stats_t stats = lcd_model_stats();
+    report("LCD busy violations", stats.busy_violations, "", LCD_MAX_BUSY_VIOLATIONS);
+}
+
+// System clock minus RTC at the latest SQW edge
+static int64_t system_clock_offset_us(void) {
+    rtc_time_t time;
+    int64_t edge_us;
+    struct timeval tv;
+    TEST_ASSERT_EQUAL_INT(ESP_OK, rtc_clock_get_edge(&time, &edge_us));
+    gettimeofday(&tv, NULL);
+    int64_t at_edge_us = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec - (esp_timer_get_time() - edge_us);
+    return at_edge_us - time_core_from_rtc(&time) * 1000000;
+}
+
+static void bench_time_sync(void) {
+    sim_ds1307_set_drift_ppm(TIME_SYNC_RTC_DRIFT_PPM);
+    time_sync_config_t sync_conf = {
+        .interval_s = TIME_SYNC_INTERVAL_S,
+        .max_slew_ms = 500,
+        .task_priority = 4,
+    };
+    ESP_ERROR_CHECK(time_sync_start(&sync_conf));
+    sim_run_for(20 * 60 * 1000000LL);
+
+    // Sample the offset every second for ten minutes, half a second after each edge
+    sim_run_for(500000);
+    int64_t worst_us = 0;
+    for (int s = 0; s < 600; s++) {
+        int64_t offset_us = llabs(system_clock_offset_us());
+        if (offset_us > worst_us) {
+            worst_us = offset_us;
+        }
+        sim_run_for(1000000);
+    }
+    time_sync_stats_t stats;
+    ESP_ERROR_CHECK(time_sync_get_stats(&stats));
+    sim_ds1307_set_drift_ppm(0);
+
+    // Seeded, then stepped once onto the first edge; slewed from then on
+    TEST_ASSERT_TRUE(stats.synced);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.steps);
+    double error_ppm = stats.drift_ppm + TIME_SYNC_RTC_DRIFT_PPM; // the system clock is the slow one
+    report("time sync drift error", error_ppm < 0 ? -error_ppm : error_ppm, "ppm", TIME_SYNC_MAX_DRIFT_ERROR_PPM);
+    report("time sync worst offset", worst_us, "us", TIME_SYNC_MAX_OFFSET_US);
+}
+
+static volatile uint32_t g_rtc_ticks = 0;
+static volatile int64_t g_rtc_alarm_us = 0;
+static uint8_t g_rtc_alarm_regs[3];  // DS3231 seconds, minutes, hours when the callback ran
+
+static void count_rtc_tick(const rtc_time_t* now, void* user_data) {
+    g_rtc_ticks++;
+}
+
+static void on_rtc_alarm(void* user_data) {
+    g_rtc_alarm_us = sim_now_us();
+    for (uint8_t reg = 0; reg < 3; reg++) {
+        g_rtc_alarm_regs[reg] = sim_ds3231_peek(reg);
+    }
+}
+
+static bool rtc_alarm_fired(void* arg) {
+    return g_rtc_alarm_us != 0;
+}
+
+static sim_i2c_stats_t ds3231_stats(void) {
+    sim_i2c_stats_t stats;
+    sim_i2c_get_stats(DS3231_I2C_PORT, DS3231_I2C_ADDRESS, &stats);
+    return stats;
+}
+
+static void bench_rtc_alarm_offload(void) {
+    // Hand the clock over from the DS1307 to a DS3231 on the second bus
+    ESP_ERROR_CHECK(rtc_clock_stop());
+    TEST_ASSERT_TRUE(gpio_get_level(RTC_SQW_GPIO) == 1); // the DS1307 lets SQW/OUT go
+    sim_ds3231_attach(DS3231_I2C_PORT, DS3231_I2C_ADDRESS, DS3231_INT_GPIO);
+    i2c_bus_config_t bus_conf = {
+        .i2c_port = DS3231_I2C_PORT,
+        .sda_pin = 16,
+        .scl_pin = 17,
+        .clk_speed = 400000,
+    };
+    ESP_ERROR_CHECK(i2c_bus_init(&bus_conf));
+    ds3231_config_t ds3231_conf = { .i2c_port = DS3231_I2C_PORT };
+    ESP_ERROR_CHECK(ds3231_init(&ds3231_conf));
+
+    // Power-on flags the oscillator as stopped until the time is set
+    bool running;
+    ESP_ERROR_CHECK(ds3231_is_running(&running));
+    TEST_ASSERT_TRUE(!running);
+    rtc_time_t time = { .seconds = 0, .minutes = 58, .hours = 23, .day = 1, .date = 30, .month = 3, .year = 25 };
+    int64_t set_us = sim_now_us(); // a little before the write restarts the countdown chain
+    ESP_ERROR_CHECK(ds3231_set_time(&time));
+    ESP_ERROR_CHECK(ds3231_is_running(&running));
+    TEST_ASSERT_TRUE(running);
+
+    int8_t aging;
+    ESP_ERROR_CHECK(ds3231_set_aging_offset(-12));
+    ESP_ERROR_CHECK(ds3231_get_aging_offset(&aging));
+    TEST_ASSERT_EQUAL_INT(-12, aging);
+    ESP_ERROR_CHECK(ds3231_set_aging_offset(0));
+    int16_t quarter_celsius;
+    ESP_ERROR_CHECK(ds3231_get_temperature(&quarter_celsius));
+    TEST_ASSERT_EQUAL_INT(25 * 4, quarter_celsius);
+
+    rtc_clock_config_t clock_conf = {
+        .device = &ds3231_rtc_device,
+        .sqw_pin = DS3231_INT_GPIO,
+        .tick = RTC_TICK_NONE,
+        .resync_interval_s = 3600,
+        .task_priority = 5,
+        .tick_cb = count_rtc_tick,
+        .alarm_cb = on_rtc_alarm,
+    };
+    ESP_ERROR_CHECK(rtc_clock_start(&clock_conf));
+
+    // Two minutes ahead, across midnight into the next day
+    const int alarm_in_s = 120;
+    rtc_time_t alarm;
+    time_core_to_rtc(time_core_from_rtc(&time) + alarm_in_s, &alarm);
+    ESP_ERROR_CHECK(rtc_clock_set_alarm(&alarm));
+    sim_i2c_stats_t armed = ds3231_stats();
+    sim_run_for(set_us + (alarm_in_s - 1) * 1000000LL - sim_now_us());
+    sim_i2c_stats_t idle = ds3231_stats();
+    TEST_ASSERT_TRUE(g_rtc_alarm_us == 0);
+    TEST_ASSERT_EQUAL_UINT32(0, g_rtc_ticks);
+
+    TEST_ASSERT_TRUE(sim_run_until(rtc_alarm_fired, NULL, 2000000));
+    TEST_ASSERT_EQUAL_UINT32(0x00, g_rtc_alarm_regs[0]);
+    TEST_ASSERT_EQUAL_UINT32(0x00, g_rtc_alarm_regs[1]);
+    TEST_ASSERT_EQUAL_UINT32(0x00, g_rtc_alarm_regs[2]);
+    TEST_ASSERT_TRUE(gpio_get_level(DS3231_INT_GPIO) == 1); // released by the acknowledgement
+    int64_t latency_us = g_rtc_alarm_us - (set_us + alarm_in_s * 1000000LL);
+
+    // Minute ticks: one wakeup per minute, the local copy carried between them
+    ESP_ERROR_CHECK(rtc_clock_set_tick(RTC_TICK_MINUTE));
+    sim_run_for(1000000);
+    const int minutes = 5;
+    uint32_t ticks_before = g_rtc_ticks;
+    sim_i2c_stats_t before = ds3231_stats();
+    sim_run_for(minutes * 60 * 1000000LL);
+    sim_i2c_stats_t after = ds3231_stats();
+    TEST_ASSERT_EQUAL_UINT32(minutes, g_rtc_ticks - ticks_before);
+    rtc_time_t now;
+    ESP_ERROR_CHECK(rtc_clock_get_time(&now));
+    TEST_ASSERT_EQUAL_UINT32(sim_ds3231_peek(0x00), rtc_device_dec_to_bcd(now.seconds));
+    TEST_ASSERT_EQUAL_UINT32(sim_ds3231_peek(0x01), rtc_device_dec_to_bcd(now.minutes));
+
+    report("RTC idle transactions", idle.transactions - armed.transactions, "",
+           RTC_OFFLOAD_IDLE_MAX_TRANSACTIONS);
+    report("RTC alarm latency", latency_us, "us", RTC_OFFLOAD_MAX_LATENCY_US);
+    report("RTC minute tick transactions", (double)(after.transactions - before.transactions) / minutes, "",
+           RTC_MINUTE_TICK_MAX_TRANSACTIONS);
+}
+
+static void bench_time_core(void) {
+    // Every day of the DS1307's range: consecutive days are 86400 s apart,
+    // the weekday advances by one and the fields survive the round trip
+    rtc_time_t time = { .seconds = 59, .minutes = 59, .hours = 23, .day = 7, .date = 1, .month = 1, .year = 0 };
+    int64_t first = time_core_from_rtc(&time);
+    TEST_ASSERT_TRUE(first == 946771199LL); // 2000-01-01 23:59:59, a Saturday
+    int64_t days = 0;
+    int64_t start_ns = monotonic_ns();
+    for (int64_t t = first;; t += TIME_CORE_SECONDS_PER_DAY, days++) {
+        rtc_time_t back;
+        time_core_to_rtc(t, &back);
+        TEST_ASSERT_TRUE(time_core_from_rtc(&back) == t);
+        TEST_ASSERT_EQUAL_UINT32(days % 7 == 0 ? 7 : days % 7, back.day);
+        if (back.year == 99 && back.month == 12 && back.date == 31) {
+            break;
+        }
+    }
+    int64_t elapsed_ns = monotonic_ns() - start_ns;
+    TEST_ASSERT_TRUE(days + 1 == 36525);
+
+    // 2024 changes: last Sundays at 01:00 UTC in Europe, second/first Sundays
+    // at 02:00 local in the US, first Sundays of April/October in Sydney
+    const time_core_zone_t* berlin = time_core_find_zone("Europe/Berlin");
+    const time_core_zone_t* new_york = time_core_find_zone("America/New_York");
+    const time_core_zone_t* sydney = time_core_find_zone("Australia/Sydney");
+    bool dst;
+    TEST_ASSERT_TRUE(time_core_utc_to_local(berlin, 1711846799LL, &dst) == 1711846799LL + 3600 && !dst);
+    TEST_ASSERT_TRUE(time_core_utc_to_local(berlin, 1711846800LL, &dst) == 1711846800LL + 7200 && dst);
+    TEST_ASSERT_TRUE(time_core_utc_to_local(berlin, 1729990800LL, &dst) == 1729990800LL + 3600 && !dst);
+    TEST_ASSERT_TRUE(time_core_utc_to_local(new_york, 1710054000LL, &dst) == 1710054000LL - 4 * 3600 && dst);
+    TEST_ASSERT_TRUE(time_core_utc_to_local(new_york, 1730613600LL, &dst) == 1730613600LL - 5 * 3600 && !dst);
+    TEST_ASSERT_TRUE(time_core_utc_to_local(sydney, 1712419200LL, &dst) == 1712419200LL + 10 * 3600 && !dst);
+    TEST_ASSERT_TRUE(time_core_utc_to_local(sydney, 1728144000LL, &dst) == 1728144000LL + 11 * 3600 && dst);
+    TEST_ASSERT_TRUE(time_core_local_to_utc(berlin, 1729990800LL + 5400) == 1729990800LL - 1800);
+
+    char text[TIME_CORE_DATE_LEN];
+    time_core_to_rtc(4102444799LL, &time);
+    TEST_ASSERT_EQUAL_STRING("31/12/2099", time_core_format_date(&time, text));
+    TEST_ASSERT_EQUAL_STRING("23:59:59", time_core_format_time(&time, text));
+
+    report("time round trip", (double)elapsed_ns / (days + 1), "ns",
+           host_time_limit(TIME_CORE_MAX_NS_PER_ROUND_TRIP));
+}
+
+// Reference model of one alarm, kept by brute force next to the scheduler
+typedef struct {
+    alarm_def_t def;
+    int64_t next_fire;              // INT64_MAX while disabled
+    uint8_t snooze_count;
+    bool snoozed;
+    bool fired;
+} ref_alarm_t;
+
+typedef struct {
+    int id;
+    int64_t when;
+} fired_alarm_t;
+
+typedef struct {
+    fired_alarm_t list[ALARM_SCHEDULER_ALARMS];
+    size_t count;
+} fired_log_t;
+
+static uint32_t bench_random(uint32_t* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+// Walks forward day by day and asks gmtime_r() for the weekday
+static int64_t ref_next_fire(const alarm_def_t* def, int64_t after) {
+    if (!def->enabled) {
+        return INT64_MAX;
+    }
+    for (int64_t day = after / 86400;; day++) {
+        int64_t t = day * 86400 + def->hour * 3600 + def->minute * 60;
+        time_t as_time = (time_t)t;
+        struct tm fields;
+        gmtime_r(&as_time, &fields);
+        if (t > after && (def->weekdays == 0 || (def->weekdays & (1 << fields.tm_wday)))) {
+            return t;
+        }
+    }
+}
+
+static alarm_def_t random_alarm(uint32_t* state) {
+    static const uint8_t kinds[] = {0, ALARM_SCHEDULER_DAILY, 0x3E}; // one-shot, daily, weekdays
+    uint32_t kind = bench_random(state) % 4;
+    alarm_def_t def = {
+        .hour = bench_random(state) % 24,
+        .minute = bench_random(state) % 60,
+        .weekdays = kind < 3 ? kinds[kind] : (bench_random(state) % ALARM_SCHEDULER_DAILY) + 1,
+        .enabled = bench_random(state) % 8 != 0,
+        .snooze_minutes = bench_random(state) % 11,
+        .snooze_limit = bench_random(state) % 4,
+    };
+    return def;
+}
+
+static void ref_set(ref_alarm_t* ref, const alarm_def_t* def, int64_t now) {
+    ref->def = *def;
+    ref->snooze_count = 0;
+    ref->snoozed = false;
+    ref->next_fire = ref_next_fire(def, now);
+}
+
+static void ref_dismiss(ref_alarm_t* ref, int64_t now) {
+    ref->snooze_count = 0;
+    ref->snoozed = false;
+    if (ref->def.weekdays == 0) {
+        ref->def.enabled = false;
+    }
+    ref->next_fire = ref_next_fire(&ref->def, now);
+}
+
+static void log_fired(int id, int64_t when, void* user_data) {
+    fired_log_t* log = user_data;
+    TEST_ASSERT_TRUE(log->count < ALARM_SCHEDULER_ALARMS);
+    log->list[log->count].id = id;
+    log->list[log->count].when = when;
+    log->count++;
+}
+
+static bool alarm_enabled(alarm_scheduler_handle_t s, int id) {
+    alarm_def_t def;
+    TEST_ASSERT_TRUE(alarm_scheduler_get(s, id, &def));
+    return def.enabled;
+}
+
+static void bench_alarm_scheduler(void) {
+    // Snoozes up to the limit, then a snooze dismisses. The first day's alarm
+    // is left ringing rather than dismissed, and the next day may still snooze
+    alarm_scheduler_handle_t s = alarm_scheduler_create(1);
+    alarm_def_t wake = { .hour = 7, .minute = 0, .weekdays = ALARM_SCHEDULER_DAILY, .enabled = true,
+                         .snooze_minutes = 5, .snooze_limit = 2 };
+    const int64_t monday = 1704067200LL; // 2024-01-01 00:00, a Monday
+    TEST_ASSERT_TRUE(alarm_scheduler_add(s, &wake, monday) == 0);
+    TEST_ASSERT_TRUE(alarm_scheduler_add(s, &wake, monday) == -1);
+    int64_t now = monday + 7 * 3600;
+    for (int day = 0; day < 2; day++, now += 86400) {
+        TEST_ASSERT_EQUAL_UINT32(1, alarm_scheduler_poll(s, now, NULL, NULL));
+        TEST_ASSERT_TRUE(alarm_scheduler_snooze(s, 0, now));
+        TEST_ASSERT_EQUAL_UINT32(1, alarm_scheduler_poll(s, now + 300, NULL, NULL));
+        TEST_ASSERT_TRUE(alarm_scheduler_snooze(s, 0, now + 300));
+        TEST_ASSERT_EQUAL_UINT32(1, alarm_scheduler_poll(s, now + 600, NULL, NULL));
+        if (day == 1) {
+            TEST_ASSERT_TRUE(!alarm_scheduler_snooze(s, 0, now + 600));
+        }
+        int64_t next;
+        TEST_ASSERT_TRUE(alarm_scheduler_peek(s, &next, NULL) && next == now + 86400);
+    }
+
+    // A one-shot alarm reads back as disabled once it has fired
+    alarm_def_t once = { .hour = 6, .minute = 30, .weekdays = 0, .enabled = true };
+    TEST_ASSERT_TRUE(alarm_scheduler_update(s, 0, &once, now));
+    TEST_ASSERT_EQUAL_UINT32(1, alarm_scheduler_poll(s, now + 86400, NULL, NULL));
+    TEST_ASSERT_TRUE(!alarm_enabled(s, 0));
+    TEST_ASSERT_TRUE(!alarm_scheduler_peek(s, NULL, NULL));
+    alarm_scheduler_destroy(s);
+
+    // A full table under random edits, checked after every poll against a
+    // brute-force scan of the reference model
+    static ref_alarm_t refs[ALARM_SCHEDULER_ALARMS];
+    static fired_log_t log;
+    uint32_t seed = 12345;
+    now = monday;
+    s = alarm_scheduler_create(ALARM_SCHEDULER_ALARMS);
+    TEST_ASSERT_NOT_NULL(s);
+    for (int id = 0; id < ALARM_SCHEDULER_ALARMS; id++) {
+        alarm_def_t def = random_alarm(&seed);
+        TEST_ASSERT_TRUE(alarm_scheduler_add(s, &def, now) == id);
+        ref_set(&refs[id], &def, now);
+    }
+
+    int64_t poll_ns = 0;
+    uint32_t total_fired = 0;
+    uint32_t snoozes = 0;
+    for (int poll = 0; poll < ALARM_SCHEDULER_POLLS; poll++) {
+        now += 60 + bench_random(&seed) % (4 * 3600);
+        log.count = 0;
+        int64_t start_ns = monotonic_ns();
+        size_t fired = alarm_scheduler_poll(s, now, log_fired, &log);
+        poll_ns += monotonic_ns() - start_ns;
+        TEST_ASSERT_EQUAL_UINT32(log.count, fired);
+        total_fired += fired;
+
+        // Every due alarm fired once, earliest first, at its reference time
+        int64_t previous = INT64_MIN;
+        for (size_t i = 0; i < log.count; i++) {
+            ref_alarm_t* ref = &refs[log.list[i].id];
+            TEST_ASSERT_TRUE(!ref->fired);
+            TEST_ASSERT_TRUE(log.list[i].when == ref->next_fire);
+            TEST_ASSERT_TRUE(log.list[i].when <= now && log.list[i].when >= previous);
+            previous = log.list[i].when;
+            ref->fired = true;
+        }
+        for (int id = 0; id < ALARM_SCHEDULER_ALARMS; id++) {
+            TEST_ASSERT_TRUE(refs[id].fired || refs[id].next_fire > now);
+        }
+
+        // Snooze or dismiss about half of what rang
+        for (size_t i = 0; i < log.count; i++) {
+            int id = log.list[i].id;
+            ref_alarm_t* ref = &refs[id];
+            ref->fired = false;
+            if (!ref->snoozed) {
+                ref->snooze_count = 0;
+            }
+            ref->snoozed = false;
+            if (ref->def.weekdays == 0) {
+                ref->def.enabled = false;
+            }
+            ref->next_fire = ref_next_fire(&ref->def, now);
+            TEST_ASSERT_TRUE(alarm_enabled(s, id) == ref->def.enabled);
+            if (bench_random(&seed) % 2 != 0) {
+                continue;
+            }
+            bool allowed = ref->def.snooze_minutes > 0 && ref->snooze_count < ref->def.snooze_limit;
+            TEST_ASSERT_TRUE(alarm_scheduler_snooze(s, id, now) == allowed);
+            if (allowed) {
+                ref->snooze_count++;
+                ref->snoozed = true;
+                ref->def.enabled = true;
+                ref->next_fire = now + ref->def.snooze_minutes * 60;
+                snoozes++;
+            } else {
+                ref_dismiss(ref, now);
+            }
+            TEST_ASSERT_TRUE(alarm_enabled(s, id) == ref->def.enabled);
+        }
+
+        // Edit one alarm, or remove one and add another that takes its id
+        int id = bench_random(&seed) % ALARM_SCHEDULER_ALARMS;
+        alarm_def_t def = random_alarm(&seed);
+        if (poll % 3 == 0) {
+            TEST_ASSERT_TRUE(alarm_scheduler_update(s, id, &def, now));
+        } else if (poll % 3 == 1) {
+            TEST_ASSERT_TRUE(alarm_scheduler_remove(s, id));
+            TEST_ASSERT_TRUE(!alarm_scheduler_remove(s, id));
+            TEST_ASSERT_TRUE(alarm_scheduler_add(s, &def, now) == id);
+        }
+        if (poll % 3 != 2) {
+            ref_set(&refs[id], &def, now);
+        }
+        TEST_ASSERT_TRUE(alarm_scheduler_add(s, &def, now) == -1);
+
+        int64_t earliest = INT64_MAX;
+        for (int i = 0; i < ALARM_SCHEDULER_ALARMS; i++) {
+            if (refs[i].next_fire < earliest) {
+                earliest = refs[i].next_fire;
+            }
+        }
+        int64_t head = INT64_MAX;
+        alarm_scheduler_peek(s, &head, NULL);
+        TEST_ASSERT_TRUE(head == earliest);
+    }
+    alarm_scheduler_destroy(s);
+    TEST_ASSERT_TRUE(total_fired > ALARM_SCHEDULER_POLLS && snoozes > 0);
+
+    report("alarm scheduler poll", (double)poll_ns / ALARM_SCHEDULER_POLLS, "ns",
+           host_time_limit(ALARM_SCHEDULER_MAX_NS_PER_POLL));
+}
+
+#define NVRAM_REG 0x08 // DS1307 register of NVRAM byte 0
+
+static sim_i2c_stats_t ds1307_stats(void) {
+    sim_i2c_stats_t stats;
+    sim_i2c_get_stats(I2C_PORT, DS1307_I2C_ADDRESS, &stats);
+    return stats;
+}
+
+static void read_nvram(uint8_t nvram[DS1307_NVRAM_SIZE]) {
+    for (uint8_t i = 0; i < DS1307_NVRAM_SIZE; i++) {
+        nvram[i] = sim_ds1307_peek(NVRAM_REG + i);
+    }
+}
+
+static alarm_record_t sample_record(uint8_t n) {
+    alarm_record_t record = {
+        .hour = (5 + n) % 24,
+        .minute = (7 * n) % 60,
+        .weekdays = n % 3 == 0 ? 0 : (n % 3 == 1 ? ALARM_DAY_ALL : ALARM_DAY_MONDAY | ALARM_DAY_FRIDAY),
+        .enabled = n % 4 != 3,
+        .snooze_minutes = n % 32,
+        .snooze_limit = n % 8,
+    };
+    return record;
+}
+
+static bool records_equal(const alarm_record_t* a, const alarm_record_t* b) {
+    return a->hour == b->hour && a->minute == b->minute && a->weekdays == b->weekdays &&
+           a->enabled == b->enabled && a->snooze_minutes == b->snooze_minutes && a->snooze_limit == b->snooze_limit;
+}
+
+// Saves a record and returns the offset of the 5-byte copy it rewrote
+static uint8_t save_and_locate(uint8_t index, const alarm_record_t* record) {
+    uint8_t before[DS1307_NVRAM_SIZE];
+    uint8_t after[DS1307_NVRAM_SIZE];
+    read_nvram(before);
+    TEST_ASSERT_TRUE(alarm_store_save(index, record) == ESP_OK);
+    read_nvram(after);
+    int first = -1;
+    int last = -1;
+    for (int i = 0; i < DS1307_NVRAM_SIZE; i++) {
+        if (before[i] != after[i]) {
+            first = first < 0 ? i : first;
+            last = i;
+        }
+    }
+    TEST_ASSERT_TRUE(first >= 0 && last - first < 5);
+    return (uint8_t)first;
+}
+
+static void check_loaded(const alarm_record_t expected[ALARM_STORE_MAX_ALARMS]) {
+    alarm_record_t loaded[ALARM_STORE_MAX_ALARMS];
+    TEST_ASSERT_TRUE(alarm_store_load(loaded) == ESP_OK);
+    for (uint8_t i = 0; i < ALARM_STORE_MAX_ALARMS; i++) {
+        TEST_ASSERT_TRUE_MESSAGE(records_equal(&expected[i], &loaded[i]), "alarm record");
+    }
+}
+
+static void bench_alarm_store(void) {
+    uint8_t saved_nvram[DS1307_NVRAM_SIZE];
+    read_nvram(saved_nvram);
+    alarm_record_t expected[ALARM_STORE_MAX_ALARMS] = {0};
+
+    // A blank region has neither header: it is formatted, everything loads
+    // disabled, and a second load finds the fresh headers
+    for (uint8_t i = 0; i < DS1307_NVRAM_SIZE; i++) {
+        sim_ds1307_poke(NVRAM_REG + i, 0x00);
+    }
+    check_loaded(expected);
+    uint8_t formatted[DS1307_NVRAM_SIZE];
+    read_nvram(formatted);
+    check_loaded(expected);
+    uint8_t reloaded[DS1307_NVRAM_SIZE];
+    read_nvram(reloaded);
+    TEST_ASSERT_EQUAL_MEMORY(formatted, reloaded, DS1307_NVRAM_SIZE);
+    TEST_ASSERT_TRUE(formatted[0] != 0x00);
+    TEST_ASSERT_TRUE(formatted[DS1307_NVRAM_SIZE - 2] != 0x00);
+
+    // Round trip
+    sim_i2c_stats_t before = ds1307_stats();
+    for (uint8_t i = 0; i < ALARM_STORE_MAX_ALARMS; i++) {
+        expected[i] = sample_record(i + 1);
+        TEST_ASSERT_TRUE(alarm_store_save(i, &expected[i]) == ESP_OK);
+    }
+    sim_i2c_stats_t saves = ds1307_stats();
+    check_loaded(expected);
+    sim_i2c_stats_t load = ds1307_stats();
+    load.transactions -= saves.transactions;
+    saves.bytes -= before.bytes;
+    alarm_record_t bad = sample_record(1);
+    bad.hour = 24;
+    TEST_ASSERT_TRUE(alarm_store_save(0, &bad) == ESP_ERR_INVALID_ARG);
+
+    // One bad bit in either header keeps the alarms, and the header is repaired
+    static const uint8_t header_bytes[] = { 0, 3, DS1307_NVRAM_SIZE - 2, DS1307_NVRAM_SIZE - 1 };
+    for (size_t i = 0; i < sizeof(header_bytes); i++) {
+        uint8_t intact[DS1307_NVRAM_SIZE];
+        read_nvram(intact);
+        uint8_t reg = NVRAM_REG + header_bytes[i];
+        sim_ds1307_poke(reg, sim_ds1307_peek(reg) ^ 0x04);
+        check_loaded(expected);
+        uint8_t repaired[DS1307_NVRAM_SIZE];
+        read_nvram(repaired);
+        TEST_ASSERT_EQUAL_MEMORY(intact, repaired, DS1307_NVRAM_SIZE);
+    }
+
+    // The 2-bit sequence number wraps several times; the newest copy always wins
+    for (uint8_t n = 0; n < 10; n++) {
+        expected[1] = sample_record(10 + n);
+        TEST_ASSERT_TRUE(alarm_store_save(1, &expected[1]) == ESP_OK);
+        check_loaded(expected);
+    }
+
+    // A torn save: the newer copy is corrupt, so the previous value loads
+    uint8_t newer = save_and_locate(2, &(alarm_record_t){ .hour = 6, .minute = 15, .enabled = true });
+    sim_ds1307_poke(NVRAM_REG + newer + 1, sim_ds1307_peek(NVRAM_REG + newer + 1) ^ 0x10);
+    check_loaded(expected);
+    expected[2] = sample_record(30);
+    TEST_ASSERT_TRUE(alarm_store_save(2, &expected[2]) == ESP_OK);
+    check_loaded(expected);
+
+    // Both copies bad: that alarm loads disabled, the others are untouched,
+    // and it can be saved again
+    uint8_t first = save_and_locate(3, &expected[3]);
+    uint8_t second = save_and_locate(3, &expected[3]);
+    TEST_ASSERT_TRUE(first != second);
+    sim_ds1307_poke(NVRAM_REG + first + 4, sim_ds1307_peek(NVRAM_REG + first + 4) ^ 0xFF);
+    sim_ds1307_poke(NVRAM_REG + second, sim_ds1307_peek(NVRAM_REG + second) ^ 0x01);
+    expected[3] = (alarm_record_t){0};
+    check_loaded(expected);
+    expected[3] = sample_record(31);
+    TEST_ASSERT_TRUE(alarm_store_save(3, &expected[3]) == ESP_OK);
+    check_loaded(expected);
+
+    for (uint8_t i = 0; i < DS1307_NVRAM_SIZE; i++) {
+        sim_ds1307_poke(NVRAM_REG + i, saved_nvram[i]);
+    }
+    report("alarm save bytes", (double)saves.bytes / ALARM_STORE_MAX_ALARMS, "bytes", ALARM_STORE_SAVE_MAX_BYTES);
+    report("alarm load transactions", load.transactions, "", ALARM_STORE_LOAD_MAX_TRANSACTIONS);
+}
+
+int main(int argc, char** argv) {
+    bring_up();
+
+    UNITY_BEGIN();
+    RUN_TEST(bench_full_refresh);
+    RUN_TEST(bench_one_cell_update);
+    RUN_TEST(bench_unchanged_redraw);
+    RUN_TEST(bench_button_to_pixel);
+    RUN_TEST(bench_button_glitch);
+    RUN_TEST(bench_button_delete);
+    RUN_TEST(bench_button_wake_to_pixel);
+    RUN_TEST(bench_encoder_to_pixel);
+    RUN_TEST(bench_encoder_fast_spin);
+    RUN_TEST(bench_frame_budget);
+    RUN_TEST(bench_clock_frames);
+    RUN_TEST(bench_big_clock_cgram);
+    RUN_TEST(bench_marquee);
+    RUN_TEST(bench_lcd_recovery);
+    RUN_TEST(bench_lcd_write_failure);
+    RUN_TEST(bench_steady_state_heap);
+    RUN_TEST(bench_time_sync);
+    RUN_TEST(bench_lcd_busy);
+    RUN_TEST(bench_rtc_alarm_offload);
+    RUN_TEST(bench_time_core);
+    RUN_TEST(bench_alarm_scheduler);
+    RUN_TEST(bench_alarm_store);
+    RUN_TEST(bench_scan_buttons);
+    RUN_TEST(bench_button_gestures);
+    RUN_TEST(bench_encoder_full_queue);
+    RUN_TEST(bench_lcd_status_nack);
+    return UNITY_END();
+}